@@ -1,1265 +1,2473 @@
-#include <iostream>         // cout, cerr
-#include <cstdlib>          // EXIT_FAILURE
-#include <include/GL/glew.h>        // GLEW library
-#include <include/GLFW/glfw3.h>     // GLFW library
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-using namespace std; // Standard namespace
-
-/*Shader program Macro*/
-#ifndef GLSL
-#define GLSL(Version, Source) "#version " #Version " core \n" #Source
-#endif
-
-// Unnamed namespace
-namespace
-{
-    const char* const WINDOW_TITLE = "Eduardo Orozco"; // Macro for window title
-
-    // Variables for window width and height
-    const int WINDOW_WIDTH = 800;
-    const int WINDOW_HEIGHT = 600;
-
-    // Stores the GL data relative to a given mesh
-    struct GLMesh
-    {
-        GLuint vao;         // Handle for the vertex array object
-        GLuint vbos[2];     // Handles for the vertex buffer objects
-        GLuint nVertices;    // Number of indices of the mesh
-    };
-
-    // Main GLFW window
-    GLFWwindow* gWindow = nullptr;
-    // Triangle mesh data
-    GLMesh gMesh;
-    // Texture id
-    GLuint gTextureId;
-    GLuint gTextureId2;
-    GLuint gTextureId3;
-    GLuint gTextureId5;
-    GLuint gTextureId6;
-    GLuint gTextureId7;
-    glm::vec2 gUVScale(1.0f, 1.0f);
-    // Shader programs
-    GLuint gCubeProgramId;
-    GLuint gLightProgramId;
-
-    // Subject position and scale
-    glm::vec3 gCubePosition(0.0f, 0.0f, 0.0f);
-    glm::vec3 gCubeScale(2.0f);
-
-    // Cube and light color
-    //m::vec3 gObjectColor(0.6f, 0.5f, 0.75f);
-    glm::vec3 gObjectColor(1.f, 0.2f, 0.0f);
-    glm::vec3 gLightColor(1.0f, 1.0f, 1.0f);
-
-    // Light position and scale
-    glm::vec3 gLightPosition(0.0f, 2.0f, 0.0f);
-    glm::vec3 gLightScale(0.3f);
-}
-
-/* User-defined Function prototypes to:
- * initialize the program, set the window size,
- * redraw graphics on the window when resized,
- * and render graphics on the screen
- */
-bool UInitialize(int, char* [], GLFWwindow** window);
-void UResizeWindow(GLFWwindow* window, int width, int height);
-void UProcessInput(GLFWwindow* window);
-bool UCreateTexture(const char* filename, GLuint& textureId);
-void UDestroyTexture(GLuint textureId);
-bool UCreateShaderProgram(const char* vtxShaderSource, const char* fragShaderSource, GLuint& programId);
-void UDestroyShaderProgram(GLuint programId);
-void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-
-
-/* Cube Vertex Shader Source Code*/
-const GLchar* cubeVertexShaderSource = GLSL(440,
-
-    layout(location = 0) in vec3 position; // VAP position 0 for vertex position data
-layout(location = 1) in vec3 normal; // VAP position 1 for normals
-layout(location = 2) in vec2 textureCoordinate;
-
-out vec3 vertexNormal; // For outgoing normals to fragment shader
-out vec3 vertexFragmentPos; // For outgoing color / pixels to fragment shader
-out vec2 vertexTextureCoordinate;
-
-//Uniform / Global variables for the  transform matrices
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-void main()
-{
-    gl_Position = projection * view * model * vec4(position, 1.0f); // Transforms vertices into clip coordinates
-
-    vertexFragmentPos = vec3(model * vec4(position, 1.0f)); // Gets fragment / pixel position in world space only (exclude view and projection)
-
-    vertexNormal = mat3(transpose(inverse(model))) * normal; // get normal vectors in world space only and exclude normal translation properties
-    vertexTextureCoordinate = textureCoordinate;
-}
-);
-
-
-/* Cube Fragment Shader Source Code*/
-const GLchar* cubeFragmentShaderSource = GLSL(440,
-
-    in vec3 vertexNormal; // For incoming normals
-in vec3 vertexFragmentPos; // For incoming fragment position
-in vec2 vertexTextureCoordinate;
-
-out vec4 fragmentColor; // For outgoing cube color to the GPU
-
-// Uniform / Global variables for object color, light color, light position, and camera/view position
-uniform vec3 objectColor;
-uniform vec3 lightColor;
-uniform vec3 lightPos;
-uniform vec3 viewPosition;
-uniform sampler2D uTexture; // Useful when working with multiple textures
-uniform vec2 uvScale;
-
-void main()
-{
-    /*Phong lighting model calculations to generate ambient, diffuse, and specular components*/
-
-    //Calculate Ambient lighting*/
-    float ambientStrength = 0.1f; // Set ambient or global lighting strength
-    vec3 ambient = ambientStrength * lightColor; // Generate ambient light color
-
-    //Calculate Diffuse lighting*/
-    vec3 norm = normalize(vertexNormal); // Normalize vectors to 1 unit
-    vec3 lightDirection = normalize(lightPos - vertexFragmentPos); // Calculate distance (light direction) between light source and fragments/pixels on cube
-    float impact = max(dot(norm, lightDirection), 0.0);// Calculate diffuse impact by generating dot product of normal and light
-    vec3 diffuse = impact * lightColor; // Generate diffuse light color
-
-    //Calculate Specular lighting*/
-    float specularIntensity = 0.8f; // Set specular light strength
-    float highlightSize = 16.0f; // Set specular highlight size
-    vec3 viewDir = normalize(viewPosition - vertexFragmentPos); // Calculate view direction
-    vec3 reflectDir = reflect(-lightDirection, norm);// Calculate reflection vector
-    //Calculate specular component
-    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), highlightSize);
-    vec3 specular = specularIntensity * specularComponent * lightColor;
-
-    // Texture holds the color to be used for all three components
-    vec4 textureColor = texture(uTexture, vertexTextureCoordinate * uvScale);
-
-    // Calculate phong result
-    vec3 phong = (ambient + diffuse + specular) * textureColor.xyz;
-
-    fragmentColor = vec4(phong, 1.0); // Send lighting results to GPU
-}
-);
-
-
-/* Lamp Shader Source Code*/
-const GLchar* lampVertexShaderSource = GLSL(440,
-
-    layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
-layout(location = 2) in vec2 aTexCoords;
-
-out vec3 FragPos;
-out vec3 Normal;
-out vec2 TexCoords;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-void main()
-{
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    TexCoords = aTexCoords;
-
-    gl_Position = projection * view * vec4(FragPos, 1.0);
-}
-);
-
-
-/* Fragment Shader Source Code*/
-const GLchar* lampFragmentShaderSource = GLSL(440,
-
-    out vec4 fragmentColor; // For outgoing lamp color (smaller cube) to the GPU
-
-void main()
-{
-    fragmentColor = vec4(1.0f); // Set color to white (1.0f,1.0f,1.0f) with alpha 1.0
-}
-);
-
-//camera
-glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
-glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
-glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
-
-bool firstMouse = true;
-float yaw = -90.0f;
-float pitch = 0.0f;
-float lastX = 800.0f / 2.0;
-float lastY = 600.0 / 2.0;
-float fov = 45.0f;
-bool viewProjection = false;
-glm::mat4 projection;
-
-//timing
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
-
-
-
-int main(int argc, char* argv[])
-{
-    if (!UInitialize(argc, argv, &gWindow))
-        return EXIT_FAILURE;
-
-
-    // Create the shader programs
-    if (!UCreateShaderProgram(cubeVertexShaderSource, cubeFragmentShaderSource, gCubeProgramId))
-        return EXIT_FAILURE;
-
-    if (!UCreateShaderProgram(lampVertexShaderSource, lampFragmentShaderSource, gLightProgramId))
-        return EXIT_FAILURE;
-
-    // Position and Color data
-    float plane[] = {
-        // Vertex Positions    // Colors (r,g,b,a)
-        //Plane
-        2.0f, -0.5f, 4.0f,    0.0f, 1.0f, 0.0f,     1.0f, 1.0f,
-        2.0f, -0.5f, -4.0f,   0.0f, 1.0f, 0.0f,     1.0f, 0.0f,
-        -2.0f, -0.5f, -4.0f,  0.0f, 1.0f, 0.0f,     0.0f, 0.0f,
-        -2.0f, -0.5f, 4.0f,   0.0f, 1.0f, 0.0f,     0.0f, 1.0f,
-        2.0f, -0.5f, 4.0f,    0.0f, 1.0f, 0.0f,     1.0f, 1.0f,
-        -2.0f, -0.5f, -4.0f,  0.0f, 1.0f, 0.0f,     0.0f, 0.0f,
-    };
-
-    const GLuint floatsPerVertex = 3;
-    const GLuint floatsPerNormal = 3;
-    const GLuint floatsPerUV = 2;
-
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(plane), plane, GL_STATIC_DRAW);
-
-    // Strides between vertex coordinates is 6 (x, y, z, r, g, b, a). A tightly packed stride is 0.
-    GLint stride = sizeof(float) * (floatsPerVertex + floatsPerNormal + floatsPerUV);// The number of floats before each
-
-    // Create Vertex Attribute Pointers
-    glVertexAttribPointer(0, floatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, floatsPerNormal, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * floatsPerVertex));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, floatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * (floatsPerVertex + floatsPerNormal)));
-    glEnableVertexAttribArray(2);
-
-
-    //coaster
-    // Position and Color data
-    float coaster[] = {
-        // Vertex Positions    // Colors (r,g,b,a)
-        //top
-        0.0f, -0.5f, 1.5f,      0.0f, 0.0f, -1.0f,       0.0f, 0.0f,
-        1.0f, -0.5f, 1.5f,      0.0f, 0.0f, -1.0f,       1.0f, 0.0f,
-        1.0f,  -0.45f, 1.5f,    0.0f, 0.0f, -1.0f,       1.0f, 1.0f,
-        1.0f,  -0.45f, 1.5f,    0.0f, 0.0f, -1.0f,       1.0f, 1.0f,
-        0.0f,  -0.45f, 1.5f,    0.0f, 0.0f, -1.0f,       0.0f, 1.0f,
-        0.0, -0.5f, 1.5f,       0.0f, 0.0f, -1.0f,       0.0f, 0.0f,
-
-        0.0f, -0.5f,  2.5f,     1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
-        1.0f, -0.5f,  2.5f,     1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
-        1.0f,  -0.45f,  2.5f,   1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
-        1.0f,  -0.45f,  2.5f,   1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
-        0.0f,  -0.45f,  2.5f,   1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
-        0.0f, -0.5f,  2.5f,     1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
-
-        0.0f,  -0.45f,  2.5f,   -1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
-        0.0f,  -0.45f, 1.5f,    -1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
-        0.0f, -0.5f, 1.5f,      -1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
-        0.0f, -0.5f, 1.5f,      -1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
-        0.0f, -0.5f,  2.5f,     -1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
-        0.0f,  -0.45f,  2.5f,   -1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
-
-        1.0f,  -0.45f,  2.5f,   0.0f, 0.0f, 1.0f,       1.0f, 0.0f,
-        1.0f,  -0.45f, 1.5f,    0.0f, 0.0f, 1.0f,       1.0f, 1.0f,
-        1.0f, -0.5f, 1.5f,      0.0f, 0.0f, 1.0f,       0.0f, 1.0f,
-        1.0f, -0.5f, 1.5f,      0.0f, 0.0f, 1.0f,       0.0f, 1.0f,
-        1.0f, -0.5f,  2.5f,     0.0f, 0.0f, 1.0f,       0.0f, 0.0f,
-        1.0f,  -0.45f,  2.5f,   0.0f, 0.0f, 1.0f,       1.0f, 0.0f,
-
-        0.0f, -0.5f, 1.5f,      0.0f, 1.0f, 0.0f,       0.0f, 1.0f,
-        1.0f, -0.5f, 1.5f,      0.0f, 1.0f, 0.0f,       1.0f, 1.0f,
-        1.0f, -0.5f,  2.5f,     0.0f, 1.0f, 0.0f,       1.0f, 0.0f,
-        1.0f, -0.5f,  2.5f,     0.0f, 1.0f, 0.0f,       1.0f, 0.0f,
-        0.0f, -0.5f,  2.5f,     0.0f, 1.0f, 0.0f,       0.0f, 0.0f,
-        0.0f, -0.5f, 1.5f,      0.0f, 1.0f, 0.0f,       0.0f, 1.0f,
-
-        0.0f,  -0.45f, 1.5f,    0.0f, -1.0f, 0.0f,       0.0f, 1.0f,
-        1.0f,  -0.45f, 1.5f,    0.0f, -1.0f, 0.0f,       1.0f, 1.0f,
-        1.0f,  -0.45f,  2.5f,   0.0f, -1.0f, 0.0f,       1.0f, 0.0f,
-        1.0f,  -0.45f,  2.5f,   0.0f, -1.0f, 0.0f,       1.0f, 0.0f,
-        0.0f,  -0.45f,  2.5f,   0.0f, -1.0f, 0.0f,       0.0f, 0.0f,
-        0.0f,  -0.45f, 1.5f,    0.0f, -1.0f, 0.0f,       0.0f, 1.0f
-
-    };
-
-
-    unsigned int VBO2, VAO2;
-    glGenVertexArrays(1, &VAO2);
-    glGenBuffers(1, &VBO2);
-    glBindVertexArray(VAO2);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO2);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(coaster), coaster, GL_STATIC_DRAW);
-  
-    // Create Vertex Attribute Pointers
-    glVertexAttribPointer(0, floatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, floatsPerNormal, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * floatsPerVertex));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, floatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * (floatsPerVertex + floatsPerNormal)));
-    glEnableVertexAttribArray(2);
-
-    GLfloat lamp[] = {
-        // Vertex Positions    
-        //first triangle
-         0.0f, 1.0f, 0.0f,   0.0f, 0.5f, 1.0f,   0.5f, 1.0f,
-         -0.5f, 0.0f, 0.5f,  0.0f, 0.5f, 1.0f,   0.0f, 0.0f,
-         0.5f, 0.0f, 0.5f,   0.0f, 0.5f, 1.0f,   1.0f, 0.0f,
-
-         //second triangle
-         0.0f, 1.0f, 0.0f,   1.0f, 0.5f, 0.0f,   0.5f, 1.0f,
-         -0.5, 0.0f, 0.5f,   1.0f, 0.5f, 0.0f,   0.0f, 0.0f,
-         -0.5, 0.0f, -0.5f,  1.0f, 0.5f, 0.0f,   1.0f, 0.0f,
-
-         //third triangle
-         0.0f, 1.0f, 0.0f,   0.0f, 0.5f, -1.0f,   0.5f, 1.0f,
-         -0.5f, 0.0f, -0.5f, 0.0f, 0.5f, -1.0f,   0.0f, 0.0f,
-         0.5f, 0.0f, -0.5f,  0.0f, 0.5f, -1.0f,   1.0f, 0.0f,
-
-         //fourth triangle
-         0.0f, 1.0f, 0.0f,   -1.0f, 0.5f, 0.0f,   0.5f, 1.0f,
-         0.5f, 0.0f, -0.5f,  -1.0f, 0.5f, 0.0f,   0.0f, 0.0f,
-         0.5f, 0.0f, 0.5f,   -1.0f, 0.5f, 0.0f,   1.0f, 0.0f,
-
-         //base
-         -0.5f, 0.0f, -0.5f,  0.0f, -1.0f, 0.0f,  0.0f, 0.0f,
-         0.5f, 0.0f, 0.5f,    0.0f, -1.0f, 0.0f,  1.0f, 1.0f,
-         -0.5f, 0.0f, 0.5f,   0.0f, -1.0f, 0.0f,  0.0f, 1.0f,
-         -0.5f, 0.0f, -0.5f,  0.0f, -1.0f, 0.0f,  0.0f, 0.0f,
-         0.5f, 0.0f, 0.5f,    0.0f, -1.0f, 0.0f,  1.0f, 1.0f,
-         0.5f, 0.0f, -0.5f,   0.0f, -1.0f, 0.0f,  1.0f, 0.0f,
-
-
-    };
-    unsigned int VBO3, VAO3;
-    glGenVertexArrays(1, &VAO3);
-    glGenBuffers(1, &VBO3);
-    glBindVertexArray(VAO3);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO3);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(lamp), lamp, GL_STATIC_DRAW);
-
-    // Create Vertex Attribute Pointers
-    glVertexAttribPointer(0, floatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, floatsPerNormal, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float)* floatsPerVertex));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, floatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float)* (floatsPerVertex + floatsPerNormal)));
-    glEnableVertexAttribArray(2);
-
-    // Position and Color data
-    GLfloat stand[] = {
-        //top
-        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //1
-        -0.7f, 0.0f, 0.7f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.0f, 0.0f, 1.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //2
-        0.0f, 0.0f, 1.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.7f, 0.0f, 0.7f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //3
-        0.7f, 0.0f, 0.7f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        1.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //4
-        1.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.7f, 0.0f, -0.7f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //5
-        0.7f, 0.0f, -0.7f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.0f, 0.0f, -1.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //6
-        0.0f, 0.0f, -1.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        -0.7f, 0.0f, -0.7f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //7
-        -0.7f, 0.0f, -0.7f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        -1.0f, 0.0f, 0.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //8
-        -1.0f, 0.0f, 0.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        -0.7f, 0.0f, 0.7f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        
-        //base
-        -0.3f, -0.5f, -0.3f,      0.0f, 0.0f, -1.0f,       0.0f, 0.0f,
-        0.3f, -0.5f, -0.3f,      0.0f, 0.0f, -1.0f,       1.0f, 0.0f,
-        0.3f,  0.0f, -0.3f,    0.0f, 0.0f, -1.0f,       1.0f, 1.0f,
-        0.3f,  0.0f, -0.3f,    0.0f, 0.0f, -1.0f,       1.0f, 1.0f,
-        -0.3f,  0.0f, -0.3f,    0.0f, 0.0f, -1.0f,       0.0f, 1.0f,
-        -0.3,  -0.5f, -0.3f,       0.0f, 0.0f, -1.0f,       0.0f, 0.0f,
-
-        -0.3f, -0.5f,  0.3f,     1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
-        0.3f, -0.5f,  0.3f,     1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
-        0.3f,  0.0f,  0.3f,   1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
-        0.3f,  0.0f,  0.3f,   1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
-        -0.3f,  0.0f,  0.3f,   1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
-        -0.3f, -0.5f,  0.3f,     1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
-
-        -0.3f,  0.0f,  0.3f,   -1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
-        -0.3f,  0.0f, -0.3f,    -1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
-        -0.3f, -0.5f, -0.3f,      -1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
-        -0.3f, -0.5f, -0.3f,      -1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
-        -0.3f, -0.5f,  0.3f,     -1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
-        -0.3f,  0.0f, 0.3f,   -1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
-
-        0.3f,  0.0f,  0.3f,   0.0f, 0.0f, 1.0f,       1.0f, 0.0f,
-        0.3f,  0.f, -0.3f,    0.0f, 0.0f, 1.0f,       1.0f, 1.0f,
-        0.3f, -0.5f, -0.3f,      0.0f, 0.0f, 1.0f,       0.0f, 1.0f,
-        0.3f, -0.5f, -0.3f,      0.0f, 0.0f, 1.0f,       0.0f, 1.0f,
-        0.3f, -0.5f,  0.3f,     0.0f, 0.0f, 1.0f,       0.0f, 0.0f,
-        0.3f,  0.0f,  0.3f,   0.0f, 0.0f, 1.0f,       1.0f, 0.0f,
-
-        -0.3f, -0.5f, -0.3f,      0.0f, 1.0f, 0.0f,       0.0f, 1.0f,
-        0.3f, -0.5f, -0.3f,      0.0f, 1.0f, 0.0f,       1.0f, 1.0f,
-        0.3f, -0.5f,  0.3f,     0.0f, 1.0f, 0.0f,       1.0f, 0.0f,
-        0.3f, -0.5f,  0.3f,     0.0f, 1.0f, 0.0f,       1.0f, 0.0f,
-        -0.3f, -0.5f,  0.3f,     0.0f, 1.0f, 0.0f,       0.0f, 0.0f,
-        -0.3f, -0.5f, -0.3f,      0.0f, 1.0f, 0.0f,       0.0f, 1.0f,
-
-
-
-    };
-
-    unsigned int VBO4, VAO4;
-    glGenVertexArrays(1, &VAO4);
-    glGenBuffers(1, &VBO4);
-    glBindVertexArray(VAO4);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO4);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(stand), stand, GL_STATIC_DRAW);
-
-    // Create Vertex Attribute Pointers
-    glVertexAttribPointer(0, floatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, floatsPerNormal, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float)* floatsPerVertex));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, floatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float)* (floatsPerVertex + floatsPerNormal)));
-    glEnableVertexAttribArray(2);
-
-    GLfloat cup[]{
-        
-
-        //bottom
-        0.5f, -0.449f, 2.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //1
-        0.325f, -0.449f, 2.175f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.5f, -0.449f, 2.25f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.5f, -0.449f, 2.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //2
-        0.5f, -0.449f, 2.25f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.675f, -0.449f, 2.175f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.5f, -0.449f, 2.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //3
-        0.675f, -0.449f, 2.175f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.75f, -0.449f, 2.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.5f, -0.449f, 2.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //4
-        0.75f, -0.449f, 2.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.675f, -0.449f, 1.825f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.5f, -0.449f, 2.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //5
-        0.675f, -0.449f, 1.825f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.5f, -0.449f, 1.75f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.5f, -0.449f, 2.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //6
-        0.5f, -0.449f, 1.75f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.325f, -0.449f, 1.825f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.5f, -0.449f, 2.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //7
-        0.325f, -0.449f, 1.825f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.25f, -0.449f, 2.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.5f, -0.449f, 2.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //8
-        0.25f, -0.449f, 2.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.325f, -0.449f, 2.175f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-
-        //sides
-        0.26f, 0.5f, 2.24f,         0.0f, 0.0f, 1.0f,   0.0f, 1.0f, //1
-        0.5f, 0.5f, 2.34f,          0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
-        0.325f, -0.45f, 2.175f,     0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
-        0.325f, -0.45f, 2.175f,     0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
-        0.5f, -0.45f, 2.25f,        0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
-        0.5f, 0.5f, 2.34f,          0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
-
-        0.5f, 0.5f, 2.34f,           0.0f, 0.0f, 1.0f,   0.0f, 1.0f, //2
-        0.74f, 0.5f, 2.24f,         0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
-        0.5f, -0.45f, 2.25f,        0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
-        0.5f, -0.45f, 2.25f,        0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
-        0.675f, -0.45f, 2.175f,     0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
-        0.74f, 0.5f, 2.24f,         0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
-
-        0.74f, 0.5f, 2.24f,         1.0f, 0.0f, -0.2f,   0.0f, 1.0f, //3
-        0.85f, 0.5f, 2.0f,          1.0f, 0.0f, -0.2f,   0.0f, 1.0f,
-        0.675f, -0.45f, 2.175f,     1.0f, 0.0f, -0.2f,   0.0f, 1.0f,
-        0.675f, -0.45f, 2.175f,     1.0f, 0.0f, -0.2f,   0.0f, 1.0f,
-        0.75f, -0.45f, 2.0f,        1.0f, 0.0f, -0.2f,   0.0f, 1.0f,
-        0.85f, 0.5f, 2.0f,          1.0f, 0.0f, -0.2f,   0.0f, 1.0f,
-
-        0.85f, 0.5f, 2.0f,          1.0f, 0.0f, -0.5f,   0.0f, 1.0f, //4
-        0.74f, 0.5f, 1.76f,         1.0f, 0.0f, -0.5f,   0.0f, 1.0f,
-        0.75f, -0.45f, 2.0f,        1.0f, 0.0f, -0.5f,   0.0f, 1.0f,
-        0.75f, -0.45f, 2.0f,        1.0f, 0.0f, -0.5f,   0.0f, 1.0f,
-        0.675f, -0.45f, 1.825f,     1.0f, 0.0f, -0.5f,   0.0f, 1.0f,
-        0.74f, 0.5f, 1.76f,         1.0f, 0.0f, -0.5f,   0.0f, 1.0f,
-
-        0.74f, 0.5f, 1.76f,         0.0f, 0.0f, -1.0f,   0.0f, 1.0f, //5
-        0.5f, 0.5f, 1.65f,          0.0f, 0.0f, -1.0f,   0.0f, 1.0f,
-        0.675f, -0.45f, 1.825f,     0.0f, 0.0f, -1.0f,   0.0f, 1.0f,
-        0.675f, -0.45f, 1.825f,     0.0f, 0.0f, -1.0f,   0.0f, 1.0f,
-        0.5f, -0.45f, 1.75f,        0.0f, 0.0f, -1.0f,   0.0f, 1.0f,
-        0.5f, 0.5f, 1.65f,          0.0f, 0.0f, -1.0f,   0.0f, 1.0f,
-
-        0.5f, 0.5f, 1.65f,      0.0f, 0.0f, -1.0f,      0.0f, 1.0f,//6
-        0.26f, 0.5f, 1.76f,     0.0f, 0.0f, -1.0f,      0.0f, 1.0f,
-        0.5f, -0.45, 1.75f,     0.0f, 0.0f, -1.0f,      0.0f, 1.0f,
-        0.5f, -0.45, 1.75f,     0.0f, 0.0f, -1.0f,      0.0f, 1.0f,
-        0.325f, -0.45f, 1.825f, 0.0f, 0.0f,-1.0f,       0.0f, 1.0f,
-        0.26f, 0.5f, 1.76f,     0.0f, 0.0f, -1.0f,      0.0f, 1.0f,
-
-        0.26f, 0.5f, 1.76f,     -1.0f, 0.0f, -0.5f,      0.0f, 1.0f, //7
-        0.15f, 0.5f, 2.0f,      -1.0f, 0.0f, -0.5f,      0.0f, 1.0f,
-        0.325f, -0.45f, 1.825f, -1.0f, 0.0f, -0.5f,      0.0f, 1.0f,
-        0.325f, -0.45f, 1.825f, -1.0f, 0.0f, -0.5f,      0.0f, 1.0f,
-        0.25f, -0.45f, 2.0f,    -1.0f, 0.0f, -0.5f,      0.0f, 1.0f,
-        0.15f, 0.5f, 2.0f,      -1.0f, 0.0f, -0.5f,      0.0f, 1.0f,
-
-        0.15f, 0.5f, 2.0f,      -1.0f, 0.0f, -0.2f,      0.0f, 1.0f, //8
-        0.26f, 0.5f, 2.24f,     -1.0f, 0.0f, -0.2f,      0.0f, 1.0f,
-        0.25f, -0.45f, 2.0f,    -1.0f, 0.0f, -0.2f,      0.0f, 1.0f,
-        0.25f, -0.45f, 2.0f,    -1.0f, 0.0f, -0.2f,      0.0f, 1.0f,
-        0.325f, -0.45f, 2.175f, -1.0f, 0.0f, -0.2f,      0.0f, 1.0f,
-        0.26f, 0.5f, 2.24f,     -1.0f, 0.0f, -0.2f,      0.0f, 1.0f,
-
-
-    };
-
-    unsigned int VBO5, VAO5;
-    glGenVertexArrays(1, &VAO5);
-    glGenBuffers(1, &VBO5);
-    glBindVertexArray(VAO5);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO5);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cup), cup, GL_STATIC_DRAW);
-
-    // Create Vertex Attribute Pointers
-    glVertexAttribPointer(0, floatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, floatsPerNormal, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float)* floatsPerVertex));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, floatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float)* (floatsPerVertex + floatsPerNormal)));
-    glEnableVertexAttribArray(2);
-
-    GLfloat candle[]{
-        //bottom
-         0.0f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //1
-        -0.35f, 0.01f, 0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.0f, 0.01f, 0.5f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //2
-        0.0f, 0.01f, 0.5f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.35f, 0.01f, 0.35f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //3
-        0.35f, 0.01f, 0.35f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.5f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //4
-        0.5f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.35f, 0.01f, -0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //5
-        0.35f, 0.01f, -0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.0f, 0.01f, -0.5f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //6
-        0.0f, 0.01f, -0.5f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        -0.35f, 0.01f, -0.35f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //7
-        -0.35f, 0.01f, -0.35f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        -0.5f, 0.01f, 0.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //8
-        -0.5f, 0.01f, 0.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        -0.35f, 0.01f, 0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-
-        //sides
-        -0.35f, 0.01f, 0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 0.0f, //1
-        0.0f, 0.01f, 0.5f,       0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-        -0.35f, 0.3f, 0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        -0.35f, 0.3f, 0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.0f, 0.3f, 0.5f,       0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
-        0.0f, 0.01f, 0.5f,       0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-
-        0.0f, 0.01f, 0.5f,       0.0f, 1.0f, 0.0f,   0.0f, 0.0f, //2
-        0.35f, 0.01f, 0.35f,     0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-        0.0f, 0.3f, 0.5f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.0f, 0.3f, 0.5f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.35f, 0.3f, 0.35f,     0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
-        0.35f, 0.01f, 0.35f,     0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-
-        0.35f, 0.01f, 0.35f,     0.0f, 1.0f, 0.0f,   0.0f, 0.0f,//3
-        0.5f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-        0.35f, 0.3f, 0.35f,     0.0f, 1.0f, 0.0f,  0.0f, 1.0f,
-        0.35f, 0.3f, 0.35f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.5f, 0.3f, 0.0f,       0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
-        0.5f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-
-        0.5f, 0.01f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 0.0f,//4
-        0.35f, 0.01f, -0.35f,    0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-        0.5f, 0.3f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.5f, 0.3f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.35f, 0.3f, -0.35f,    0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
-        0.35f, 0.01f, -0.35f,    0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-
-        0.35f, 0.01f, -0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 0.0f,//5
-        0.0f, 0.01f, -0.5f,      0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-        0.35f, 0.3f, -0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.35f, 0.3f, -0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.0f, 0.3f, -0.5f,      0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
-        0.0f, 0.01f, -0.5f,     0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-
-        0.0f, 0.01f, -0.5f,         0.0f, 1.0f, 0.0f, 0.0f, 1.0f, //6
-        -0.35f, 0.01f, -0.35f,      0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.3f, -0.5f,          0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        0.0f, 0.3f, -0.5f,          0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        -0.35f, 0.3f, -0.35f,       0.0f, 1.0f, 0.0f, 1.0f, 1.0f,
-        -0.35f, 0.01f, -0.35f,       0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-
-        -0.35f, 0.01f, -0.35f,      0.0f, 1.0f, 0.0f, 0.0f, 0.0f, //7
-        -0.5f, 0.01f, 0.0f,         0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-        -0.35f, 0.3f, -0.35f,       0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        -0.35f, 0.3f, -0.35f,       0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        -0.5f, 0.3f, 0.0f,          0.0f, 1.0f, 0.0f, 1.0f, 1.0f,
-        -0.5f, 0.01f, 0.0f,         0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-
-        -0.5f, 0.01f, 0.0f,     0.0f, 1.0f, 0.0f, 0.0f, 0.0f,//8
-        -0.35f, 0.01f, 0.35f,    0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-        -0.5f, 0.3f, 0.0f,      0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        -0.5f, 0.3f, 0.0f,      0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        -0.35f, 0.3f, 0.35f,    0.0f, 1.0f, 0.0f, 1.0f, 1.0f,
-        -0.35f, 0.01f, 0.35f,   0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-
-
-    };
-
-    unsigned int VBO6, VAO6;
-    glGenVertexArrays(1, &VAO6);
-    glGenBuffers(1, &VBO6);
-    glBindVertexArray(VAO6);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO6);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(candle), candle, GL_STATIC_DRAW);
-
-    // Create Vertex Attribute Pointers
-    glVertexAttribPointer(0, floatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, floatsPerNormal, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float)* floatsPerVertex));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, floatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float)* (floatsPerVertex + floatsPerNormal)));
-    glEnableVertexAttribArray(2);
-
-    GLfloat lid[]{
-        //top
-         0.0f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.5f, 0.5f, //1
-        -0.35f, 0.4f, 0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.0f, 0.4f, 0.5f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.5f, 0.5f, //2
-        0.0f, 0.4f, 0.5f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.35f, 0.4f, 0.35f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.5f, 0.5f, //3
-        0.35f, 0.4f, 0.35f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.5f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.5f, 0.5f, //4
-        0.5f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.35f, 0.4f, -0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.5f, 0.5f, //5
-        0.35f, 0.4f, -0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        0.0f, 0.4f, -0.5f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.5f, 0.5f, //6
-        0.0f, 0.4f, -0.5f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        -0.35f, 0.4f, -0.35f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.5f, 0.5f, //7
-        -0.35f, 0.4f, -0.35f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        -0.5f, 0.4f, 0.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-        0.0f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.5f, 0.5f, //8
-        -0.5f, 0.4f, 0.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-        -0.35f, 0.4f, 0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-
-
-        //sides
-        -0.35f, 0.3f, 0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 0.0f, //1
-        0.0f, 0.3f, 0.5f,       0.0f, 1.0f, 0.0f,   0.0f, 0.125f,
-        -0.35f, 0.4f, 0.35f,    0.0f, 1.0f, 0.0f,   0.4f, 0.0f,
-        -0.35f, 0.4f, 0.35f,    0.0f, 1.0f, 0.0f,   0.4f, 0.0f,
-        0.0f, 0.4f, 0.5f,       0.0f, 1.0f, 0.0f,   0.4f, 0.125f,
-        0.0f, 0.3f, 0.5f,       0.0f, 1.0f, 0.0f,   0.0f, 0.125f,
-
-        0.0f, 0.3f, 0.5f,       0.0f, 1.0f, 0.0f,   0.0f, 0.125f, //2
-        0.35f, 0.3f, 0.35f,     0.0f, 1.0f, 0.0f,   0.0f, 0.25f,
-        0.0f, 0.4f, 0.5f,       0.0f, 1.0f, 0.0f,   0.4f, 0.125f,
-        0.0f, 0.4f, 0.5f,       0.0f, 1.0f, 0.0f,   0.4f, 0.125f,
-        0.35f, 0.4f, 0.35f,     0.0f, 1.0f, 0.0f,   0.4f, 0.25f,
-        0.35f, 0.3f, 0.35f,     0.0f, 1.0f, 0.0f,   0.0f, 0.25f,
-
-        0.35f, 0.3f, 0.35f,     0.0f, 1.0f, 0.0f,   0.0f, 0.25f,//3
-        0.5f, 0.3f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 0.375f,
-        0.35f, 0.4f, 0.35f,     0.0f, 1.0f, 0.0f,   0.4f, 0.25f,
-        0.35f, 0.4f, 0.35f,     0.0f, 1.0f, 0.0f,   0.4f, 0.25f,
-        0.5f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.4f, 0.375f,
-        0.5f, 0.3f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 0.375f,
-
-        0.5f, 0.3f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 0.375f,//4
-        0.35f, 0.3f, -0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 0.5f,
-        0.5f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.4f, 0.375f,
-        0.5f, 0.4f, 0.0f,       0.0f, 1.0f, 0.0f,   0.4f, 0.375f,
-        0.35f, 0.4f, -0.35f,    0.0f, 1.0f, 0.0f,   0.4f, 0.5f,
-        0.35f, 0.3f, -0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 0.5f,
-
-        0.35f, 0.3f, -0.35f,    0.0f, 1.0f, 0.0f,   0.0f, 0.5f,//5
-        0.0f, 0.3f, -0.5f,      0.0f, 1.0f, 0.0f,   0.0f, 0.625f,
-        0.35f, 0.4f, -0.35f,    0.0f, 1.0f, 0.0f,   0.4f, 0.5f,
-        0.35f, 0.4f, -0.35f,    0.0f, 1.0f, 0.0f,   0.4f, 0.5f,
-        0.0f, 0.4f, -0.5f,      0.0f, 1.0f, 0.0f,   0.4f, 0.625f,
-        0.0f, 0.3f, -0.5f,     0.0f, 1.0f, 0.0f,   0.0f, 0.625f,
-
-        0.0f, 0.3f, -0.5f,         0.0f, 1.0f, 0.0f, 0.0f, 0.625f, //6
-        -0.35f, 0.3f, -0.35f,      0.0f, 1.0f, 0.0f, 0.0f, 0.75f,
-        0.0f, 0.4f, -0.5f,          0.0f, 1.0f, 0.0f, 0.4f, 0.625f,
-        0.0f, 0.4f, -0.5f,          0.0f, 1.0f, 0.0f, 0.4f, 0.625f,
-        -0.35f, 0.4f, -0.35f,       0.0f, 1.0f, 0.0f, 0.4f, 0.75f,
-        -0.35f, 0.3f, -0.35f,       0.0f, 1.0f, 0.0f, 0.0f, 0.75f,
-
-        -0.35f, 0.3f, -0.35f,      0.0f, 1.0f, 0.0f, 0.0f, 0.75f, //7
-        -0.5f, 0.3f, 0.0f,         0.0f, 1.0f, 0.0f, 0.0f, 0.875f,
-        -0.35f, 0.4f, -0.35f,       0.0f, 1.0f, 0.0f, 0.4f, 0.75f,
-        -0.35f, 0.4f, -0.35f,       0.0f, 1.0f, 0.0f, 0.4f, 0.75f,
-        -0.5f, 0.4f, 0.0f,          0.0f, 1.0f, 0.0f, 0.4f, 0.875f,
-        -0.5f, 0.3f, 0.0f,         0.0f, 1.0f, 0.0f, 0.0f, 0.875f,
-
-        -0.5f, 0.3f, 0.0f,     0.0f, 1.0f, 0.0f, 0.0f, 0.875f,//8
-        -0.35f, 0.3f, 0.35f,    0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        -0.5f, 0.4f, 0.0f,      0.0f, 1.0f, 0.0f, 0.4f, 0.875f,
-        -0.5f, 0.4f, 0.0f,      0.0f, 1.0f, 0.0f, 0.4f, 0.875f,
-        -0.35f, 0.4f, 0.35f,    0.0f, 1.0f, 0.0f, 0.4f, 1.0f,
-        -0.35f, 0.3f, 0.35f,   0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-
-
-    };
-
-    unsigned int VBO7, VAO7;
-    glGenVertexArrays(1, &VAO7);
-    glGenBuffers(1, &VBO7);
-    glBindVertexArray(VAO7);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO7);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(lid), lid, GL_STATIC_DRAW);
-
-    // Create Vertex Attribute Pointers
-    glVertexAttribPointer(0, floatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, floatsPerNormal, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float)* floatsPerVertex));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, floatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float)* (floatsPerVertex + floatsPerNormal)));
-    glEnableVertexAttribArray(2);
-
-    // Load texture
-    if (!UCreateTexture("textures/black.jpg", gTextureId))
-    {
-        cout << "Failed to load texture " << "textures/black.jpg" << endl;
-        return EXIT_FAILURE;
-    }
-    if (!UCreateTexture("textures/wood.jpg", gTextureId2))
-    {
-        cout << "Failed to load texture " << "textures/wood.jpg" << endl;
-        return EXIT_FAILURE;
-    }
-    if (!UCreateTexture("textures/matte_black.jpg", gTextureId3))
-    {
-        cout << "Failed to load texture " << "textures/wood.jpg" << endl;
-        return EXIT_FAILURE;
-    }
-    if (!UCreateTexture("textures/blue.jpg", gTextureId5))
-    {
-        cout << "Failed to load texture " << "textures/wood.jpg" << endl;
-        return EXIT_FAILURE;
-    }
-    if (!UCreateTexture("textures/candle.jpg", gTextureId6))
-    {
-        cout << "Failed to load texture " << "textures/wood.jpg" << endl;
-        return EXIT_FAILURE;
-    }
-    if (!UCreateTexture("textures/metal.jpg", gTextureId7))
-    {
-        cout << "Failed to load texture " << "textures/wood.jpg" << endl;
-        return EXIT_FAILURE;
-    }
-    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
-    glUseProgram(gCubeProgramId);
-    // We set the texture as texture unit 0
-    glUniform1i(glGetUniformLocation(gCubeProgramId, "uTexture"), 0);
-
-
-    // Sets the background color of the window to black (it will be implicitely used by glClear)
-    glClearColor(0.0f, 0.0f, 0.2f, 1.0f);
-
-    // render loop
-    // -----------
-    while (!glfwWindowShouldClose(gWindow))
-    {
-
-        //frame logic
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-
-        // input
-        // -----
-        UProcessInput(gWindow);
-
-        glEnable(GL_DEPTH_TEST);
-
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // Set the shader to be used
-        glUseProgram(gCubeProgramId);
-
-        glm::mat4 scale = glm::mat4(1.0f);
-        //translate
-        glm::mat4 trans = glm::mat4(1.0f);
-        // Model matrix
-        glm::mat4 model = trans * scale;
-
-        //camera view
-        glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-
-        //function to tell wich projection to use based on key press
-        if (viewProjection == true) {
-            projection = glm::ortho(-5.0f, 5.0f, -5.0f, 5.0f, 0.1f, 100.0f);
-        }
-        else if (viewProjection == false) {
-            projection = glm::perspective(glm::radians(fov), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 100.0f);
-        }
-
-        // Retrieves and passes transform matrices to the Shader program
-        GLint modelLoc = glGetUniformLocation(gCubeProgramId, "model");
-        GLint viewLoc = glGetUniformLocation(gCubeProgramId, "view");
-        GLint projLoc = glGetUniformLocation(gCubeProgramId, "projection");
-
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-        // Reference matrix uniforms from the Cube Shader program for the cub color, light color, light position, and camera position
-        GLint objectColorLoc = glGetUniformLocation(gCubeProgramId, "objectColor");
-        GLint lightColorLoc = glGetUniformLocation(gCubeProgramId, "lightColor");
-        GLint lightPositionLoc = glGetUniformLocation(gCubeProgramId, "lightPos");
-        GLint viewPositionLoc = glGetUniformLocation(gCubeProgramId, "viewPosition");
-
-        // Pass color, light, and camera data to the Cube Shader program's corresponding uniforms
-        glUniform3f(objectColorLoc, gObjectColor.r, gObjectColor.g, gObjectColor.b);
-        glUniform3f(lightColorLoc, gLightColor.r, gLightColor.g, gLightColor.b);
-        glUniform3f(lightPositionLoc, gLightPosition.x, gLightPosition.y, gLightPosition.z);
-        const glm::vec3 cameraPosition = cameraPos;
-        glUniform3f(viewPositionLoc, cameraPosition.x, cameraPosition.y, cameraPosition.z);
-
-        GLint UVScaleLoc = glGetUniformLocation(gCubeProgramId, "uvScale");
-        glUniform2fv(UVScaleLoc, 1, glm::value_ptr(gUVScale));
-
-        //draw plane
-        // bind textures on corresponding texture units
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gTextureId);
-        // Activate the VBOs contained within the mesh's VAO
-        glBindVertexArray(VAO);
-        // Draws the triangles
-        glDrawArrays(GL_TRIANGLES, 0, 6); // Draws the triangle
-        glBindVertexArray(0);
-
-
-        //draw coaster
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gTextureId2);
-        glBindVertexArray(VAO2);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
-
-        //draw stand
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gTextureId3);
-        glBindVertexArray(VAO4);
-        glDrawArrays(GL_TRIANGLES, 0, 54);
-        glBindVertexArray(0);
-
-        //draw cup
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gTextureId5);
-        glBindVertexArray(VAO5);
-        glDrawArrays(GL_TRIANGLES, 0, 78);
-        glBindVertexArray(0);
-
-        //draw candle
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gTextureId6);
-        glBindVertexArray(VAO6);
-        glDrawArrays(GL_TRIANGLES, 0, 78);
-        glBindVertexArray(0);
-
-        //draw lid
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gTextureId7);
-        glBindVertexArray(VAO7);
-        glDrawArrays(GL_TRIANGLES, 0, 78);
-        glBindVertexArray(0);
-
-        // LAMP: draw lamp
-        //----------------
-        glUseProgram(gLightProgramId);
-
-        //Transform the smaller cube used as a visual que for the light source
-        model = glm::translate(gLightPosition) * glm::scale(gLightScale);
-
-        // Reference matrix uniforms from the Lamp Shader program
-        modelLoc = glGetUniformLocation(gLightProgramId, "model");
-        viewLoc = glGetUniformLocation(gLightProgramId, "view");
-        projLoc = glGetUniformLocation(gLightProgramId, "projection");
-
-        // Pass matrix data to the Lamp Shader program's matrix uniforms
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-        glBindVertexArray(VAO3);
-        glDrawArrays(GL_TRIANGLES, 0, 18);
-        glBindVertexArray(0);
-
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        glfwSwapBuffers(gWindow);    // Flips the the back buffer with the front buffer every frame.
-
-        glfwPollEvents();
-    }
-
-    // Release mesh data
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(2, &VBO);
-    glDeleteVertexArrays(1, &VAO2);
-    glDeleteBuffers(2, &VBO2);
-    glDeleteVertexArrays(1, &VAO3);
-    glDeleteBuffers(2, &VBO3);
-    glDeleteVertexArrays(1, &VAO4);
-    glDeleteBuffers(2, &VBO4);
-    glDeleteVertexArrays(1, &VAO5);
-    glDeleteBuffers(2, &VBO5);
-    glDeleteVertexArrays(1, &VAO6);
-    glDeleteBuffers(2, &VBO6);
-    glDeleteVertexArrays(1, &VAO7);
-    glDeleteBuffers(2, &VBO7);
-
-    //destroy textures used
-    UDestroyTexture(gTextureId);
-    UDestroyTexture(gTextureId2);
-    UDestroyTexture(gTextureId3);
-    UDestroyTexture(gTextureId5);
-    UDestroyTexture(gTextureId6);
-    UDestroyTexture(gTextureId7);
-
-    // Release shader program
-    UDestroyShaderProgram(gCubeProgramId);
-
-    exit(EXIT_SUCCESS); // Terminates the program successfully
-}
-
-
-// Initialize GLFW, GLEW, and create a window
-bool UInitialize(int argc, char* argv[], GLFWwindow** window)
-{
-    // GLFW: initialize and configure
-    // ------------------------------
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
-
-    // GLFW: window creation
-    // ---------------------
-    * window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE, NULL, NULL);
-    if (*window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return false;
-    }
-    glfwMakeContextCurrent(*window);
-    glfwSetFramebufferSizeCallback(*window, UResizeWindow);
-    glfwSetCursorPosCallback(*window, mouse_callback);
-    glfwSetScrollCallback(*window, scroll_callback);
-
-    //mouse capture
-    glfwSetInputMode(*window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-    // GLEW: initialize
-    // ----------------
-    // Note: if using GLEW version 1.13 or earlier
-    glewExperimental = GL_TRUE;
-    GLenum GlewInitResult = glewInit();
-
-    if (GLEW_OK != GlewInitResult)
-    {
-        std::cerr << glewGetErrorString(GlewInitResult) << std::endl;
-        return false;
-    }
-
-    // Displays GPU OpenGL version
-    cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << endl;
-
-    return true;
-}
-
-
-// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
-void UProcessInput(GLFWwindow* window)
-{
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
-
-    float cameraSpeed = static_cast<float>(2.5 * deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        cameraPos += cameraSpeed * cameraFront;
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        cameraPos -= cameraSpeed * cameraFront;
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
-    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
-        cameraPos += cameraUp * cameraSpeed;
-    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
-        cameraPos -= cameraUp * cameraSpeed;
-    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
-        if (viewProjection == true) {
-            viewProjection = false;            
-        }
-        else if (viewProjection == false) {
-            viewProjection = true;
-        }
-
-}
-
-
-// glfw: whenever the window size changed (by OS or user resize) this callback function executes
-void UResizeWindow(GLFWwindow* window, int width, int height)
-{
-    glViewport(0, 0, width, height);
-}
-
-
-/*Generate and load the texture*/
-bool UCreateTexture(const char* filename, GLuint& textureId)
-{
-    int width, height, channels;
-    unsigned char* image = stbi_load(filename, &width, &height, &channels, 0);
-    if (image)
-    {
-        glGenTextures(1, &textureId);
-        glBindTexture(GL_TEXTURE_2D, textureId);
-
-        // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        if (channels == 3)
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-        else if (channels == 4)
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-        else
-        {
-            cout << "Not implemented to handle image with " << channels << " channels" << endl;
-            return false;
-        }
-
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        stbi_image_free(image);
-        glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-        return true;
-    }
-
-    // Error loading the image
-    return false;
-}
-
-
-void UDestroyTexture(GLuint textureId)
-{
-    glGenTextures(1, &textureId);
-}
-
-
-// Implements the UCreateShaders function
-bool UCreateShaderProgram(const char* vtxShaderSource, const char* fragShaderSource, GLuint& programId)
-{
-    // Compilation and linkage error reporting
-    int success = 0;
-    char infoLog[512];
-
-    // Create a Shader program object.
-    programId = glCreateProgram();
-
-    // Create the vertex and fragment shader objects
-    GLuint vertexShaderId = glCreateShader(GL_VERTEX_SHADER);
-    GLuint fragmentShaderId = glCreateShader(GL_FRAGMENT_SHADER);
-
-    // Retrive the shader source
-    glShaderSource(vertexShaderId, 1, &vtxShaderSource, NULL);
-    glShaderSource(fragmentShaderId, 1, &fragShaderSource, NULL);
-
-    // Compile the vertex shader, and print compilation errors (if any)
-    glCompileShader(vertexShaderId); // compile the vertex shader
-    // check for shader compile errors
-    glGetShaderiv(vertexShaderId, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShaderId, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-
-        return false;
-    }
-
-    glCompileShader(fragmentShaderId); // compile the fragment shader
-    // check for shader compile errors
-    glGetShaderiv(fragmentShaderId, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShaderId, sizeof(infoLog), NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-
-        return false;
-    }
-
-    // Attached compiled shaders to the shader program
-    glAttachShader(programId, vertexShaderId);
-    glAttachShader(programId, fragmentShaderId);
-
-    glLinkProgram(programId);   // links the shader program
-    // check for linking errors
-    glGetProgramiv(programId, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(programId, sizeof(infoLog), NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-
-        return false;
-    }
-
-    glUseProgram(programId);    // Uses the shader program
-
-    return true;
-}
-
-
-void UDestroyShaderProgram(GLuint programId)
-{
-    glDeleteProgram(programId);
-}
-
-void mouse_callback(GLFWwindow* window, double xpos, double ypos)
-{
-    if (firstMouse)
-    {
-        lastX = xpos;
-        lastY = ypos;
-        firstMouse = false;
-    }
-
-    float xoffset = xpos - lastX;
-    float yoffset = lastY - ypos;
-    lastX = xpos;
-    lastY = ypos;
-
-    float sensitivity = 0.1f;
-    xoffset *= sensitivity;
-    yoffset *= sensitivity;
-
-    yaw += xoffset;
-    pitch += yoffset;
-
-    if (pitch > 89.0f)
-        pitch = 89.0f;
-    if (pitch < -89.0f)
-        pitch = -89.0f;
-
-    glm::vec3 direction;
-    direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
-    direction.y = sin(glm::radians(pitch));
-    direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
-    cameraFront = glm::normalize(direction);
-}
-
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
-{
-    fov -= (float)yoffset;
-    if (fov < 1.0f)
-        fov = 1.0f;
-    if (fov > 45.0f)
-        fov = 45.0f;
-}
-
+#include <iostream>         // cout, cerr
+#include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <string>           // LOD mesh names
+#include <random>           // Stress scene transforms
+#include <include/GL/glew.h>        // GLEW library
+#include <include/GLFW/glfw3.h>     // GLFW library
+#include "mesh.h"                   // Mesh welding and indexing
+#include "mesh_registry.h"          // Shared vertex / index arena
+#include "mesh_gen.h"               // Procedural cylinders, tubes and boxes
+#include "mesh_optimize.h"          // Vertex cache, overdraw and fetch ordering
+#include "meshlet.h"                // Meshlet clusters and per-cluster culling
+#include "frustum.h"                // View frustum planes
+#include "mesh_file.h"              // Memory-mapped .mesh files
+#include "mesh_import.h"            // OBJ / glTF importers
+#include "bvh.h"                    // Scene BVH
+#include "pick.h"                   // Cursor ray picking
+#include "mesh_normals.h"           // Normal and tangent generation
+#include "mesh_simplify.h"          // Quadric LOD simplification
+#include "uniforms.h"               // Cached uniform locations
+#include "uniform_blocks.h"         // Shared frame and per-object uniform blocks
+#include "render_queue.h"           // Sorted draw packets
+#include "gl_state.h"               // Redundant state filter
+#include "indirect_draw.h"          // Multi-draw indirect submission
+#include "texture_array.h"          // Material textures packed into array textures
+#include "instancing.h"             // Instanced stress scene
+#include "dynamic_ring.h"           // Persistently mapped per-frame upload ring
+#include "object_transforms.h"      // Batched MVP and normal matrices
+// After the project headers: texture_array.h includes stb_image.h for its declarations, and the
+// implementation section has no include guard of its own
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace std; // Standard namespace
+
+/*Shader program Macro*/
+#ifndef GLSL
+#define GLSL(Version, Source) "#version " #Version " core \n" #Source
+#endif
+// As GLSL, for shaders that read gl_BaseInstanceARB
+#ifndef GLSL_DRAW_PARAMETERS
+#define GLSL_DRAW_PARAMETERS(Version, Source) "#version " #Version " core \n#extension GL_ARB_shader_draw_parameters : require \n" #Source
+#endif
+
+// Unnamed namespace
+namespace
+{
+    const char* const WINDOW_TITLE = "Eduardo Orozco"; // Macro for window title
+
+    // Variables for window width and height
+    const int WINDOW_WIDTH = 800;
+    const int WINDOW_HEIGHT = 600;
+
+    // Main GLFW window
+    GLFWwindow* gWindow = nullptr;
+    // Shared geometry arena and the handles of the scene meshes inside it
+    MeshRegistry gMeshes;
+    GLuint gPlaneMesh;
+    GLuint gCoasterMesh;
+    GLuint gLampMesh;
+    GLuint gStandMesh;
+
+    // Registry handles of one object's LOD levels, finest first, their geometric errors in mesh units
+    // and the point LOD distance is measured from
+    struct LodMesh
+    {
+        std::vector<GLuint> levels;
+        std::vector<float> errors;
+        glm::vec3 center;
+        const char* name;
+    };
+    LodMesh gCupLods;
+    LodMesh gCandleLods;
+    LodMesh gLidLods;
+
+    // Meshes loaded from .mesh, .obj, .gltf or .glb files given with --mesh
+    std::vector<const char*> gMeshFilePaths;
+    std::vector<LodMesh> gFileMeshes;
+
+    // Segment counts of the generated LOD levels
+    const int LOD_SEGMENTS[] = { 64, 32, 16, 8 };
+    // Triangle ratios of the levels simplified from imported meshes with at least LOD_MIN_TRIANGLES triangles
+    const std::vector<float> LOD_RATIOS = { 0.5f, 0.25f, 0.125f, 0.0625f };
+    const size_t LOD_MIN_TRIANGLES = 1024;
+    // The coarsest level whose geometric error projects to at most this many pixels is drawn
+    const float LOD_PIXEL_ERROR = 1.0f;
+    // Pixels one mesh unit covers at distance 1 (perspective) or at any distance (orthographic), set each frame
+    float gLodPixelScale = 1.0f;
+    bool gLodPerspective = true;
+    // Triangles of the selected LOD levels against the finest levels, per frame
+    size_t gLodTriangles = 0;
+    size_t gLodFullTriangles = 0;
+    // Vertex layout of the generated LOD meshes (--float-vertices switches them back to 32-byte vertices)
+    VertexLayout gLodLayout = VERTEX_LAYOUT_PACKED;
+
+    // Faces meeting at less than this many degrees share smoothed normals; sharper edges stay faceted.
+    // The hand-written meshes always get generated normals, imported ones only with --normals.
+    const float NORMAL_CREASE_ANGLE = 30.0f;
+    float gImportCreaseAngle = -1.0f;
+
+    // Meshes with at least this many triangles are split into meshlets and culled per cluster
+    const size_t MESHLET_MIN_TRIANGLES = 256;
+
+    // Per-frame culling state and counters
+    Frustum gFrustum;
+    std::vector<GLuint> gVisibleMeshlets;
+    MeshletCullStats gMeshletStats = {};
+    ObjectCullStats gObjectStats = {};
+
+    // Ids of the pickable scene objects in gSceneBvh; meshes loaded with --mesh follow in load order
+    enum SceneObjectId
+    {
+        OBJECT_PLANE,
+        OBJECT_COASTER,
+        OBJECT_STAND,
+        OBJECT_CUP,
+        OBJECT_CANDLE,
+        OBJECT_LID,
+        OBJECT_LAMP,
+        OBJECT_FILE_MESHES
+    };
+    // Picking state: triangles of each registry mesh (indexed by handle), the placed objects,
+    // and the objects under the cursor and last clicked (object UINT32_MAX for none)
+    std::vector<PickMesh> gPickMeshes;
+    SceneBvh gSceneBvh;
+    std::vector<PickObject> gPickObjects;
+    std::vector<const char*> gObjectNames;
+    PickHit gHover;
+    PickHit gSelection;
+    double gPickTime = 0.0;         // Seconds spent picking since the last stats report
+    const glm::vec3 HOVER_COLOR(0.25f, 0.25f, 0.0f);
+    const glm::vec3 SELECTION_COLOR(0.0f, 0.35f, 0.0f);
+    // Tab switches between mouse look (picks at the screen center) and a free cursor
+    bool gPointerMode = false;
+    bool gTabWasDown = false;
+
+    // Prints per-frame counters once a second (--stats)
+    bool gShowStats = false;
+    float gStatsTimer = 0.0f;
+    int gStatsFrames = 0;
+    // Texture id
+    GLuint gTextureId;
+    GLuint gTextureId2;
+    GLuint gTextureId3;
+    GLuint gTextureId5;
+    GLuint gTextureId6;
+    GLuint gTextureId7;
+    glm::vec2 gUVScale(1.0f, 1.0f);
+    // Shader programs
+    GLuint gCubeProgramId;
+    GLuint gLightProgramId;
+
+    // Camera, light and per-object data live in uniform blocks shared by both programs; only the
+    // sampler is a plain uniform, looked up once after linking
+    Uniform<GLint> gCubeTexture;
+    FrameUniforms gFrameUniforms;
+    ObjectUniforms gObjectUniforms;
+
+    // One visible object of the frame: collected first so all object data is uploaded in one call
+    struct SceneDraw
+    {
+        GLuint mesh;
+        GLuint program;
+        GLuint texture;         // 0 for untextured programs
+        GLuint objectSlot;      // Record in gObjectUniforms
+        glm::mat4 model;        // Unquantized, for meshlet culling
+    };
+    std::vector<SceneDraw> gSceneDraws;
+    // Packets of gSceneDraws, sorted by state and depth before drawing, and the binds they took
+    RenderQueue gRenderQueue;
+    RenderBindStats gRenderStats;
+    const float RENDER_DEPTH_RANGE = 100.0f;   // Distance mapped onto the sort key's depth field
+    // Render loop state changes go through gGLState, which drops redundant calls; --debug-state
+    // cross-checks its shadow copy against the driver every frame
+    GLStateCache gGLState;
+    GLStateStats gGLStateStats;
+    bool gDebugState = false;
+    // The cube program's draws go through one multi-draw indirect call per vertex layout, reading
+    // their object data by gl_BaseInstanceARB and their texture from gSceneTextureArrays;
+    // --no-indirect or a driver without GL_ARB_shader_draw_parameters keeps them in the render queue
+    bool gIndirect = true;
+    GLuint gIndirectProgramId = 0;
+    Uniform<GLint> gIndirectTextures;
+    IndirectDraws gIndirectDraws;
+    // Scene textures repacked by size class; gSceneTextures keeps the names of the 2D textures they
+    // replace, in slot order, as the material keys UQueueDraw receives
+    std::vector<GLuint> gSceneTextures;
+    TextureArrays gSceneTextureArrays;
+    size_t gIndirectCommands = 0;
+    size_t gIndirectCalls = 0;
+    // Stress scene of --stress seeded random coasters, cups and candles, drawn with one instanced
+    // call per mesh; --bench-instancing times instance counts from 1k to 1M at startup
+    size_t gStressCount = 0;
+    unsigned gStressSeed = 1;
+    bool gBenchInstancing = false;
+    GLuint gInstanceProgramId = 0;
+    Uniform<GLuint> gFirstInstance;
+    Uniform<GLint> gInstanceTextures;
+    InstanceBuffer gStressInstances;
+    size_t gInstanceCalls = 0;
+    // Frame and object uniforms and the indirect commands and records are written into a
+    // persistently mapped ring of RING_FRAMES regions; --no-ring uploads them with glBufferSubData.
+    // gRingStats accumulates the time spent waiting for the GPU to release a region.
+    bool gUseRing = true;
+    DynamicRing gRing;
+    RingStats gRingStats;
+    // MVP and normal matrices are computed per object on the CPU, not per vertex; how many models
+    // took the rigid fast path and the time spent. --bench-transforms compares the vertex shaders.
+    ObjectTransformStats gTransformStats;
+    double gTransformTime = 0.0;
+    bool gBenchTransforms = false;
+    // --depth-prepass, or Z at runtime, lays down depth first with position-only programs and then
+    // shades under GL_EQUAL, so each covered pixel runs its fragment shader once. With --stats and
+    // GL_ARB_pipeline_statistics_query the shading pass's fragment shader invocations are counted
+    // per mode, each query read back RING_FRAMES frames after it was issued.
+    bool gDepthPrepass = false;
+    bool gDepthKeyWasDown = false;
+    // The pre-pass reads every mesh's position-only stream, welded by position alone;
+    // --no-position-streams leaves it on the interleaved vertices
+    bool gPositionStreams = true;
+    GLuint gDepthProgramId = 0;
+    GLuint gDepthIndirectProgramId = 0;
+    GLuint gDepthInstanceProgramId = 0;
+    Uniform<GLuint> gDepthFirstInstance;
+    GLuint gFragmentQueries[RING_FRAMES] = {};
+    int gFragmentQueryMode[RING_FRAMES];        // 1 with the pre-pass, 0 without, -1 not issued
+    size_t gFragmentQuery = 0;
+    GLuint64 gFragmentInvocations[2] = {};      // Indexed by mode
+    size_t gFragmentFrames[2] = {};
+    // Times uniform updates through string lookups against cached handles at startup (--bench-uniforms)
+    bool gBenchUniforms = false;
+
+    // Subject position and scale
+    glm::vec3 gCubePosition(0.0f, 0.0f, 0.0f);
+    glm::vec3 gCubeScale(2.0f);
+
+    // Cube and light color
+    //m::vec3 gObjectColor(0.6f, 0.5f, 0.75f);
+    glm::vec3 gObjectColor(1.f, 0.2f, 0.0f);
+    glm::vec3 gLightColor(1.0f, 1.0f, 1.0f);
+
+    // Light position and scale
+    glm::vec3 gLightPosition(0.0f, 2.0f, 0.0f);
+    glm::vec3 gLightScale(0.3f);
+}
+
+/* User-defined Function prototypes to:
+ * initialize the program, set the window size,
+ * redraw graphics on the window when resized,
+ * and render graphics on the screen
+ */
+void UParseArguments(int argc, char* argv[]);
+bool UInitialize(int, char* [], GLFWwindow** window);
+void UResizeWindow(GLFWwindow* window, int width, int height);
+void UProcessInput(GLFWwindow* window);
+GLuint UCreateMesh(const GLfloat* verts, size_t floatCount, const char* name);
+void UCreateLodMesh(const CylinderDesc& desc, const char* name, LodMesh& lod);
+bool ULoadMeshFile(const char* path, LodMesh& lod);
+void UAddPickMesh(GLuint handle, const MeshData& data);
+void UBuildScenePicking();
+void UPickCursor(const glm::mat4& view, const glm::mat4& projection);
+glm::vec3 UHighlightColor(GLuint object);
+GLuint USelectLod(const LodMesh& lod, const glm::vec3& eye);
+bool UIsVisible(GLuint handle, const glm::mat4& model);
+void UQueueDraw(GLuint handle, const glm::mat4& model, GLuint program, GLuint texture, GLuint object);
+void UDrawMesh(GLuint handle, const glm::mat4& model, VertexStream stream = VERTEX_STREAM_FULL);
+const std::vector<GLuint>& UVisibleMeshlets(GLuint handle, const glm::mat4& model);
+void UReportFrameStats();
+bool UCreateTexture(const char* filename, GLuint& textureId);
+TextureSlot UTextureSlot(GLuint texture);
+void UCreateIndirectPath();
+void UCreateInstancingPath();
+void UCreateDepthPrepass();
+void UBeginFragmentQuery(bool prepass);
+void UEndFragmentQuery();
+void UGenerateStressScene(size_t count, unsigned seed, InstanceBuffer& instances);
+void UBenchmarkInstancing();
+void UBenchmarkTransforms();
+void UDestroyTexture(GLuint textureId);
+bool UCreateShaderProgram(const char* vtxShaderSource, const char* fragShaderSource, GLuint& programId);
+void ULookupUniforms();
+void UBenchmarkUniforms();
+void UDestroyShaderProgram(GLuint programId);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+
+
+/* Cube Vertex Shader Source Code*/
+const GLchar* cubeVertexShaderSource = GLSL(440,
+
+    layout(location = 0) in vec3 position; // VAP position 0 for vertex position data
+layout(location = 1) in vec3 normal; // VAP position 1 for normals
+layout(location = 2) in vec2 textureCoordinate;
+
+out vec3 vertexNormal; // For outgoing normals to fragment shader
+out vec3 vertexFragmentPos; // For outgoing color / pixels to fragment shader
+out vec2 vertexTextureCoordinate;
+
+invariant gl_Position; // Matches the depth pre-pass bit for bit under GL_EQUAL
+
+//Uniform blocks shared by all programs, mirrored by FrameData and ObjectData in uniform_blocks.h
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+    vec4 lightPosition;
+    vec4 lightColor;
+};
+layout(std140, binding = 1) uniform ObjectData
+{
+    mat4 model;
+    mat4 modelViewProjection;
+    mat3 normalMatrix;
+    vec4 highlightColor;
+    vec4 uvScale;
+};
+
+void main()
+{
+    gl_Position = modelViewProjection * vec4(position, 1.0f); // Transforms vertices into clip coordinates
+
+    vertexFragmentPos = vec3(model * vec4(position, 1.0f)); // Gets fragment / pixel position in world space only (exclude view and projection)
+
+    vertexNormal = normalMatrix * normal; // get normal vectors in world space only and exclude normal translation properties
+    vertexTextureCoordinate = textureCoordinate;
+}
+);
+
+
+/* Cube Fragment Shader Source Code*/
+const GLchar* cubeFragmentShaderSource = GLSL(440,
+
+    in vec3 vertexNormal; // For incoming normals
+in vec3 vertexFragmentPos; // For incoming fragment position
+in vec2 vertexTextureCoordinate;
+
+out vec4 fragmentColor; // For outgoing cube color to the GPU
+
+// Light color, light position and camera/view position come from the frame block; uv scale and the
+// hovered / selected highlight from the object block
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+    vec4 lightPosition;
+    vec4 lightColor;
+};
+layout(std140, binding = 1) uniform ObjectData
+{
+    mat4 model;
+    mat4 modelViewProjection;
+    mat3 normalMatrix;
+    vec4 highlightColor;
+    vec4 uvScale;
+};
+uniform sampler2D uTexture; // Useful when working with multiple textures
+
+void main()
+{
+    /*Phong lighting model calculations to generate ambient, diffuse, and specular components*/
+
+    //Calculate Ambient lighting*/
+    float ambientStrength = 0.1f; // Set ambient or global lighting strength
+    vec3 ambient = ambientStrength * lightColor.rgb; // Generate ambient light color
+
+    //Calculate Diffuse lighting*/
+    vec3 norm = normalize(vertexNormal); // Normalize vectors to 1 unit
+    vec3 lightDirection = normalize(lightPosition.xyz - vertexFragmentPos); // Calculate distance (light direction) between light source and fragments/pixels on cube
+    float impact = max(dot(norm, lightDirection), 0.0);// Calculate diffuse impact by generating dot product of normal and light
+    vec3 diffuse = impact * lightColor.rgb; // Generate diffuse light color
+
+    //Calculate Specular lighting*/
+    float specularIntensity = 0.8f; // Set specular light strength
+    float highlightSize = 16.0f; // Set specular highlight size
+    vec3 viewDir = normalize(viewPosition.xyz - vertexFragmentPos); // Calculate view direction
+    vec3 reflectDir = reflect(-lightDirection, norm);// Calculate reflection vector
+    //Calculate specular component
+    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), highlightSize);
+    vec3 specular = specularIntensity * specularComponent * lightColor.rgb;
+
+    // Texture holds the color to be used for all three components
+    vec4 textureColor = texture(uTexture, vertexTextureCoordinate * uvScale.xy);
+
+    // Calculate phong result
+    vec3 phong = (ambient + diffuse + specular) * textureColor.xyz;
+
+    fragmentColor = vec4(phong + highlightColor.rgb, 1.0); // Send lighting results to GPU
+}
+);
+
+
+/* Lamp Shader Source Code*/
+const GLchar* lampVertexShaderSource = GLSL(440,
+
+    layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoords;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+invariant gl_Position;
+
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+    vec4 lightPosition;
+    vec4 lightColor;
+};
+layout(std140, binding = 1) uniform ObjectData
+{
+    mat4 model;
+    mat4 modelViewProjection;
+    mat3 normalMatrix;
+    vec4 highlightColor;
+    vec4 uvScale;
+};
+
+void main()
+{
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = normalMatrix * aNormal;
+    TexCoords = aTexCoords;
+
+    gl_Position = modelViewProjection * vec4(aPos, 1.0);
+}
+);
+
+
+/* Fragment Shader Source Code*/
+const GLchar* lampFragmentShaderSource = GLSL(440,
+
+    out vec4 fragmentColor; // For outgoing lamp color (smaller cube) to the GPU
+
+layout(std140, binding = 1) uniform ObjectData
+{
+    mat4 model;
+    mat4 modelViewProjection;
+    mat3 normalMatrix;
+    vec4 highlightColor; // Hovered / selected: subtracted, since the lamp is already white
+    vec4 uvScale;
+};
+
+void main()
+{
+    fragmentColor = vec4(vec3(1.0f) - highlightColor.rgb, 1.0f); // Set color to white (1.0f,1.0f,1.0f) with alpha 1.0
+}
+);
+
+
+/* Indirect Vertex Shader Source Code: the cube shader with its object data read from the draw's
+ * DrawObject record (indirect_draw.h) */
+const GLchar* indirectVertexShaderSource = GLSL_DRAW_PARAMETERS(440,
+
+    layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 textureCoordinate;
+
+out vec3 vertexNormal;
+out vec3 vertexFragmentPos;
+out vec2 vertexTextureCoordinate;
+flat out uvec2 vertexMaterial;
+flat out vec3 vertexHighlight;
+
+invariant gl_Position;
+
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+    vec4 lightPosition;
+    vec4 lightColor;
+};
+struct DrawObject
+{
+    mat4 model;
+    mat4 modelViewProjection;
+    mat3 normalMatrix;
+    vec4 highlightColor;
+    vec4 uvScale;
+    uvec4 material;
+};
+layout(std430, binding = 2) readonly buffer DrawObjects
+{
+    DrawObject objects[];
+};
+
+void main()
+{
+    DrawObject object = objects[gl_BaseInstanceARB];
+    gl_Position = object.modelViewProjection * vec4(position, 1.0f);
+    vertexFragmentPos = vec3(object.model * vec4(position, 1.0f));
+    vertexNormal = object.normalMatrix * normal;
+    vertexTextureCoordinate = textureCoordinate * object.uvScale.xy;
+    vertexMaterial = object.material.xy;
+    vertexHighlight = object.highlightColor.rgb;
+}
+);
+
+
+/* Instance Vertex Shader Source Code: the indirect vertex shader with the object data read from the
+ * instance's record (instancing.h); shares indirectFragmentShaderSource */
+const GLchar* instanceVertexShaderSource = GLSL(440,
+
+    layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 textureCoordinate;
+
+out vec3 vertexNormal;
+out vec3 vertexFragmentPos;
+out vec2 vertexTextureCoordinate;
+flat out uvec2 vertexMaterial;
+flat out vec3 vertexHighlight;
+
+invariant gl_Position;
+
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+    vec4 lightPosition;
+    vec4 lightColor;
+};
+struct Instance
+{
+    mat4 model;
+    mat3 normalMatrix;
+    uvec4 material;
+};
+layout(std430, binding = 3) readonly buffer Instances
+{
+    Instance instances[];
+};
+uniform uint uFirstInstance;
+
+void main()
+{
+    Instance instance = instances[uFirstInstance + uint(gl_InstanceID)];
+    vertexFragmentPos = vec3(instance.model * vec4(position, 1.0f));
+    gl_Position = viewProjection * vec4(vertexFragmentPos, 1.0f);
+    vertexNormal = instance.normalMatrix * normal;
+    vertexTextureCoordinate = textureCoordinate;
+    vertexMaterial = instance.material.xy;
+    vertexHighlight = vec3(0.0f);
+}
+);
+
+
+/* Indirect Fragment Shader Source Code: the cube's Phong shading with the texture taken from the
+ * draw's layer (material.x) of one of the packed arrays (material.y), each bound to its own unit */
+const GLchar* indirectFragmentShaderSource = GLSL(440,
+
+    in vec3 vertexNormal;
+in vec3 vertexFragmentPos;
+in vec2 vertexTextureCoordinate;
+flat in uvec2 vertexMaterial;
+flat in vec3 vertexHighlight;
+
+out vec4 fragmentColor;
+
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+    vec4 lightPosition;
+    vec4 lightColor;
+};
+uniform sampler2DArray uTextures[4];
+
+void main()
+{
+    vec3 ambient = 0.1f * lightColor.rgb;
+
+    vec3 norm = normalize(vertexNormal);
+    vec3 lightDirection = normalize(lightPosition.xyz - vertexFragmentPos);
+    vec3 diffuse = max(dot(norm, lightDirection), 0.0) * lightColor.rgb;
+
+    vec3 viewDir = normalize(viewPosition.xyz - vertexFragmentPos);
+    vec3 reflectDir = reflect(-lightDirection, norm);
+    vec3 specular = 0.8f * pow(max(dot(viewDir, reflectDir), 0.0), 16.0f) * lightColor.rgb;
+
+    vec4 textureColor = texture(uTextures[vertexMaterial.y], vec3(vertexTextureCoordinate, float(vertexMaterial.x)));
+    fragmentColor = vec4((ambient + diffuse + specular) * textureColor.xyz + vertexHighlight, 1.0);
+}
+);
+
+
+/* Depth Pre-pass Shader Source Code: position-only vertex shaders for the three object data
+ * sources, with the same clip position expression as their shading counterparts. gl_Position is
+ * invariant in all of them, so the shading pass's GL_EQUAL test matches the depth laid down here. */
+const GLchar* depthVertexShaderSource = GLSL(440,
+
+    layout(location = 0) in vec3 position;
+
+invariant gl_Position;
+
+layout(std140, binding = 1) uniform ObjectData
+{
+    mat4 model;
+    mat4 modelViewProjection;
+    mat3 normalMatrix;
+    vec4 highlightColor;
+    vec4 uvScale;
+};
+
+void main()
+{
+    gl_Position = modelViewProjection * vec4(position, 1.0f);
+}
+);
+
+
+const GLchar* depthIndirectVertexShaderSource = GLSL_DRAW_PARAMETERS(440,
+
+    layout(location = 0) in vec3 position;
+
+invariant gl_Position;
+
+struct DrawObject
+{
+    mat4 model;
+    mat4 modelViewProjection;
+    mat3 normalMatrix;
+    vec4 highlightColor;
+    vec4 uvScale;
+    uvec4 material;
+};
+layout(std430, binding = 2) readonly buffer DrawObjects
+{
+    DrawObject objects[];
+};
+
+void main()
+{
+    DrawObject object = objects[gl_BaseInstanceARB];
+    gl_Position = object.modelViewProjection * vec4(position, 1.0f);
+}
+);
+
+
+const GLchar* depthInstanceVertexShaderSource = GLSL(440,
+
+    layout(location = 0) in vec3 position;
+
+invariant gl_Position;
+
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+    vec4 lightPosition;
+    vec4 lightColor;
+};
+struct Instance
+{
+    mat4 model;
+    mat3 normalMatrix;
+    uvec4 material;
+};
+layout(std430, binding = 3) readonly buffer Instances
+{
+    Instance instances[];
+};
+uniform uint uFirstInstance;
+
+void main()
+{
+    Instance instance = instances[uFirstInstance + uint(gl_InstanceID)];
+    vec3 worldPosition = vec3(instance.model * vec4(position, 1.0f));
+    gl_Position = viewProjection * vec4(worldPosition, 1.0f);
+}
+);
+
+
+/* Depth pre-pass fragments write nothing but depth */
+const GLchar* depthFragmentShaderSource = GLSL(440,
+
+    void main()
+{
+}
+);
+
+//camera
+glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
+glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+
+bool firstMouse = true;
+float yaw = -90.0f;
+float pitch = 0.0f;
+float lastX = 800.0f / 2.0;
+float lastY = 600.0 / 2.0;
+float fov = 45.0f;
+bool viewProjection = false;
+glm::mat4 projection;
+
+//timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+
+
+int main(int argc, char* argv[])
+{
+    UParseArguments(argc, argv);
+
+    if (!UInitialize(argc, argv, &gWindow))
+        return EXIT_FAILURE;
+
+
+    // Create the shader programs
+    if (!UCreateShaderProgram(cubeVertexShaderSource, cubeFragmentShaderSource, gCubeProgramId))
+        return EXIT_FAILURE;
+
+    if (!UCreateShaderProgram(lampVertexShaderSource, lampFragmentShaderSource, gLightProgramId))
+        return EXIT_FAILURE;
+    ULookupUniforms();
+    gFrameUniforms.create();
+    gObjectUniforms.create();
+    if (gBenchUniforms)
+        UBenchmarkUniforms();
+
+    // All scene meshes live in one vertex buffer and one index buffer behind a single VAO
+    gMeshes.setStateCache(&gGLState);
+    gMeshes.setPositionStreams(gPositionStreams);
+    gMeshes.create();
+
+    // Position and Color data
+    float plane[] = {
+        // Vertex Positions    // Colors (r,g,b,a)
+        //Plane
+        2.0f, -0.5f, 4.0f,    0.0f, 1.0f, 0.0f,     1.0f, 1.0f,
+        2.0f, -0.5f, -4.0f,   0.0f, 1.0f, 0.0f,     1.0f, 0.0f,
+        -2.0f, -0.5f, -4.0f,  0.0f, 1.0f, 0.0f,     0.0f, 0.0f,
+        -2.0f, -0.5f, 4.0f,   0.0f, 1.0f, 0.0f,     0.0f, 1.0f,
+        2.0f, -0.5f, 4.0f,    0.0f, 1.0f, 0.0f,     1.0f, 1.0f,
+        -2.0f, -0.5f, -4.0f,  0.0f, 1.0f, 0.0f,     0.0f, 0.0f,
+    };
+
+    gPlaneMesh = UCreateMesh(plane, sizeof(plane) / sizeof(plane[0]), "plane");
+
+
+    //coaster
+    // Position and Color data
+    float coaster[] = {
+        // Vertex Positions    // Colors (r,g,b,a)
+        //top
+        0.0f, -0.5f, 1.5f,      0.0f, 0.0f, -1.0f,       0.0f, 0.0f,
+        1.0f, -0.5f, 1.5f,      0.0f, 0.0f, -1.0f,       1.0f, 0.0f,
+        1.0f,  -0.45f, 1.5f,    0.0f, 0.0f, -1.0f,       1.0f, 1.0f,
+        1.0f,  -0.45f, 1.5f,    0.0f, 0.0f, -1.0f,       1.0f, 1.0f,
+        0.0f,  -0.45f, 1.5f,    0.0f, 0.0f, -1.0f,       0.0f, 1.0f,
+        0.0, -0.5f, 1.5f,       0.0f, 0.0f, -1.0f,       0.0f, 0.0f,
+
+        0.0f, -0.5f,  2.5f,     1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
+        1.0f, -0.5f,  2.5f,     1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
+        1.0f,  -0.45f,  2.5f,   1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
+        1.0f,  -0.45f,  2.5f,   1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
+        0.0f,  -0.45f,  2.5f,   1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
+        0.0f, -0.5f,  2.5f,     1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
+
+        0.0f,  -0.45f,  2.5f,   -1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
+        0.0f,  -0.45f, 1.5f,    -1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
+        0.0f, -0.5f, 1.5f,      -1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
+        0.0f, -0.5f, 1.5f,      -1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
+        0.0f, -0.5f,  2.5f,     -1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
+        0.0f,  -0.45f,  2.5f,   -1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
+
+        1.0f,  -0.45f,  2.5f,   0.0f, 0.0f, 1.0f,       1.0f, 0.0f,
+        1.0f,  -0.45f, 1.5f,    0.0f, 0.0f, 1.0f,       1.0f, 1.0f,
+        1.0f, -0.5f, 1.5f,      0.0f, 0.0f, 1.0f,       0.0f, 1.0f,
+        1.0f, -0.5f, 1.5f,      0.0f, 0.0f, 1.0f,       0.0f, 1.0f,
+        1.0f, -0.5f,  2.5f,     0.0f, 0.0f, 1.0f,       0.0f, 0.0f,
+        1.0f,  -0.45f,  2.5f,   0.0f, 0.0f, 1.0f,       1.0f, 0.0f,
+
+        0.0f, -0.5f, 1.5f,      0.0f, 1.0f, 0.0f,       0.0f, 1.0f,
+        1.0f, -0.5f, 1.5f,      0.0f, 1.0f, 0.0f,       1.0f, 1.0f,
+        1.0f, -0.5f,  2.5f,     0.0f, 1.0f, 0.0f,       1.0f, 0.0f,
+        1.0f, -0.5f,  2.5f,     0.0f, 1.0f, 0.0f,       1.0f, 0.0f,
+        0.0f, -0.5f,  2.5f,     0.0f, 1.0f, 0.0f,       0.0f, 0.0f,
+        0.0f, -0.5f, 1.5f,      0.0f, 1.0f, 0.0f,       0.0f, 1.0f,
+
+        0.0f,  -0.45f, 1.5f,    0.0f, -1.0f, 0.0f,       0.0f, 1.0f,
+        1.0f,  -0.45f, 1.5f,    0.0f, -1.0f, 0.0f,       1.0f, 1.0f,
+        1.0f,  -0.45f,  2.5f,   0.0f, -1.0f, 0.0f,       1.0f, 0.0f,
+        1.0f,  -0.45f,  2.5f,   0.0f, -1.0f, 0.0f,       1.0f, 0.0f,
+        0.0f,  -0.45f,  2.5f,   0.0f, -1.0f, 0.0f,       0.0f, 0.0f,
+        0.0f,  -0.45f, 1.5f,    0.0f, -1.0f, 0.0f,       0.0f, 1.0f
+
+    };
+
+
+    gCoasterMesh = UCreateMesh(coaster, sizeof(coaster) / sizeof(coaster[0]), "coaster");
+
+    GLfloat lamp[] = {
+        // Vertex Positions    
+        //first triangle
+         0.0f, 1.0f, 0.0f,   0.0f, 0.5f, 1.0f,   0.5f, 1.0f,
+         -0.5f, 0.0f, 0.5f,  0.0f, 0.5f, 1.0f,   0.0f, 0.0f,
+         0.5f, 0.0f, 0.5f,   0.0f, 0.5f, 1.0f,   1.0f, 0.0f,
+
+         //second triangle
+         0.0f, 1.0f, 0.0f,   1.0f, 0.5f, 0.0f,   0.5f, 1.0f,
+         -0.5, 0.0f, 0.5f,   1.0f, 0.5f, 0.0f,   0.0f, 0.0f,
+         -0.5, 0.0f, -0.5f,  1.0f, 0.5f, 0.0f,   1.0f, 0.0f,
+
+         //third triangle
+         0.0f, 1.0f, 0.0f,   0.0f, 0.5f, -1.0f,   0.5f, 1.0f,
+         -0.5f, 0.0f, -0.5f, 0.0f, 0.5f, -1.0f,   0.0f, 0.0f,
+         0.5f, 0.0f, -0.5f,  0.0f, 0.5f, -1.0f,   1.0f, 0.0f,
+
+         //fourth triangle
+         0.0f, 1.0f, 0.0f,   -1.0f, 0.5f, 0.0f,   0.5f, 1.0f,
+         0.5f, 0.0f, -0.5f,  -1.0f, 0.5f, 0.0f,   0.0f, 0.0f,
+         0.5f, 0.0f, 0.5f,   -1.0f, 0.5f, 0.0f,   1.0f, 0.0f,
+
+         //base
+         -0.5f, 0.0f, -0.5f,  0.0f, -1.0f, 0.0f,  0.0f, 0.0f,
+         0.5f, 0.0f, 0.5f,    0.0f, -1.0f, 0.0f,  1.0f, 1.0f,
+         -0.5f, 0.0f, 0.5f,   0.0f, -1.0f, 0.0f,  0.0f, 1.0f,
+         -0.5f, 0.0f, -0.5f,  0.0f, -1.0f, 0.0f,  0.0f, 0.0f,
+         0.5f, 0.0f, 0.5f,    0.0f, -1.0f, 0.0f,  1.0f, 1.0f,
+         0.5f, 0.0f, -0.5f,   0.0f, -1.0f, 0.0f,  1.0f, 0.0f,
+
+
+    };
+    gLampMesh = UCreateMesh(lamp, sizeof(lamp) / sizeof(lamp[0]), "lamp");
+
+    // Position and Color data
+    GLfloat stand[] = {
+        //top
+        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //1
+        -0.7f, 0.0f, 0.7f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+        0.0f, 0.0f, 1.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+
+        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //2
+        0.0f, 0.0f, 1.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+        0.7f, 0.0f, 0.7f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+
+        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //3
+        0.7f, 0.0f, 0.7f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+        1.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+
+        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //4
+        1.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+        0.7f, 0.0f, -0.7f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+
+        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //5
+        0.7f, 0.0f, -0.7f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+        0.0f, 0.0f, -1.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+
+        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //6
+        0.0f, 0.0f, -1.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+        -0.7f, 0.0f, -0.7f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+
+        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //7
+        -0.7f, 0.0f, -0.7f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+        -1.0f, 0.0f, 0.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+
+        0.0f, 0.0f, 0.0f,       0.0f, 1.0f, 0.0f,   0.0f, 1.0f, //8
+        -1.0f, 0.0f, 0.0f,      0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+        -0.7f, 0.0f, 0.7f,    0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+        
+        //base
+        -0.3f, -0.5f, -0.3f,      0.0f, 0.0f, -1.0f,       0.0f, 0.0f,
+        0.3f, -0.5f, -0.3f,      0.0f, 0.0f, -1.0f,       1.0f, 0.0f,
+        0.3f,  0.0f, -0.3f,    0.0f, 0.0f, -1.0f,       1.0f, 1.0f,
+        0.3f,  0.0f, -0.3f,    0.0f, 0.0f, -1.0f,       1.0f, 1.0f,
+        -0.3f,  0.0f, -0.3f,    0.0f, 0.0f, -1.0f,       0.0f, 1.0f,
+        -0.3,  -0.5f, -0.3f,       0.0f, 0.0f, -1.0f,       0.0f, 0.0f,
+
+        -0.3f, -0.5f,  0.3f,     1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
+        0.3f, -0.5f,  0.3f,     1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
+        0.3f,  0.0f,  0.3f,   1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
+        0.3f,  0.0f,  0.3f,   1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
+        -0.3f,  0.0f,  0.3f,   1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
+        -0.3f, -0.5f,  0.3f,     1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
+
+        -0.3f,  0.0f,  0.3f,   -1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
+        -0.3f,  0.0f, -0.3f,    -1.0f, 0.0f, 0.0f,       1.0f, 1.0f,
+        -0.3f, -0.5f, -0.3f,      -1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
+        -0.3f, -0.5f, -0.3f,      -1.0f, 0.0f, 0.0f,       0.0f, 1.0f,
+        -0.3f, -0.5f,  0.3f,     -1.0f, 0.0f, 0.0f,       0.0f, 0.0f,
+        -0.3f,  0.0f, 0.3f,   -1.0f, 0.0f, 0.0f,       1.0f, 0.0f,
+
+        0.3f,  0.0f,  0.3f,   0.0f, 0.0f, 1.0f,       1.0f, 0.0f,
+        0.3f,  0.f, -0.3f,    0.0f, 0.0f, 1.0f,       1.0f, 1.0f,
+        0.3f, -0.5f, -0.3f,      0.0f, 0.0f, 1.0f,       0.0f, 1.0f,
+        0.3f, -0.5f, -0.3f,      0.0f, 0.0f, 1.0f,       0.0f, 1.0f,
+        0.3f, -0.5f,  0.3f,     0.0f, 0.0f, 1.0f,       0.0f, 0.0f,
+        0.3f,  0.0f,  0.3f,   0.0f, 0.0f, 1.0f,       1.0f, 0.0f,
+
+        -0.3f, -0.5f, -0.3f,      0.0f, 1.0f, 0.0f,       0.0f, 1.0f,
+        0.3f, -0.5f, -0.3f,      0.0f, 1.0f, 0.0f,       1.0f, 1.0f,
+        0.3f, -0.5f,  0.3f,     0.0f, 1.0f, 0.0f,       1.0f, 0.0f,
+        0.3f, -0.5f,  0.3f,     0.0f, 1.0f, 0.0f,       1.0f, 0.0f,
+        -0.3f, -0.5f,  0.3f,     0.0f, 1.0f, 0.0f,       0.0f, 0.0f,
+        -0.3f, -0.5f, -0.3f,      0.0f, 1.0f, 0.0f,       0.0f, 1.0f,
+
+
+
+    };
+
+    gStandMesh = UCreateMesh(stand, sizeof(stand) / sizeof(stand[0]), "stand");
+
+    // Cup, candle and lid are generated procedurally as LOD chains
+    CylinderDesc cup = { glm::vec3(0.5f, -0.45f, 2.0f), 0.25f, 0.35f, 0.95f, 0, 1, true, true, 0.02f };
+    UCreateLodMesh(cup, "cup", gCupLods);
+
+    CylinderDesc candle = { glm::vec3(0.0f, 0.01f, 0.0f), 0.5f, 0.5f, 0.29f, 0, 1, true, false, 0.0f };
+    UCreateLodMesh(candle, "candle", gCandleLods);
+
+    CylinderDesc lid = { glm::vec3(0.0f, 0.3f, 0.0f), 0.5f, 0.5f, 0.1f, 0, 1, false, true, 0.0f };
+    UCreateLodMesh(lid, "lid", gLidLods);
+
+    for (const char* path : gMeshFilePaths)
+    {
+        LodMesh lod;
+        if (ULoadMeshFile(path, lod))
+            gFileMeshes.push_back(lod);
+    }
+
+    gMeshes.printStats();
+    UBuildScenePicking();
+
+    // Load texture
+    if (!UCreateTexture("textures/black.jpg", gTextureId))
+    {
+        cout << "Failed to load texture " << "textures/black.jpg" << endl;
+        return EXIT_FAILURE;
+    }
+    if (!UCreateTexture("textures/wood.jpg", gTextureId2))
+    {
+        cout << "Failed to load texture " << "textures/wood.jpg" << endl;
+        return EXIT_FAILURE;
+    }
+    if (!UCreateTexture("textures/matte_black.jpg", gTextureId3))
+    {
+        cout << "Failed to load texture " << "textures/wood.jpg" << endl;
+        return EXIT_FAILURE;
+    }
+    if (!UCreateTexture("textures/blue.jpg", gTextureId5))
+    {
+        cout << "Failed to load texture " << "textures/wood.jpg" << endl;
+        return EXIT_FAILURE;
+    }
+    if (!UCreateTexture("textures/candle.jpg", gTextureId6))
+    {
+        cout << "Failed to load texture " << "textures/wood.jpg" << endl;
+        return EXIT_FAILURE;
+    }
+    if (!UCreateTexture("textures/metal.jpg", gTextureId7))
+    {
+        cout << "Failed to load texture " << "textures/wood.jpg" << endl;
+        return EXIT_FAILURE;
+    }
+    UCreateIndirectPath();
+    UCreateInstancingPath();
+    UCreateDepthPrepass();
+    if (gBenchInstancing)
+        UBenchmarkInstancing();
+    if (gBenchTransforms)
+        UBenchmarkTransforms();
+    if (gStressCount > 0 && gInstanceProgramId)
+    {
+        UGenerateStressScene(gStressCount, gStressSeed, gStressInstances);
+        gStressInstances.upload();
+    }
+    if (gUseRing && !gRing.create())
+    {
+        cout << "WARNING: Dynamic ring unavailable, uploading with glBufferSubData as with --no-ring" << endl;
+        gRing.destroy();
+        gUseRing = false;
+    }
+    if (gUseRing)
+    {
+        gFrameUniforms.setRing(&gRing);
+        gObjectUniforms.setRing(&gRing);
+        gIndirectDraws.setRing(&gRing);
+    }
+
+    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
+    glUseProgram(gCubeProgramId);
+    // We set the texture as texture unit 0
+    USetUniform(gCubeTexture, 0);
+
+
+    // Sets the background color of the window to black (it will be implicitely used by glClear)
+    glClearColor(0.0f, 0.0f, 0.2f, 1.0f);
+
+    // Setup above binds programs and textures directly, so the cache starts from unknown state
+    gGLState.setDebug(gDebugState);
+    gGLState.invalidate();
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(gWindow))
+    {
+
+        //frame logic
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+
+        // input
+        // -----
+        UProcessInput(gWindow);
+
+        gGLState.enable(GL_DEPTH_TEST);
+        // The depth pre-pass leaves depth writes off and the test at GL_EQUAL; the clear needs writes
+        gGLState.depthMask(true);
+        gGLState.depthFunc(GL_LESS);
+
+        gGLState.clearColor(glm::vec4(0.2f, 0.3f, 0.3f, 1.0f));
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glm::mat4 scale = glm::mat4(1.0f);
+        //translate
+        glm::mat4 trans = glm::mat4(1.0f);
+        // Model matrix
+        glm::mat4 model = trans * scale;
+
+        //camera view
+        glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+
+        //function to tell wich projection to use based on key press
+        if (viewProjection == true) {
+            projection = glm::ortho(-5.0f, 5.0f, -5.0f, 5.0f, 0.1f, 100.0f);
+        }
+        else if (viewProjection == false) {
+            projection = glm::perspective(glm::radians(fov), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 100.0f);
+        }
+
+        // Screen-space error scale for LOD selection: the ortho view spans 10 units vertically
+        gLodPerspective = !viewProjection;
+        gLodPixelScale = viewProjection ? WINDOW_HEIGHT / 10.0f : WINDOW_HEIGHT / (2.0f * tan(glm::radians(fov) * 0.5f));
+
+        // World-space frustum used to cull objects and meshlets this frame
+        gFrustum = UExtractFrustum(projection * view);
+        // Object under the cursor, highlighted below
+        UPickCursor(view, projection);
+
+        // Everything written into the ring from here on belongs to this frame's region
+        if (gUseRing)
+            gRing.beginFrame();
+
+        // Camera and light data for every program, uploaded once
+        FrameData frame;
+        frame.view = view;
+        frame.projection = projection;
+        frame.viewProjection = projection * view;
+        frame.viewPosition = glm::vec4(cameraPos, 1.0f);
+        frame.lightPosition = glm::vec4(gLightPosition, 1.0f);
+        frame.lightColor = glm::vec4(gLightColor, 1.0f);
+        gFrameUniforms.update(frame);
+
+        // Collect the visible objects and their per-object data; objects outside the frustum are
+        // skipped before any texture bind or draw call
+        gSceneDraws.clear();
+        gRenderQueue.clear();
+        gIndirectDraws.clear();
+        gObjectUniforms.clear();
+        UQueueDraw(gPlaneMesh, model, gCubeProgramId, gTextureId, OBJECT_PLANE);
+        UQueueDraw(gCoasterMesh, model, gCubeProgramId, gTextureId2, OBJECT_COASTER);
+        UQueueDraw(gStandMesh, model, gCubeProgramId, gTextureId3, OBJECT_STAND);
+        UQueueDraw(USelectLod(gCupLods, cameraPos), model, gCubeProgramId, gTextureId5, OBJECT_CUP);
+        UQueueDraw(USelectLod(gCandleLods, cameraPos), model, gCubeProgramId, gTextureId6, OBJECT_CANDLE);
+        UQueueDraw(USelectLod(gLidLods, cameraPos), model, gCubeProgramId, gTextureId7, OBJECT_LID);
+        // Meshes loaded with --mesh
+        for (size_t i = 0; i < gFileMeshes.size(); ++i)
+            UQueueDraw(USelectLod(gFileMeshes[i], cameraPos), model, gCubeProgramId, gTextureId3, static_cast<GLuint>(OBJECT_FILE_MESHES + i));
+        // The smaller cube used as a visual que for the light source
+        UQueueDraw(gLampMesh, glm::translate(gLightPosition) * glm::scale(gLightScale), gLightProgramId, 0, OBJECT_LAMP);
+        gIndirectDraws.sortFrontToBack();
+
+        // Every record's MVP and normal matrix in one batch per buffer instead of once per vertex
+        double transformStart = glfwGetTime();
+        ObjectTransformStats objectTransforms = gObjectUniforms.computeTransforms(frame.viewProjection);
+        ObjectTransformStats indirectTransforms = gIndirectDraws.computeTransforms(frame.viewProjection);
+        gTransformTime += glfwGetTime() - transformStart;
+        gTransformStats.rigid += objectTransforms.rigid + indirectTransforms.rigid;
+        gTransformStats.general += objectTransforms.general + indirectTransforms.general;
+        gObjectUniforms.upload();
+        gIndirectDraws.upload();
+
+        // Draw in key order, binding only the program, texture and VAO that change between packets.
+        // Depth packets draw from the position streams and cull their meshlets again, which the
+        // stats have already counted.
+        gRenderQueue.sort();
+        auto emit = [](const RenderPacket& packet, unsigned changes)
+        {
+            const SceneDraw& draw = gSceneDraws[packet.item];
+            bool depthPass = URenderPassOf(packet.key) == RENDER_PASS_DEPTH;
+            VertexStream stream = depthPass ? VERTEX_STREAM_POSITION : VERTEX_STREAM_FULL;
+            if (changes & renderqueue::CHANGED_PROGRAM)
+                gGLState.useProgram(packet.state.program);
+            if (changes & renderqueue::CHANGED_TEXTURE)
+                gGLState.bindTexture(0, GL_TEXTURE_2D, packet.state.texture);
+            if (changes & renderqueue::CHANGED_VAO)
+                gMeshes.bind(gMeshes.mesh(draw.mesh).layout, stream);
+            gObjectUniforms.bind(draw.objectSlot);
+            MeshletCullStats counted = gMeshletStats;
+            UDrawMesh(draw.mesh, draw.model, stream);
+            if (depthPass)
+                gMeshletStats = counted;
+        };
+
+        // Depth pre-pass: every path's draws with color writes off, nearest first, after which
+        // only the nearest surface of each pixel passes the shading pass's GL_EQUAL test
+        bool prepass = gDepthPrepass && gDepthProgramId;
+        if (prepass)
+        {
+            gGLState.colorMask(false);
+            gRenderStats += gRenderQueue.submit(RENDER_PASS_DEPTH, emit);
+            if (gIndirectDraws.commandCount() > 0)
+            {
+                gGLState.useProgram(gDepthIndirectProgramId);
+                gIndirectDraws.draw(gMeshes, VERTEX_STREAM_POSITION);
+            }
+            if (gStressInstances.size() > 0)
+            {
+                gGLState.useProgram(gDepthInstanceProgramId);
+                gStressInstances.draw(gMeshes, gDepthFirstInstance, VERTEX_STREAM_POSITION);
+            }
+            gGLState.colorMask(true);
+            gGLState.depthMask(false);
+            gGLState.depthFunc(GL_EQUAL);
+        }
+
+        UBeginFragmentQuery(prepass);
+        gRenderStats += gRenderQueue.submit(RENDER_PASS_OPAQUE, emit);
+
+        // Cube program objects: one multi-draw call per vertex layout; the texture arrays stay bound
+        if (gIndirectDraws.commandCount() > 0)
+        {
+            gGLState.useProgram(gIndirectProgramId);
+            gSceneTextureArrays.bind(gGLState);
+            gIndirectCalls += gIndirectDraws.draw(gMeshes);
+            gIndirectCommands += gIndirectDraws.commandCount();
+        }
+
+        // Stress scene: one instanced call per mesh
+        if (gStressInstances.size() > 0)
+        {
+            gGLState.useProgram(gInstanceProgramId);
+            gSceneTextureArrays.bind(gGLState);
+            gInstanceCalls += gStressInstances.draw(gMeshes, gFirstInstance);
+        }
+        UEndFragmentQuery();
+        // The VAO stays bound into the next frame, whose first draw usually needs it again
+
+        // Fences the region after the last draw that reads it
+        if (gUseRing)
+        {
+            gRing.endFrame();
+            RingStats ringStats = gRing.takeStats();
+            gRingStats.waitSeconds += ringStats.waitSeconds;
+            gRingStats.waits += ringStats.waits;
+            gRingStats.bytes += ringStats.bytes;
+        }
+
+        GLStateStats stateStats = gGLState.takeStats();
+        gGLStateStats.issued += stateStats.issued;
+        gGLStateStats.skipped += stateStats.skipped;
+        if (gDebugState)
+            gGLState.verify();
+
+        UReportFrameStats();
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        glfwSwapBuffers(gWindow);    // Flips the the back buffer with the front buffer every frame.
+
+        glfwPollEvents();
+    }
+
+    // Release mesh data
+    gMeshes.destroy();
+    gObjectUniforms.destroy();
+    gFrameUniforms.destroy();
+    gIndirectDraws.destroy();
+    gStressInstances.destroy();
+    gSceneTextureArrays.destroy();
+    gFrameUniforms.setRing(nullptr);
+    gObjectUniforms.setRing(nullptr);
+    gIndirectDraws.setRing(nullptr);
+    gRing.destroy();
+
+    //destroy textures used
+    UDestroyTexture(gTextureId);
+    UDestroyTexture(gTextureId2);
+    UDestroyTexture(gTextureId3);
+    UDestroyTexture(gTextureId5);
+    UDestroyTexture(gTextureId6);
+    UDestroyTexture(gTextureId7);
+
+    // Release shader program
+    UDestroyShaderProgram(gCubeProgramId);
+    if (gIndirectProgramId)
+        UDestroyShaderProgram(gIndirectProgramId);
+    if (gInstanceProgramId)
+        UDestroyShaderProgram(gInstanceProgramId);
+    if (gDepthProgramId)
+        UDestroyShaderProgram(gDepthProgramId);
+    if (gDepthIndirectProgramId)
+        UDestroyShaderProgram(gDepthIndirectProgramId);
+    if (gDepthInstanceProgramId)
+        UDestroyShaderProgram(gDepthInstanceProgramId);
+    if (gFragmentQueries[0])
+        glDeleteQueries(RING_FRAMES, gFragmentQueries);
+
+    exit(EXIT_SUCCESS); // Terminates the program successfully
+}
+
+
+// Reads the command line options
+void UParseArguments(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--validate-packing") == 0)
+            gMeshes.setValidatePacking(true);   // Print packed vertex error against the float path
+        else if (strcmp(argv[i], "--float-vertices") == 0)
+            gLodLayout = VERTEX_LAYOUT_FLOAT;   // Store generated meshes as 32-byte float vertices
+        else if (strcmp(argv[i], "--stats") == 0)
+            gShowStats = true;                  // Print per-frame counters once a second
+        else if (strcmp(argv[i], "--mesh") == 0 && i + 1 < argc)
+            gMeshFilePaths.push_back(argv[++i]); // Load a .mesh, .obj, .gltf or .glb file into the scene
+        else if (strcmp(argv[i], "--bench-uniforms") == 0)
+            gBenchUniforms = true;              // Time uniform updates by name against cached handles
+        else if (strcmp(argv[i], "--normals") == 0 && i + 1 < argc)
+            gImportCreaseAngle = static_cast<float>(atof(argv[++i])); // Regenerate imported normals with this crease angle
+        else if (strcmp(argv[i], "--debug-state") == 0)
+            gDebugState = true;                 // Check the cached GL state against glGet* for desyncs
+        else if (strcmp(argv[i], "--no-indirect") == 0)
+            gIndirect = false;                  // Draw every object through the render queue
+        else if (strcmp(argv[i], "--stress") == 0 && i + 1 < argc)
+            gStressCount = strtoul(argv[++i], nullptr, 10); // Add this many instanced objects
+        else if (strcmp(argv[i], "--stress-seed") == 0 && i + 1 < argc)
+            gStressSeed = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10)); // Seed of the stress scene's transforms
+        else if (strcmp(argv[i], "--bench-instancing") == 0)
+            gBenchInstancing = true;            // Time instanced against per-object draws of the stress scene
+        else if (strcmp(argv[i], "--bench-transforms") == 0)
+            gBenchTransforms = true;            // Time per-vertex against precomputed object matrices on the GPU
+        else if (strcmp(argv[i], "--no-ring") == 0)
+            gUseRing = false;                   // Upload per-frame data with glBufferSubData instead of the ring
+        else if (strcmp(argv[i], "--depth-prepass") == 0)
+            gDepthPrepass = true;               // Start with the depth pre-pass on (Z toggles it)
+        else if (strcmp(argv[i], "--no-position-streams") == 0)
+            gPositionStreams = false;           // Draw the depth pre-pass from the interleaved vertices
+        else
+            cout << "WARNING: Unknown option " << argv[i] << endl;
+    }
+}
+
+
+// Initialize GLFW, GLEW, and create a window
+bool UInitialize(int argc, char* argv[], GLFWwindow** window)
+{
+    // GLFW: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // GLFW: window creation
+    // ---------------------
+    * window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE, NULL, NULL);
+    if (*window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(*window);
+    glfwSetFramebufferSizeCallback(*window, UResizeWindow);
+    glfwSetCursorPosCallback(*window, mouse_callback);
+    glfwSetScrollCallback(*window, scroll_callback);
+    glfwSetMouseButtonCallback(*window, mouse_button_callback);
+
+    //mouse capture
+    glfwSetInputMode(*window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // GLEW: initialize
+    // ----------------
+    // Note: if using GLEW version 1.13 or earlier
+    glewExperimental = GL_TRUE;
+    GLenum GlewInitResult = glewInit();
+
+    if (GLEW_OK != GlewInitResult)
+    {
+        std::cerr << glewGetErrorString(GlewInitResult) << std::endl;
+        return false;
+    }
+
+    // Displays GPU OpenGL version
+    cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << endl;
+
+    return true;
+}
+
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+void UProcessInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    float cameraSpeed = static_cast<float>(2.5 * deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        cameraPos += cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        cameraPos -= cameraSpeed * cameraFront;
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+        cameraPos += cameraUp * cameraSpeed;
+    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+        cameraPos -= cameraUp * cameraSpeed;
+    // Tab frees the cursor for picking, or captures it again for mouse look
+    bool tabDown = glfwGetKey(window, GLFW_KEY_TAB) == GLFW_PRESS;
+    if (tabDown && !gTabWasDown)
+    {
+        gPointerMode = !gPointerMode;
+        glfwSetInputMode(window, GLFW_CURSOR, gPointerMode ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
+        firstMouse = true;
+    }
+    gTabWasDown = tabDown;
+    // Z switches the depth pre-pass on and off
+    bool depthKeyDown = glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS;
+    if (depthKeyDown && !gDepthKeyWasDown && gDepthProgramId)
+    {
+        gDepthPrepass = !gDepthPrepass;
+        cout << "INFO: Depth pre-pass " << (gDepthPrepass ? "on" : "off") << endl;
+    }
+    gDepthKeyWasDown = depthKeyDown;
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
+        if (viewProjection == true) {
+            viewProjection = false;            
+        }
+        else if (viewProjection == false) {
+            viewProjection = true;
+        }
+
+}
+
+
+// Welds a triangle soup of position / normal / uv floats and adds it to the shared mesh arena
+GLuint UCreateMesh(const GLfloat* verts, size_t floatCount, const char* name)
+{
+    const GLuint floatsPerVertex = 3;
+    const GLuint floatsPerNormal = 3;
+    const GLuint floatsPerUV = 2;
+
+    MeshData data;
+    size_t soupVertices = floatCount / (floatsPerVertex + floatsPerNormal + floatsPerUV);
+    UWeldMesh(verts, soupVertices, data);
+    // The authored normals and winding are not consistent across these arrays, so rebuild both
+    UGenerateNormals(data, NORMAL_CREASE_ANGLE, true);
+    UPrintMeshStats(name, soupVertices, data);
+    UOptimizeMesh(data, name);
+
+    GLuint handle = gMeshes.add(data);
+    UAddPickMesh(handle, data);
+    return handle;
+}
+
+
+// Generates every LOD level of a cylinder and adds them to the shared mesh arena
+void UCreateLodMesh(const CylinderDesc& desc, const char* name, LodMesh& lod)
+{
+    std::vector<int> segments(LOD_SEGMENTS, LOD_SEGMENTS + sizeof(LOD_SEGMENTS) / sizeof(LOD_SEGMENTS[0]));
+    std::vector<MeshData> levels = UGenerateCylinderLods(desc, segments);
+
+    lod.levels.clear();
+    lod.errors.clear();
+    lod.center = desc.base + glm::vec3(0.0f, desc.height * 0.5f, 0.0f);
+    lod.name = name;
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        lod.errors.push_back(UCylinderChordError(desc, segments[i]) - UCylinderChordError(desc, segments[0]));
+        std::string levelName = std::string(name) + " LOD " + std::to_string(i);
+        cout << "INFO: Mesh " << levelName << ": " << segments[i] << " segments, "
+            << levels[i].vertices.size() << " vertices, " << levels[i].indices.size() / 3 << " triangles" << endl;
+        UOptimizeMesh(levels[i], levelName.c_str());
+        bool clustered = levels[i].indices.size() / 3 >= MESHLET_MIN_TRIANGLES;
+        lod.levels.push_back(gMeshes.add(levels[i], gLodLayout, clustered));
+    }
+    // Picking traces the finest level whichever one is drawn
+    UAddPickMesh(lod.levels[0], levels[0]);
+}
+
+
+// Maps a .mesh file and uploads its blobs into the shared mesh arena without converting them.
+// Other formats go through the importer and the index optimizer first.
+bool ULoadMeshFile(const char* path, LodMesh& lod)
+{
+    double start = glfwGetTime();
+    if (!meshimport::hasExtension(path, ".mesh"))
+    {
+        MeshData data;
+        if (!UImportMesh(path, data))
+            return false;
+        cout << "INFO: Imported " << path << ": " << data.vertices.size() << " vertices, " << data.indices.size() / 3
+            << " triangles in " << (glfwGetTime() - start) * 1000.0 << " ms" << endl;
+        if (gImportCreaseAngle >= 0.0f)
+        {
+            double normalsStart = glfwGetTime();
+            UGenerateNormals(data, gImportCreaseAngle);
+            cout << "INFO: Generated normals for " << path << " at " << gImportCreaseAngle << " degrees: "
+                << data.vertices.size() << " vertices in " << (glfwGetTime() - normalsStart) * 1000.0 << " ms" << endl;
+        }
+        UOptimizeMesh(data, path);
+
+        // Detailed meshes get a simplified LOD chain; small ones are drawn as they are
+        std::vector<MeshData> levels(1, data);
+        lod.errors.assign(1, 0.0f);
+        if (data.indices.size() / 3 >= LOD_MIN_TRIANGLES)
+        {
+            double simplifyStart = glfwGetTime();
+            UGenerateLods(data, LOD_RATIOS, levels, lod.errors);
+            cout << "INFO: Simplified " << path << " into " << levels.size() - 1 << " LOD(s) in "
+                << (glfwGetTime() - simplifyStart) * 1000.0 << " ms" << endl;
+        }
+
+        lod.levels.clear();
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            if (i > 0)
+            {
+                cout << "INFO: Mesh " << path << " LOD " << i << ": " << levels[i].vertices.size() << " vertices, "
+                    << levels[i].indices.size() / 3 << " triangles, error " << lod.errors[i] << endl;
+                std::string levelName = std::string(path) + " LOD " + std::to_string(i);
+                UOptimizeMesh(levels[i], levelName.c_str());
+            }
+            lod.levels.push_back(gMeshes.add(levels[i], gLodLayout, levels[i].indices.size() / 3 >= MESHLET_MIN_TRIANGLES));
+        }
+        lod.center = gMeshes.mesh(lod.levels[0]).bounds.center;
+        lod.name = path;
+        UAddPickMesh(lod.levels[0], data);
+        return true;
+    }
+
+    MeshFile file;
+    if (!file.open(path))
+        return false;
+
+    const MeshFileHeader& header = file.info();
+    const unsigned char* vertices = static_cast<const unsigned char*>(file.vertexData());
+    const unsigned char* indices = static_cast<const unsigned char*>(file.indexData());
+    size_t indexSize = UIndexSize(header.indexType);
+    VertexLayout layout = static_cast<VertexLayout>(header.vertexLayout);
+
+    lod.levels.clear();
+    lod.errors.clear();
+    lod.center = glm::vec3(header.sphere[0], header.sphere[1], header.sphere[2]);
+    lod.name = path;
+    for (uint32_t i = 0; i < header.lodCount; ++i)
+    {
+        const MeshFileLod& level = file.lod(i);
+        lod.errors.push_back(level.error);
+        lod.levels.push_back(gMeshes.addRaw(layout, vertices + size_t(level.baseVertex) * header.vertexStride, level.vertexCount,
+            indices + size_t(level.firstIndex) * indexSize, level.indexCount, header.indexType, file.quantization(), file.bounds()));
+    }
+
+    // Picking needs the finest level's positions on the CPU, decoded from the mapped blobs
+    if (header.lodCount > 0)
+    {
+        const MeshFileLod& finest = file.lod(0);
+        MeshData pickData;
+        pickData.vertices.resize(finest.vertexCount);
+        for (uint32_t v = 0; v < finest.vertexCount; ++v)
+        {
+            const unsigned char* src = vertices + size_t(finest.baseVertex + v) * header.vertexStride;
+            if (layout == VERTEX_LAYOUT_PACKED)
+                pickData.vertices[v] = UUnpackVertex(*reinterpret_cast<const PackedVertex*>(src), file.quantization());
+            else
+                pickData.vertices[v] = *reinterpret_cast<const Vertex*>(src);
+        }
+        pickData.indices.resize(finest.indexCount);
+        const unsigned char* levelIndices = indices + size_t(finest.firstIndex) * indexSize;
+        for (uint32_t k = 0; k < finest.indexCount; ++k)
+            pickData.indices[k] = header.indexType == GL_UNSIGNED_SHORT ? reinterpret_cast<const GLushort*>(levelIndices)[k]
+                : reinterpret_cast<const GLuint*>(levelIndices)[k];
+        UAddPickMesh(lod.levels[0], pickData);
+    }
+
+    cout << "INFO: Loaded " << path << ": " << header.vertexCount << " vertices, " << header.indexCount / 3 << " triangles, "
+        << header.lodCount << " LOD(s) in " << (glfwGetTime() - start) * 1000.0 << " ms" << endl;
+    return !lod.levels.empty();
+}
+
+
+// Builds the triangle BVH picking traces for a registry mesh
+void UAddPickMesh(GLuint handle, const MeshData& data)
+{
+    if (gPickMeshes.size() <= handle)
+        gPickMeshes.resize(handle + 1);
+    gPickMeshes[handle].build(data);
+}
+
+
+// Places every drawn object in the scene BVH, in SceneObjectId order, with the model matrix it is drawn with
+void UBuildScenePicking()
+{
+    double start = glfwGetTime();
+    const glm::mat4 identity(1.0f);
+    struct Placement
+    {
+        const char* name;
+        GLuint mesh;
+        glm::mat4 model;
+    };
+    std::vector<Placement> placements = {
+        { "plane", gPlaneMesh, identity },
+        { "coaster", gCoasterMesh, identity },
+        { "stand", gStandMesh, identity },
+        { gCupLods.name, gCupLods.levels[0], identity },
+        { gCandleLods.name, gCandleLods.levels[0], identity },
+        { gLidLods.name, gLidLods.levels[0], identity },
+        { "lamp", gLampMesh, glm::translate(gLightPosition) * glm::scale(gLightScale) },
+    };
+    for (const LodMesh& lod : gFileMeshes)
+        placements.push_back({ lod.name, lod.levels[0], identity });
+
+    size_t triangles = 0;
+    for (const Placement& placement : placements)
+    {
+        UAddPickObject(gSceneBvh, gPickObjects, &gPickMeshes[placement.mesh], placement.model);
+        gObjectNames.push_back(placement.name);
+        triangles += gPickMeshes[placement.mesh].triangleCount();
+    }
+    gSceneBvh.rebuild();
+
+    cout << "INFO: Picking " << placements.size() << " objects, " << triangles << " triangles; BVHs built in "
+        << (glfwGetTime() - start) * 1000.0 << " ms" << endl;
+}
+
+
+// Traces the cursor into the scene: the free cursor with Tab, otherwise the screen center mouse look aims with
+void UPickCursor(const glm::mat4& view, const glm::mat4& projection)
+{
+    double start = glfwGetTime();
+    int width, height;
+    glfwGetWindowSize(gWindow, &width, &height);
+    gHover.object = UINT32_MAX;
+    if (width == 0 || height == 0)
+        return;
+
+    double x = gPointerMode ? lastX : width * 0.5;
+    double y = gPointerMode ? lastY : height * 0.5;
+    glm::vec3 origin, direction;
+    UCursorRay(x, y, width, height, view, projection, origin, direction);
+    UPickRay(gSceneBvh, gPickObjects, origin, direction, gHover);
+    gPickTime += glfwGetTime() - start;
+}
+
+
+// Tint of an object: the selection color, else the hover color, else none
+glm::vec3 UHighlightColor(GLuint object)
+{
+    if (object == gSelection.object)
+        return SELECTION_COLOR;
+    if (object == gHover.object)
+        return HOVER_COLOR;
+    return glm::vec3(0.0f);
+}
+
+
+// Picks the coarsest LOD level whose geometric error, projected at the object's distance from the
+// camera, stays within LOD_PIXEL_ERROR pixels
+GLuint USelectLod(const LodMesh& lod, const glm::vec3& eye)
+{
+    float pixelsPerUnit = gLodPerspective ? gLodPixelScale / std::max(glm::length(eye - lod.center), 0.001f) : gLodPixelScale;
+    size_t level = 0;
+    while (level + 1 < lod.levels.size() && level + 1 < lod.errors.size() && lod.errors[level + 1] * pixelsPerUnit <= LOD_PIXEL_ERROR)
+        ++level;
+    gLodTriangles += gMeshes.mesh(lod.levels[level]).nIndices / 3;
+    gLodFullTriangles += gMeshes.mesh(lod.levels[0]).nIndices / 3;
+    return lod.levels[level];
+}
+
+
+// Frustum-tests a registered mesh's bounds placed by model and counts the result
+bool UIsVisible(GLuint handle, const glm::mat4& model)
+{
+    const MeshBounds& bounds = gMeshes.mesh(handle).bounds;
+    bool visible = UFrustumContainsObject(gFrustum, model, bounds.min, bounds.max, bounds.center, bounds.radius);
+    if (visible)
+        ++gObjectStats.visible;
+    else
+        ++gObjectStats.culled;
+    return visible;
+}
+
+
+// Adds a registered mesh to the frame's draws if it is in the frustum, staging its object data
+// with the position dequantization folded into the model matrix
+void UQueueDraw(GLuint handle, const glm::mat4& model, GLuint program, GLuint texture, GLuint object)
+{
+    if (!UIsVisible(handle, model))
+        return;
+
+    // View depth of the bounds' center orders draws front to back
+    const GLMesh& mesh = gMeshes.mesh(handle);
+    glm::vec3 center(model * glm::vec4(mesh.bounds.center, 1.0f));
+    float viewDepth = glm::dot(center - cameraPos, cameraFront);
+
+    // Cube program draws become indirect commands, sorted front to back within their batch
+    if (gIndirect && program == gCubeProgramId)
+    {
+        DrawObject record;
+        record.model = model * gMeshes.dequantize(handle);
+        record.highlightColor = glm::vec4(UHighlightColor(object), 0.0f);
+        record.uvScale = glm::vec4(gUVScale, 0.0f, 0.0f);
+        TextureSlot slot = UTextureSlot(texture);
+        record.material[0] = slot.layer;
+        record.material[1] = slot.array;
+        record.material[2] = record.material[3] = 0;
+        if (mesh.nMeshlets == 0)
+            gIndirectDraws.add(gMeshes, handle, record, viewDepth);
+        else
+            gIndirectDraws.addMeshlets(gMeshes, handle, UVisibleMeshlets(handle, model), record, viewDepth);
+        return;
+    }
+
+    ObjectData data;
+    data.model = model * gMeshes.dequantize(handle);
+    data.highlightColor = glm::vec4(UHighlightColor(object), 0.0f);
+    data.uvScale = glm::vec4(gUVScale, 0.0f, 0.0f);
+    SceneDraw draw = { handle, program, texture, gObjectUniforms.push(data), model };
+
+    // Sorted by program, texture and VAO, then front to back; the pre-pass's packet of the same
+    // draw shares one program and no texture, so depth is laid down by VAO and then nearest first
+    RenderState state = { program, texture, gMeshes.vertexArray(mesh.layout) };
+    uint32_t depth = URenderDepth(viewDepth / RENDER_DEPTH_RANGE);
+    uint32_t item = static_cast<uint32_t>(gSceneDraws.size());
+    gRenderQueue.push(URenderKey(RENDER_PASS_OPAQUE, state.program, state.texture, state.vao, depth), state, item);
+    if (gDepthPrepass && gDepthProgramId)
+    {
+        RenderState depthState = { gDepthProgramId, 0, gMeshes.vertexArray(mesh.layout, VERTEX_STREAM_POSITION) };
+        gRenderQueue.push(URenderKey(RENDER_PASS_DEPTH, depthState.program, 0, depthState.vao, depth), depthState, item);
+    }
+    gSceneDraws.push_back(draw);
+}
+
+
+// Draws a registered mesh whose object data is bound; clustered meshes are culled per meshlet first
+void UDrawMesh(GLuint handle, const glm::mat4& model, VertexStream stream)
+{
+    const GLMesh& mesh = gMeshes.mesh(handle);
+    if (mesh.nMeshlets == 0)
+    {
+        gMeshes.draw(handle, stream);
+        return;
+    }
+
+    // Clustered mesh: submit the meshlets that survive culling in one call
+    gMeshes.drawMeshlets(handle, UVisibleMeshlets(handle, model), stream);
+}
+
+
+// Rejects whole meshlets of a clustered mesh on the CPU and returns the rest. Meshlet bounds are in
+// mesh space, so they are culled with the unquantized model matrix.
+const std::vector<GLuint>& UVisibleMeshlets(GLuint handle, const glm::mat4& model)
+{
+    const GLMesh& mesh = gMeshes.mesh(handle);
+    glm::vec3 viewDirection = viewProjection ? cameraFront : glm::vec3(0.0f);
+    gVisibleMeshlets.clear();
+    UCullMeshlets(gMeshes.allMeshlets(), mesh.firstMeshlet, mesh.nMeshlets, model, gFrustum,
+        cameraPos, viewDirection, gVisibleMeshlets, gMeshletStats);
+    return gVisibleMeshlets;
+}
+
+
+// Prints the per-frame counters averaged over the last second, then resets them
+void UReportFrameStats()
+{
+    ++gStatsFrames;
+    gStatsTimer += deltaTime;
+    if (gStatsTimer < 1.0f)
+        return;
+
+    if (gShowStats)
+    {
+        cout << "STATS: " << gStatsFrames << " fps, objects per frame: "
+            << gObjectStats.visible / gStatsFrames << " visible, "
+            << gObjectStats.culled / gStatsFrames << " culled; meshlets per frame: "
+            << gMeshletStats.clusters / gStatsFrames << " clusters, "
+            << gMeshletStats.frustumCulled / gStatsFrames << " frustum culled, "
+            << gMeshletStats.backfaceCulled / gStatsFrames << " backface culled, "
+            << gMeshletStats.trianglesCulled / gStatsFrames << "/" << gMeshletStats.triangles / gStatsFrames << " triangles culled; LOD "
+            << gLodTriangles / gStatsFrames << "/" << gLodFullTriangles / gStatsFrames << " triangles; pick "
+            << gPickTime * 1000000.0 / gStatsFrames << " us; binds per frame: "
+            << gRenderStats.programBinds / gStatsFrames << " programs, "
+            << gRenderStats.textureBinds / gStatsFrames << " textures, "
+            << gRenderStats.vaoBinds / gStatsFrames << " VAOs for "
+            << gRenderStats.packets / gStatsFrames << " draws; indirect "
+            << gIndirectCommands / gStatsFrames << " commands in "
+            << gIndirectCalls / gStatsFrames << " calls; " << gStressInstances.size() << " instances in "
+            << gInstanceCalls / gStatsFrames << " calls; GL state calls per frame: "
+            << gGLStateStats.issued / gStatsFrames << " issued, "
+            << gGLStateStats.skipped / gStatsFrames << " skipped; transforms "
+            << gTransformStats.rigid / gStatsFrames << " rigid, "
+            << gTransformStats.general / gStatsFrames << " general in "
+            << gTransformTime * 1000000.0 / gStatsFrames << " us; ring "
+            << gRingStats.bytes / 1024.0 / gStatsFrames << " KB, fence wait "
+            << gRingStats.waitSeconds * 1000000.0 / gStatsFrames << " us per frame, "
+            << gRingStats.waits << " stalled frame(s)";
+        for (int mode = 0; mode < 2; ++mode)
+            if (gFragmentFrames[mode] > 0)
+                cout << "; fragment shader invocations per frame " << (mode ? "with" : "without") << " depth pre-pass: "
+                    << gFragmentInvocations[mode] / gFragmentFrames[mode];
+        cout << endl;
+    }
+
+    gMeshletStats = MeshletCullStats();
+    gObjectStats = ObjectCullStats();
+    gPickTime = 0.0;
+    gRenderStats = RenderBindStats();
+    gGLStateStats = GLStateStats();
+    gRingStats = RingStats();
+    gTransformStats = ObjectTransformStats();
+    gTransformTime = 0.0;
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        gFragmentInvocations[mode] = 0;
+        gFragmentFrames[mode] = 0;
+    }
+    gIndirectCommands = 0;
+    gIndirectCalls = 0;
+    gInstanceCalls = 0;
+    gLodTriangles = 0;
+    gLodFullTriangles = 0;
+    gStatsTimer = 0.0f;
+    gStatsFrames = 0;
+}
+
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+void UResizeWindow(GLFWwindow* window, int width, int height)
+{
+    glViewport(0, 0, width, height);
+}
+
+
+/*Generate and load the texture*/
+bool UCreateTexture(const char* filename, GLuint& textureId)
+{
+    int width, height, channels;
+    unsigned char* image = stbi_load(filename, &width, &height, &channels, 0);
+    if (image)
+    {
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+
+        // set the texture wrapping parameters
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        // set texture filtering parameters
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        if (channels == 3)
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+        else if (channels == 4)
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+        else
+        {
+            cout << "Not implemented to handle image with " << channels << " channels" << endl;
+            return false;
+        }
+
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        stbi_image_free(image);
+        glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+
+        return true;
+    }
+
+    // Error loading the image
+    return false;
+}
+
+
+// Array and layer of a scene texture in gSceneTextureArrays
+TextureSlot UTextureSlot(GLuint texture)
+{
+    for (size_t i = 0; i < gSceneTextures.size(); ++i)
+        if (gSceneTextures[i] == texture)
+            return gSceneTextureArrays.slot(i);
+    TextureSlot none = { 0, 0 };
+    return none;
+}
+
+
+// Builds the program, texture arrays and buffers of the multi-draw indirect path, or falls back to
+// the render queue when the driver cannot read gl_BaseInstanceARB or the textures do not pack
+void UCreateIndirectPath()
+{
+    if (!gIndirect)
+        return;
+    gIndirect = false;
+    if (!GLEW_ARB_shader_draw_parameters)
+    {
+        cout << "WARNING: GL_ARB_shader_draw_parameters is not supported; drawing without multi-draw indirect" << endl;
+        return;
+    }
+    // The files of the 2D scene textures, in the same order
+    std::vector<std::string> files = { "textures/black.jpg", "textures/wood.jpg", "textures/matte_black.jpg",
+        "textures/blue.jpg", "textures/candle.jpg", "textures/metal.jpg" };
+    if (!gSceneTextureArrays.load(files))
+        return;
+    if (!UCreateShaderProgram(indirectVertexShaderSource, indirectFragmentShaderSource, gIndirectProgramId))
+    {
+        gSceneTextureArrays.destroy();
+        return;
+    }
+    gSceneTextureArrays.printReport();
+
+    UniformTable indirect;
+    indirect.build(gIndirectProgramId);
+    gIndirectTextures = indirect.get<GLint>(UUniformName("uTextures"));
+    const GLint units[MAX_TEXTURE_ARRAYS] = { 0, 1, 2, 3 };
+    USetUniform(gIndirectTextures, units, MAX_TEXTURE_ARRAYS);
+    gIndirectDraws.create();
+    gIndirect = true;
+
+    // Only the arrays are sampled from now on; the 2D textures' names stay as material keys
+    gSceneTextures = { gTextureId, gTextureId2, gTextureId3, gTextureId5, gTextureId6, gTextureId7 };
+    glDeleteTextures(static_cast<GLsizei>(gSceneTextures.size()), gSceneTextures.data());
+}
+
+
+// Builds the instancing program, which samples the indirect path's texture arrays
+void UCreateInstancingPath()
+{
+    if (!gStressCount && !gBenchInstancing)
+        return;
+    if (!gIndirect)
+    {
+        cout << "WARNING: The stress scene needs the packed texture arrays of the indirect path" << endl;
+        return;
+    }
+    if (!UCreateShaderProgram(instanceVertexShaderSource, indirectFragmentShaderSource, gInstanceProgramId))
+        return;
+    UniformTable instancing;
+    instancing.build(gInstanceProgramId);
+    gFirstInstance = instancing.get<GLuint>(UUniformName("uFirstInstance"));
+    gInstanceTextures = instancing.get<GLint>(UUniformName("uTextures"));
+    const GLint units[MAX_TEXTURE_ARRAYS] = { 0, 1, 2, 3 };
+    USetUniform(gInstanceTextures, units, MAX_TEXTURE_ARRAYS);
+    gStressInstances.create();
+}
+
+
+// Builds the depth pre-pass's position-only programs for every path in use, or leaves the pre-pass
+// off if one fails, and with --stats the queries counting fragment shader invocations
+void UCreateDepthPrepass()
+{
+    for (int& mode : gFragmentQueryMode)
+        mode = -1;
+    if (gShowStats && GLEW_ARB_pipeline_statistics_query)
+        glGenQueries(RING_FRAMES, gFragmentQueries);
+    else if (gShowStats)
+        cout << "WARNING: GL_ARB_pipeline_statistics_query is not supported; fragment shader invocations are not counted" << endl;
+
+    bool built = UCreateShaderProgram(depthVertexShaderSource, depthFragmentShaderSource, gDepthProgramId);
+    if (built && gIndirectProgramId)
+        built = UCreateShaderProgram(depthIndirectVertexShaderSource, depthFragmentShaderSource, gDepthIndirectProgramId);
+    if (built && gInstanceProgramId)
+    {
+        built = UCreateShaderProgram(depthInstanceVertexShaderSource, depthFragmentShaderSource, gDepthInstanceProgramId);
+        if (built)
+        {
+            UniformTable depthInstancing;
+            depthInstancing.build(gDepthInstanceProgramId);
+            gDepthFirstInstance = depthInstancing.get<GLuint>(UUniformName("uFirstInstance"));
+        }
+    }
+    if (built)
+        return;
+
+    cout << "WARNING: The depth pre-pass programs failed to build; drawing without the pre-pass" << endl;
+    for (GLuint* program : { &gDepthProgramId, &gDepthIndirectProgramId, &gDepthInstanceProgramId })
+    {
+        if (*program)
+            UDestroyShaderProgram(*program);
+        *program = 0;
+    }
+    gDepthPrepass = false;
+}
+
+
+// Starts counting the shading pass's fragment shader invocations in this frame's query, after
+// collecting the count it took RING_FRAMES frames ago, which is ready by now without a stall
+void UBeginFragmentQuery(bool prepass)
+{
+    if (!gFragmentQueries[0])
+        return;
+    int& mode = gFragmentQueryMode[gFragmentQuery];
+    if (mode >= 0)
+    {
+        GLuint64 invocations = 0;
+        glGetQueryObjectui64v(gFragmentQueries[gFragmentQuery], GL_QUERY_RESULT, &invocations);
+        gFragmentInvocations[mode] += invocations;
+        ++gFragmentFrames[mode];
+    }
+    mode = prepass ? 1 : 0;
+    glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB, gFragmentQueries[gFragmentQuery]);
+}
+
+
+void UEndFragmentQuery()
+{
+    if (!gFragmentQueries[0])
+        return;
+    glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB);
+    gFragmentQuery = (gFragmentQuery + 1) % RING_FRAMES;
+}
+
+
+// Fills instances with count coasters, cups and candles at seeded random positions, headings and
+// sizes on a square around the origin, about STRESS_SPACING apart. Cups and candles use their
+// coarsest LOD level, since most of a large field is far from the camera.
+void UGenerateStressScene(size_t count, unsigned seed, InstanceBuffer& instances)
+{
+    const float STRESS_SPACING = 0.5f;
+    struct Kind
+    {
+        GLuint mesh;
+        GLuint texture;
+    };
+    const Kind kinds[3] = {
+        { gCoasterMesh, gTextureId2 },
+        { gCupLods.levels.back(), gTextureId5 },
+        { gCandleLods.levels.back(), gTextureId6 }
+    };
+
+    float half = 0.5f * STRESS_SPACING * static_cast<float>(std::sqrt(static_cast<double>(count)));
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> kind(0, 2);
+    std::uniform_real_distribution<float> position(-half, half);
+    std::uniform_real_distribution<float> heading(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> size(0.8f, 1.2f);
+
+    instances.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Kind& object = kinds[kind(random)];
+        const MeshBounds& bounds = gMeshes.mesh(object.mesh).bounds;
+        glm::vec3 at(position(random), 0.0f, position(random));
+        // Each mesh is modelled in place in the scene, so it is first moved to the origin in xz
+        glm::mat4 model = glm::translate(at) * glm::rotate(heading(random), glm::vec3(0.0f, 1.0f, 0.0f)) * glm::scale(glm::vec3(size(random)))
+            * glm::translate(glm::vec3(-bounds.center.x, 0.0f, -bounds.center.z));
+
+        InstanceData instance;
+        instance.model = model * gMeshes.dequantize(object.mesh);
+        UNormalMatrix(instance.model, instance.normalMatrix);
+        TextureSlot slot = UTextureSlot(object.texture);
+        instance.material[0] = slot.layer;
+        instance.material[1] = slot.array;
+        instance.material[2] = instance.material[3] = 0;
+        instances.add(object.mesh, instance);
+    }
+}
+
+
+// Draws stress scenes of 1k to 1M instances from a camera above the field, instanced and (up to
+// 100k) with one draw call per object, and prints the average frame time of each
+void UBenchmarkInstancing()
+{
+    if (!gInstanceProgramId)
+        return;
+    const size_t counts[] = { 1000, 10000, 100000, 1000000 };
+    const size_t MAX_PER_OBJECT = 100000;
+    const int frames = 20;
+
+    FrameData frame;
+    frame.view = glm::lookAt(glm::vec3(0.0f, 40.0f, 40.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    frame.projection = glm::perspective(glm::radians(45.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 100.0f);
+    frame.viewProjection = frame.projection * frame.view;
+    frame.viewPosition = glm::vec4(0.0f, 40.0f, 40.0f, 1.0f);
+    frame.lightPosition = glm::vec4(gLightPosition, 1.0f);
+    frame.lightColor = glm::vec4(gLightColor, 1.0f);
+    gFrameUniforms.update(frame);
+
+    gGLState.enable(GL_DEPTH_TEST);
+    gGLState.useProgram(gInstanceProgramId);
+    gSceneTextureArrays.bind(gGLState);
+    InstanceBuffer instances;
+    instances.create();
+    for (size_t count : counts)
+    {
+        UGenerateStressScene(count, gStressSeed, instances);
+        instances.upload();
+
+        double times[2] = { 0.0, 0.0 };
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            if (mode == 1 && count > MAX_PER_OBJECT)
+                break;
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glFinish();
+            double start = glfwGetTime();
+            for (int i = 0; i < frames; ++i)
+            {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                if (mode == 0)
+                    instances.draw(gMeshes, gFirstInstance);
+                else
+                    instances.drawEach(gMeshes, gFirstInstance);
+                glFinish();
+            }
+            times[mode] = (glfwGetTime() - start) * 1000.0 / frames;
+        }
+
+        cout << "INFO: " << count << " instances: instanced " << times[0] << " ms/frame";
+        if (count <= MAX_PER_OBJECT)
+            cout << ", one draw per object " << times[1] << " ms/frame (" << times[1] / times[0] << "x)";
+        cout << endl;
+    }
+    instances.destroy();
+}
+
+
+/* The cube vertex shader as it was before the object block carried MVP and normal matrices: both
+ * derived from the model matrix for every vertex. Kept for --bench-transforms only. */
+const GLchar* perVertexTransformShaderSource = GLSL(440,
+
+    layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 textureCoordinate;
+
+out vec3 vertexNormal;
+out vec3 vertexFragmentPos;
+out vec2 vertexTextureCoordinate;
+
+layout(std140, binding = 0) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 viewPosition;
+    vec4 lightPosition;
+    vec4 lightColor;
+};
+layout(std140, binding = 1) uniform ObjectData
+{
+    mat4 model;
+    mat4 modelViewProjection;
+    mat3 normalMatrix;
+    vec4 highlightColor;
+    vec4 uvScale;
+};
+
+void main()
+{
+    gl_Position = viewProjection * model * vec4(position, 1.0f);
+    vertexFragmentPos = vec3(model * vec4(position, 1.0f));
+    vertexNormal = mat3(transpose(inverse(model))) * normal;
+    vertexTextureCoordinate = textureCoordinate;
+}
+);
+
+
+// Draws the full-detail cup many times with rasterization discarded, once with the per-vertex
+// transform shader and once with the cube program, and prints the GPU time of each from timer
+// queries and, with GL_ARB_pipeline_statistics_query, the vertex shader invocations behind it
+void UBenchmarkTransforms()
+{
+    GLuint perVertexProgram;
+    if (!UCreateShaderProgram(perVertexTransformShaderSource, cubeFragmentShaderSource, perVertexProgram))
+        return;
+    const int draws = 500;
+    const int runs = 3;
+    const bool statistics = GLEW_ARB_pipeline_statistics_query != GL_FALSE;
+    GLuint handle = gCupLods.levels[0];
+    const GLMesh& mesh = gMeshes.mesh(handle);
+
+    FrameData frame;
+    frame.view = glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    frame.projection = glm::perspective(glm::radians(45.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 100.0f);
+    frame.viewProjection = frame.projection * frame.view;
+    frame.viewPosition = glm::vec4(0.0f, 0.0f, 3.0f, 1.0f);
+    frame.lightPosition = glm::vec4(gLightPosition, 1.0f);
+    frame.lightColor = glm::vec4(gLightColor, 1.0f);
+    gFrameUniforms.update(frame);
+    ObjectData object;
+    object.model = gMeshes.dequantize(handle);
+    object.highlightColor = glm::vec4(0.0f);
+    object.uvScale = glm::vec4(gUVScale, 0.0f, 0.0f);
+    gObjectUniforms.clear();
+    GLuint slot = gObjectUniforms.push(object);
+    gObjectUniforms.computeTransforms(frame.viewProjection);
+    gObjectUniforms.upload();
+    gObjectUniforms.bind(slot);
+
+    GLuint queries[2];
+    glGenQueries(2, queries);
+    gGLState.enable(GL_RASTERIZER_DISCARD);
+    gMeshes.bind(mesh.layout);
+    const GLuint programs[2] = { perVertexProgram, gCubeProgramId };
+    double milliseconds[2] = { 0.0, 0.0 };
+    GLuint64 invocations[2] = { 0, 0 };
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        gGLState.useProgram(programs[mode]);
+        for (int run = 0; run < runs; ++run)
+        {
+            glBeginQuery(GL_TIME_ELAPSED, queries[0]);
+            if (statistics)
+                glBeginQuery(GL_VERTEX_SHADER_INVOCATIONS_ARB, queries[1]);
+            for (int i = 0; i < draws; ++i)
+                gMeshes.draw(handle);
+            if (statistics)
+                glEndQuery(GL_VERTEX_SHADER_INVOCATIONS_ARB);
+            glEndQuery(GL_TIME_ELAPSED);
+
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &elapsed);
+            if (statistics)
+                glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &invocations[mode]);
+            double time = elapsed / 1000000.0;
+            milliseconds[mode] = run == 0 ? time : std::min(milliseconds[mode], time);
+        }
+    }
+    gGLState.disable(GL_RASTERIZER_DISCARD);
+    glDeleteQueries(2, queries);
+    gObjectUniforms.clear();
+    UDestroyShaderProgram(perVertexProgram);
+
+    const char* names[2] = { "per-vertex matrices", "precomputed matrices" };
+    cout << "INFO: Transform benchmark: " << draws << " draws of " << mesh.nIndices / 3 << " triangles, "
+        << UObjectTransformsSimdPath() << " object transforms" << endl;
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        cout << "INFO:   " << names[mode] << ": " << milliseconds[mode] << " ms";
+        if (statistics)
+            cout << ", " << invocations[mode] << " vertex shader invocations, "
+                << invocations[mode] / milliseconds[mode] / 1000.0 << " M vertices/s";
+        cout << endl;
+    }
+    cout << "INFO:   speedup " << milliseconds[0] / milliseconds[1] << "x" << endl;
+}
+
+
+void UDestroyTexture(GLuint textureId)
+{
+    glGenTextures(1, &textureId);
+}
+
+
+// Implements the UCreateShaders function
+bool UCreateShaderProgram(const char* vtxShaderSource, const char* fragShaderSource, GLuint& programId)
+{
+    // Compilation and linkage error reporting
+    int success = 0;
+    char infoLog[512];
+
+    // Create a Shader program object.
+    programId = glCreateProgram();
+
+    // Create the vertex and fragment shader objects
+    GLuint vertexShaderId = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fragmentShaderId = glCreateShader(GL_FRAGMENT_SHADER);
+
+    // Retrive the shader source
+    glShaderSource(vertexShaderId, 1, &vtxShaderSource, NULL);
+    glShaderSource(fragmentShaderId, 1, &fragShaderSource, NULL);
+
+    // Compile the vertex shader, and print compilation errors (if any)
+    glCompileShader(vertexShaderId); // compile the vertex shader
+    // check for shader compile errors
+    glGetShaderiv(vertexShaderId, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(vertexShaderId, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+
+        return false;
+    }
+
+    glCompileShader(fragmentShaderId); // compile the fragment shader
+    // check for shader compile errors
+    glGetShaderiv(fragmentShaderId, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(fragmentShaderId, sizeof(infoLog), NULL, infoLog);
+        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+
+        return false;
+    }
+
+    // Attached compiled shaders to the shader program
+    glAttachShader(programId, vertexShaderId);
+    glAttachShader(programId, fragmentShaderId);
+
+    glLinkProgram(programId);   // links the shader program
+    // check for linking errors
+    glGetProgramiv(programId, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(programId, sizeof(infoLog), NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+
+        return false;
+    }
+
+    glUseProgram(programId);    // Uses the shader program
+
+    return true;
+}
+
+
+void UDestroyShaderProgram(GLuint programId)
+{
+    glDeleteProgram(programId);
+}
+
+
+// Reads the cube program's remaining plain uniform once; camera, light and object data come from
+// the uniform blocks
+void ULookupUniforms()
+{
+    UniformTable cube;
+    cube.build(gCubeProgramId);
+    gCubeTexture = cube.get<GLint>(UUniformName("uTexture"));
+    cout << "INFO: Cached " << cube.size() << " cube uniform location(s)" << endl;
+}
+
+
+/* Program the uniform benchmark sets: the scene's camera, light and object values as plain uniforms,
+ * all kept active by the output */
+const GLchar* benchVertexShaderSource = GLSL(440,
+    layout(location = 0) in vec3 position;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 lightColor;
+uniform vec3 lightPos;
+uniform vec3 viewPosition;
+uniform vec3 highlightColor;
+uniform vec2 uvScale;
+out vec3 color;
+void main()
+{
+    gl_Position = projection * view * model * vec4(position, 1.0f);
+    color = lightColor + lightPos + viewPosition + highlightColor + vec3(uvScale, 0.0f);
+}
+);
+const GLchar* benchFragmentShaderSource = GLSL(440,
+    in vec3 color;
+out vec4 fragmentColor;
+void main()
+{
+    fragmentColor = vec4(color, 1.0f);
+}
+);
+
+
+// Sets one object's worth of camera, light and object data many times: the way the render loop
+// used to (a std::string name and a glGetUniformLocation per update), through cached handles, as
+// one FrameData plus one ObjectData block upload, and with the blocks written into a dynamic ring
+// that fences each iteration like a frame
+void UBenchmarkUniforms()
+{
+    GLuint program;
+    if (!UCreateShaderProgram(benchVertexShaderSource, benchFragmentShaderSource, program))
+        return;
+    UniformTable table;
+    table.build(program);
+    Uniform<glm::mat4> model = table.get<glm::mat4>(UUniformName("model"));
+    Uniform<glm::mat4> view = table.get<glm::mat4>(UUniformName("view"));
+    Uniform<glm::mat4> projection = table.get<glm::mat4>(UUniformName("projection"));
+    Uniform<glm::vec3> lightColor = table.get<glm::vec3>(UUniformName("lightColor"));
+    Uniform<glm::vec3> lightPos = table.get<glm::vec3>(UUniformName("lightPos"));
+    Uniform<glm::vec3> viewPosition = table.get<glm::vec3>(UUniformName("viewPosition"));
+    Uniform<glm::vec3> highlightColor = table.get<glm::vec3>(UUniformName("highlightColor"));
+    Uniform<glm::vec2> uvScale = table.get<glm::vec2>(UUniformName("uvScale"));
+
+    const int frames = 20000;
+    glm::mat4 matrix(1.0f);
+    glm::vec3 color(0.5f);
+    glUseProgram(program);
+
+    glFinish();
+    double start = glfwGetTime();
+    for (int i = 0; i < frames; ++i)
+    {
+        matrix[3][0] = static_cast<float>(i);
+        glUniformMatrix4fv(glGetUniformLocation(program, std::string("model").c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
+        glUniformMatrix4fv(glGetUniformLocation(program, std::string("view").c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
+        glUniformMatrix4fv(glGetUniformLocation(program, std::string("projection").c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
+        glUniform3fv(glGetUniformLocation(program, std::string("lightColor").c_str()), 1, glm::value_ptr(color));
+        glUniform3fv(glGetUniformLocation(program, std::string("lightPos").c_str()), 1, glm::value_ptr(color));
+        glUniform3fv(glGetUniformLocation(program, std::string("viewPosition").c_str()), 1, glm::value_ptr(color));
+        glUniform3fv(glGetUniformLocation(program, std::string("highlightColor").c_str()), 1, glm::value_ptr(color));
+        glUniform2fv(glGetUniformLocation(program, std::string("uvScale").c_str()), 1, glm::value_ptr(gUVScale));
+    }
+    glFinish();
+    double byName = glfwGetTime() - start;
+
+    start = glfwGetTime();
+    for (int i = 0; i < frames; ++i)
+    {
+        matrix[3][0] = static_cast<float>(i);
+        USetUniform(model, matrix);
+        USetUniform(view, matrix);
+        USetUniform(projection, matrix);
+        USetUniform(lightColor, color);
+        USetUniform(lightPos, color);
+        USetUniform(viewPosition, color);
+        USetUniform(highlightColor, color);
+        USetUniform(uvScale, gUVScale);
+    }
+    glFinish();
+    double cached = glfwGetTime() - start;
+
+    FrameData frame;
+    ObjectData object;
+    start = glfwGetTime();
+    for (int i = 0; i < frames; ++i)
+    {
+        matrix[3][0] = static_cast<float>(i);
+        frame.view = frame.projection = frame.viewProjection = matrix;
+        frame.viewPosition = frame.lightPosition = frame.lightColor = glm::vec4(color, 1.0f);
+        gFrameUniforms.update(frame);
+        object.model = matrix;
+        object.highlightColor = glm::vec4(color, 0.0f);
+        object.uvScale = glm::vec4(gUVScale, 0.0f, 0.0f);
+        gObjectUniforms.clear();
+        gObjectUniforms.bind(gObjectUniforms.push(object));
+        gObjectUniforms.upload();
+    }
+    glFinish();
+    double blocks = glfwGetTime() - start;
+
+    // Without a mapped ring the last column times the uniform buffer path again
+    DynamicRing ring;
+    if (ring.create(4 * 1024))
+    {
+        gFrameUniforms.setRing(&ring);
+        gObjectUniforms.setRing(&ring);
+    }
+    start = glfwGetTime();
+    for (int i = 0; i < frames; ++i)
+    {
+        ring.beginFrame();
+        matrix[3][0] = static_cast<float>(i);
+        frame.view = frame.projection = frame.viewProjection = matrix;
+        frame.viewPosition = frame.lightPosition = frame.lightColor = glm::vec4(color, 1.0f);
+        gFrameUniforms.update(frame);
+        object.model = matrix;
+        gObjectUniforms.clear();
+        gObjectUniforms.push(object);
+        gObjectUniforms.upload();
+        gObjectUniforms.bind(0);
+        ring.endFrame();
+    }
+    glFinish();
+    double ringed = glfwGetTime() - start;
+    RingStats ringStats = ring.takeStats();
+    gFrameUniforms.setRing(nullptr);
+    gObjectUniforms.setRing(nullptr);
+    ring.destroy();
+    gObjectUniforms.clear();
+    UDestroyShaderProgram(program);
+    glUseProgram(gCubeProgramId);
+
+    cout << "INFO: Uniform updates per object: by name " << byName * 1000000.0 / frames << " us, cached handles "
+        << cached * 1000000.0 / frames << " us (" << byName / cached << "x), uniform blocks " << blocks * 1000000.0 / frames
+        << " us (" << byName / blocks << "x), dynamic ring " << ringed * 1000000.0 / frames << " us ("
+        << byName / ringed << "x, " << ringStats.waitSeconds * 1000000.0 / frames << " us fence wait)" << endl;
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    // With the free cursor the position is only tracked for picking
+    if (gPointerMode)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        return;
+    }
+
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos;
+    lastX = xpos;
+    lastY = ypos;
+
+    float sensitivity = 0.1f;
+    xoffset *= sensitivity;
+    yoffset *= sensitivity;
+
+    yaw += xoffset;
+    pitch += yoffset;
+
+    if (pitch > 89.0f)
+        pitch = 89.0f;
+    if (pitch < -89.0f)
+        pitch = -89.0f;
+
+    glm::vec3 direction;
+    direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+    direction.y = sin(glm::radians(pitch));
+    direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+    cameraFront = glm::normalize(direction);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    fov -= (float)yoffset;
+    if (fov < 1.0f)
+        fov = 1.0f;
+    if (fov > 45.0f)
+        fov = 45.0f;
+}
+
+// Left click selects the object under the cursor, or clears the selection over empty space
+void mouse_button_callback(GLFWwindow*, int button, int action, int)
+{
+    if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS)
+        return;
+
+    gSelection = gHover;
+    if (gSelection.object == UINT32_MAX)
+    {
+        cout << "INFO: Selection cleared" << endl;
+        return;
+    }
+    cout << "INFO: Selected " << gObjectNames[gSelection.object] << ", triangle " << gSelection.triangle << " at ("
+        << gSelection.point.x << ", " << gSelection.point.y << ", " << gSelection.point.z << "), normal ("
+        << gSelection.normal.x << ", " << gSelection.normal.y << ", " << gSelection.normal.z << ")" << endl;
+}
+
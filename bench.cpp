@@ -0,0 +1,637 @@
+/* CPU microbenchmarks for the viewer's scene-processing code.
+ *
+ *   bench <name> [count]
+ *
+ *   cull [count]    SoA frustum culling of count spheres and boxes (default 1000000)
+ *   bvh [count]     BVH build, refit and queries over count moving boxes against brute force (default 100000)
+ *   pick [count]    Cursor picks against a scene of count triangles, BVH against brute force (default 1000000)
+ *   normals [count] Normal and tangent generation over count triangles, 1 thread against all (default 1000000)
+ *   queue [count]   State binds of count draws in scene order against the sorted render queue (default 10000)
+ *   transforms [count] MVP and normal matrices of count objects, glm::inverse against the batch kernels (default 100000)
+ *
+ * Built as its own executable next to the viewer, with optimizations and the widest
+ * instruction set the target allows (for example /O2 /arch:AVX2 or -O2 -mavx2).
+ */
+#include <iostream>         // cout
+#include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <chrono>           // Timing
+#include <cmath>            // Pick mesh heights
+#include <random>           // Random scenes
+#include <algorithm>        // sort
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "frustum.h"                // View frustum planes
+#include "frustum_simd.h"           // SoA frustum culling kernels
+#include "bvh.h"                    // Scene BVH
+#include "pick.h"                   // Ray picking
+#include "mesh_normals.h"           // Normal and tangent generation
+#include "render_queue.h"           // Sorted draw packets
+#include "object_transforms.h"      // Batched MVP and normal matrices
+
+using namespace std; // Standard namespace
+
+namespace
+{
+    // Times fn over several runs and returns the fastest, in milliseconds
+    template <typename Fn>
+    double BestOf(int runs, const Fn& fn)
+    {
+        double best = 0.0;
+        for (int run = 0; run < runs; ++run)
+        {
+            auto start = chrono::steady_clock::now();
+            fn();
+            double time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            best = run == 0 ? time : min(best, time);
+        }
+        return best;
+    }
+
+    // Frustum of a 45 degree camera at the origin looking down -z, as in the viewer
+    Frustum BenchFrustum()
+    {
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return UExtractFrustum(projection * view);
+    }
+
+
+    // Unit wavy grid of about count triangles in the xz plane, with uvs and placeholder normals
+    MeshData BenchGrid(size_t count)
+    {
+        int side = max(2, static_cast<int>(sqrt(static_cast<double>(count) / 2)));
+        MeshData grid;
+        for (int z = 0; z <= side; ++z)
+            for (int x = 0; x <= side; ++x)
+            {
+                float u = static_cast<float>(x) / side, v = static_cast<float>(z) / side;
+                Vertex vertex = { glm::vec3(u - 0.5f, 0.05f * sin(u * 40.0f) * cos(v * 40.0f), v - 0.5f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(u, v) };
+                grid.vertices.push_back(vertex);
+            }
+        for (int z = 0; z < side; ++z)
+            for (int x = 0; x < side; ++x)
+            {
+                GLuint corner = z * (side + 1) + x;
+                GLuint quad[6] = { corner, corner + side + 1, corner + 1, corner + 1, corner + side + 1, corner + side + 2 };
+                grid.indices.insert(grid.indices.end(), quad, quad + 6);
+            }
+        return grid;
+    }
+
+
+    int BenchCull(size_t count)
+    {
+        // Objects scattered through a box around the camera; a few percent end up visible
+        CullBoundsSoA bounds;
+        bounds.resize(count);
+        mt19937 random(1234);
+        uniform_real_distribution<float> position(-100.0f, 100.0f);
+        uniform_real_distribution<float> size(0.1f, 1.0f);
+        for (size_t i = 0; i < count; ++i)
+        {
+            glm::vec3 center(position(random), position(random), position(random));
+            glm::vec3 half(size(random), size(random), size(random));
+            bounds.setSphere(i, center, glm::length(half));
+            bounds.setAabb(i, center - half, center + half);
+        }
+
+        Frustum frustum = BenchFrustum();
+        vector<uint32_t> visible(count);
+        const int runs = 20;
+
+        struct Kernel
+        {
+            const char* name;
+            size_t (*spheres)(const Frustum&, const CullBoundsSoA&, size_t, size_t, uint32_t*);
+            size_t (*aabbs)(const Frustum&, const CullBoundsSoA&, size_t, size_t, uint32_t*);
+        };
+        vector<Kernel> kernels;
+        Kernel scalar = { "scalar", UCullSpheresScalar, UCullAabbsScalar };
+        kernels.push_back(scalar);
+#ifdef FRUSTUM_SIMD_SSE
+        Kernel sse = { "SSE2", UCullSpheresSse, UCullAabbsSse };
+        kernels.push_back(sse);
+#endif
+#ifdef FRUSTUM_SIMD_AVX2
+        Kernel avx2 = { "AVX2", UCullSpheresAvx2, UCullAabbsAvx2 };
+        kernels.push_back(avx2);
+#endif
+
+        cout << "INFO: Culling " << count << " objects, " << runs << " runs, best time" << endl;
+        // The scalar kernel's output is the reference the SIMD kernels must reproduce
+        vector<uint32_t> expectedSpheres, expectedAabbs;
+        for (size_t k = 0; k < kernels.size(); ++k)
+        {
+            size_t spheres = 0, aabbs = 0;
+            double sphereTime = BestOf(runs, [&]() { spheres = kernels[k].spheres(frustum, bounds, 0, count, visible.data()); });
+            vector<uint32_t> sphereList(visible.begin(), visible.begin() + spheres);
+            double aabbTime = BestOf(runs, [&]() { aabbs = kernels[k].aabbs(frustum, bounds, 0, count, visible.data()); });
+            vector<uint32_t> aabbList(visible.begin(), visible.begin() + aabbs);
+            if (k == 0)
+            {
+                expectedSpheres = sphereList;
+                expectedAabbs = aabbList;
+            }
+
+            cout << "INFO:   " << kernels[k].name << ": spheres " << sphereTime << " ms (" << spheres << " visible), boxes "
+                << aabbTime << " ms (" << aabbs << " visible)" << endl;
+            if (sphereList != expectedSpheres || aabbList != expectedAabbs)
+            {
+                cout << "ERROR: " << kernels[k].name << " kernel disagrees with the scalar kernel" << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+
+    int BenchBvh(size_t count)
+    {
+        // Boxes scattered like the cull benchmark, each drifting with its own velocity
+        mt19937 random(1234);
+        uniform_real_distribution<float> position(-100.0f, 100.0f);
+        uniform_real_distribution<float> size(0.1f, 1.0f);
+        uniform_real_distribution<float> speed(-0.05f, 0.05f);
+        vector<glm::vec3> centers(count), halves(count), velocities(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            centers[i] = glm::vec3(position(random), position(random), position(random));
+            halves[i] = glm::vec3(size(random), size(random), size(random));
+            velocities[i] = glm::vec3(speed(random), speed(random), speed(random));
+        }
+
+        SceneBvh tree;
+        for (size_t i = 0; i < count; ++i)
+            tree.add(centers[i] - halves[i], centers[i] + halves[i]);
+        double buildTime = BestOf(5, [&]() { tree.rebuild(); });
+        cout << "INFO: BVH over " << count << " objects: " << tree.nodes().size() << " nodes, built in " << buildTime
+            << " ms, SAH cost " << tree.cost() << endl;
+
+        // Move every object each frame and refit; rebuild once the tree has degraded
+        const int frames = 100;
+        double refitTotal = 0.0, refitWorst = 0.0, rebuildTotal = 0.0;
+        int rebuilds = 0;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                centers[i] += velocities[i];
+                tree.update(static_cast<uint32_t>(i), centers[i] - halves[i], centers[i] + halves[i]);
+            }
+            double refitTime = BestOf(1, [&]() { tree.refit(); });
+            refitTotal += refitTime;
+            refitWorst = max(refitWorst, refitTime);
+            if (tree.degraded())
+            {
+                rebuildTotal += BestOf(1, [&]() { tree.rebuild(); });
+                ++rebuilds;
+            }
+        }
+        cout << "INFO:   refit: " << refitTotal / frames << " ms average, " << refitWorst << " ms worst over " << frames
+            << " frames; " << rebuilds << " rebuild(s) taking " << rebuildTotal << " ms, SAH cost now " << tree.cost() << endl;
+
+        // Frustum culling: hierarchical against per-object tests and the SoA kernels
+        Frustum frustum = BenchFrustum();
+        CullBoundsSoA bounds;
+        bounds.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            bounds.setAabb(i, centers[i] - halves[i], centers[i] + halves[i]);
+
+        const int runs = 20;
+        vector<uint32_t> bvhVisible, bruteVisible;
+        BvhQueryStats cullStats = {};
+        double bvhCull = BestOf(runs, [&]() { bvhVisible.clear(); cullStats = BvhQueryStats(); tree.cullFrustum(frustum, bvhVisible, &cullStats); });
+        double bruteCull = BestOf(runs, [&]()
+        {
+            bruteVisible.clear();
+            for (size_t i = 0; i < count; ++i)
+                if (UFrustumContainsAabb(frustum, centers[i] - halves[i], centers[i] + halves[i]))
+                    bruteVisible.push_back(static_cast<uint32_t>(i));
+        });
+        vector<uint32_t> soaVisible(count);
+        size_t soaCount = 0;
+        double soaCull = BestOf(runs, [&]() { soaCount = UCullAabbs(frustum, bounds, 0, count, soaVisible.data()); });
+
+        sort(bvhVisible.begin(), bvhVisible.end());
+        cout << "INFO:   frustum: BVH " << bvhCull << " ms (" << cullStats.nodesVisited << " nodes, " << cullStats.objectsTested
+            << " objects tested), brute force " << bruteCull << " ms, SoA " << UFrustumSimdPath() << " " << soaCull << " ms; "
+            << bvhVisible.size() << " visible" << endl;
+        if (bvhVisible != bruteVisible || soaCount != bruteVisible.size())
+        {
+            cout << "ERROR: BVH frustum query disagrees with brute force" << endl;
+            return EXIT_FAILURE;
+        }
+
+        // Rays from random points in random directions; brute force runs on a subset
+        const size_t rayCount = 10000, bruteRays = 200;
+        uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        vector<glm::vec3> origins(rayCount), directions(rayCount);
+        for (size_t r = 0; r < rayCount; ++r)
+        {
+            origins[r] = glm::vec3(position(random), position(random), position(random));
+            directions[r] = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 1e-3f));
+        }
+        vector<uint32_t> rayHits(rayCount);
+        vector<float> rayDistances(rayCount);
+        double bvhRays = BestOf(3, [&]()
+        {
+            for (size_t r = 0; r < rayCount; ++r)
+            {
+                float t = 1000.0f;
+                uint32_t id = UINT32_MAX;
+                tree.raycast(origins[r], directions[r], t, id);
+                rayHits[r] = id;
+                rayDistances[r] = t;
+            }
+        });
+        size_t mismatches = 0;
+        double bruteRayTime = BestOf(1, [&]()
+        {
+            for (size_t r = 0; r < bruteRays; ++r)
+            {
+                glm::vec3 inverseDirection = 1.0f / directions[r];
+                float best = 1000.0f;
+                for (size_t i = 0; i < count; ++i)
+                    best = min(best, bvh::rayBox(origins[r], inverseDirection, centers[i] - halves[i], centers[i] + halves[i], best));
+                if (best != rayDistances[r])
+                    ++mismatches;
+            }
+        });
+        cout << "INFO:   rays: BVH " << bvhRays * 1000.0 / rayCount << " us/ray, brute force " << bruteRayTime * 1000.0 / bruteRays
+            << " us/ray" << endl;
+
+        // Sphere range queries
+        const size_t sphereCount = 1000;
+        size_t bvhFound = 0, bruteFound = 0;
+        vector<uint32_t> found;
+        double bvhSpheres = BestOf(3, [&]()
+        {
+            bvhFound = 0;
+            for (size_t q = 0; q < sphereCount; ++q)
+            {
+                found.clear();
+                tree.querySphere(origins[q], 5.0f, found);
+                bvhFound += found.size();
+            }
+        });
+        double bruteSpheres = BestOf(1, [&]()
+        {
+            bruteFound = 0;
+            for (size_t q = 0; q < sphereCount; ++q)
+                for (size_t i = 0; i < count; ++i)
+                    bruteFound += bvh::sphereOverlapsBox(origins[q], 5.0f, centers[i] - halves[i], centers[i] + halves[i]) ? 1 : 0;
+        });
+        cout << "INFO:   spheres: BVH " << bvhSpheres * 1000.0 / sphereCount << " us/query, brute force "
+            << bruteSpheres * 1000.0 / sphereCount << " us/query; " << bvhFound << " objects found" << endl;
+
+        if (mismatches > 0 || bvhFound != bruteFound)
+        {
+            cout << "ERROR: BVH ray / sphere queries disagree with brute force" << endl;
+            return EXIT_FAILURE;
+        }
+
+        // Removed objects must leave every query at once, before the next rebuild
+        vector<bool> removed(count, false);
+        for (size_t i = 0; i < count; i += 7)
+        {
+            tree.remove(static_cast<uint32_t>(i));
+            removed[i] = true;
+        }
+        bvhVisible.clear();
+        tree.cullFrustum(frustum, bvhVisible);
+        sort(bvhVisible.begin(), bvhVisible.end());
+        bruteVisible.clear();
+        for (size_t i = 0; i < count; ++i)
+            if (!removed[i] && UFrustumContainsAabb(frustum, centers[i] - halves[i], centers[i] + halves[i]))
+                bruteVisible.push_back(static_cast<uint32_t>(i));
+        cout << "INFO:   after removing every 7th object: " << bvhVisible.size() << " visible" << endl;
+        if (bvhVisible != bruteVisible)
+        {
+            cout << "ERROR: BVH frustum query reports removed objects" << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+
+    int BenchPick(size_t count)
+    {
+        // Four instances of a wavy grid, each with a quarter of the triangles, placed like scene objects
+        const int instances = 4;
+        MeshData grid = BenchGrid(count / instances);
+        vector<glm::vec3> positions;
+        for (const Vertex& v : grid.vertices)
+            positions.push_back(v.position);
+        const vector<GLuint>& indices = grid.indices;
+
+        PickMesh mesh;
+        double buildTime = BestOf(1, [&]() { mesh.build(positions, indices); });
+        cout << "INFO: Pick mesh: " << mesh.triangleCount() << " triangles, " << mesh.nodeCount() << " nodes, built in " << buildTime
+            << " ms" << endl;
+
+        SceneBvh scene;
+        vector<PickObject> objects;
+        for (int i = 0; i < instances; ++i)
+        {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((i % 2) * 2.2f - 1.1f, -0.5f, (i / 2) * 2.2f - 4.0f))
+                * glm::rotate(glm::mat4(1.0f), glm::radians(30.0f * i), glm::vec3(0.0f, 1.0f, 0.0f)) * glm::scale(glm::mat4(1.0f), glm::vec3(2.0f));
+            UAddPickObject(scene, objects, &mesh, model);
+        }
+        scene.rebuild();
+
+        // Cursor positions over the window of a camera looking down at the instances
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 1.0f), glm::vec3(0.0f, -0.5f, -2.9f), glm::vec3(0.0f, 1.0f, 0.0f));
+        mt19937 random(1234);
+        uniform_real_distribution<double> cursorX(0.0, 800.0), cursorY(0.0, 600.0);
+        const size_t picks = 10000, brutePicks = 20;
+        vector<glm::vec3> origins(picks), directions(picks);
+        for (size_t i = 0; i < picks; ++i)
+            UCursorRay(cursorX(random), cursorY(random), 800, 600, view, projection, origins[i], directions[i]);
+
+        vector<PickHit> hits(picks);
+        size_t hitCount = 0;
+        double worst = 0.0;
+        double total = BestOf(1, [&]()
+        {
+            for (size_t i = 0; i < picks; ++i)
+            {
+                auto start = chrono::steady_clock::now();
+                hits[i].object = UINT32_MAX;
+                hitCount += UPickRay(scene, objects, origins[i], directions[i], hits[i]) ? 1 : 0;
+                worst = max(worst, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+            }
+        });
+
+        // Brute force: every triangle of every instance, with the same SIMD triangle kernel
+        size_t mismatches = 0;
+        double bruteTime = BestOf(1, [&]()
+        {
+            for (size_t i = 0; i < brutePicks; ++i)
+            {
+                float best = FLT_MAX;
+                uint32_t bestObject = UINT32_MAX, bestTriangle = 0;
+                for (uint32_t id = 0; id < objects.size(); ++id)
+                {
+                    glm::vec3 o(objects[id].inverseModel * glm::vec4(origins[i], 1.0f));
+                    glm::vec3 d(objects[id].inverseModel * glm::vec4(directions[i], 0.0f));
+                    uint32_t triangle;
+                    glm::vec3 normal;
+                    if (objects[id].mesh->raycastBruteForce(o, d, best, triangle, normal))
+                    {
+                        bestObject = id;
+                        bestTriangle = triangle;
+                    }
+                }
+                if (bestObject != hits[i].object || (bestObject != UINT32_MAX && bestTriangle != hits[i].triangle))
+                    ++mismatches;
+            }
+        });
+
+        cout << "INFO:   " << picks << " picks over " << instances * mesh.triangleCount() << " triangles (" << hitCount << " hits): "
+            << total * 1000.0 / picks << " us average, " << worst * 1000.0 << " us worst; brute force "
+            << bruteTime * 1000.0 / brutePicks << " us; " << pick::LANES << "-wide triangle kernel" << endl;
+        if (mismatches > 0)
+        {
+            cout << "ERROR: " << mismatches << " BVH picks disagree with brute force" << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+
+    int BenchNormals(size_t count)
+    {
+        // A cube must come out faceted at 30 degrees and smooth at 180, whatever its winding
+        const glm::vec3 corners[8] = { glm::vec3(0, 0, 0), glm::vec3(1, 0, 0), glm::vec3(1, 1, 0), glm::vec3(0, 1, 0),
+            glm::vec3(0, 0, 1), glm::vec3(1, 0, 1), glm::vec3(1, 1, 1), glm::vec3(0, 1, 1) };
+        const GLuint cubeIndices[36] = { 0, 1, 2, 2, 3, 0, 4, 6, 5, 6, 4, 7, 0, 4, 5, 5, 1, 0,
+            3, 2, 6, 6, 7, 3, 0, 3, 7, 7, 4, 0, 1, 5, 6, 2, 1, 6 };
+        MeshData cube;
+        for (const glm::vec3& corner : corners)
+            cube.vertices.push_back(Vertex{ corner, glm::vec3(0.0f), glm::vec2(corner.x, corner.y) });
+        cube.indices.assign(cubeIndices, cubeIndices + 36);
+        MeshData smooth = cube;
+        UGenerateNormals(cube, 30.0f, true);
+        UGenerateNormals(smooth, 180.0f, true);
+        bool cubeValid = cube.vertices.size() == 24 && smooth.vertices.size() == 8;
+        for (size_t t = 0; t < cube.indices.size(); t += 3)
+        {
+            const Vertex& a = cube.vertices[cube.indices[t]];
+            glm::vec3 face = glm::cross(cube.vertices[cube.indices[t + 1]].position - a.position, cube.vertices[cube.indices[t + 2]].position - a.position);
+            cubeValid = cubeValid && glm::dot(face, a.position - glm::vec3(0.5f)) > 0.0f && glm::dot(glm::normalize(face), a.normal) > 0.999f;
+        }
+        cout << "INFO: Cube: " << cube.vertices.size() << " faceted vertices, " << smooth.vertices.size() << " smooth vertices" << endl;
+
+        MeshData grid = BenchGrid(count);
+        size_t triangles = grid.indices.size() / 3;
+        MeshData single, parallel;
+        double singleNormals = BestOf(3, [&]() { single = grid; UGenerateNormals(single, 30.0f, false, 1); });
+        double parallelNormals = BestOf(3, [&]() { parallel = grid; UGenerateNormals(parallel, 30.0f); });
+        bool normalsMatch = single.vertices.size() == parallel.vertices.size() && single.indices == parallel.indices
+            && memcmp(single.vertices.data(), parallel.vertices.data(), single.vertices.size() * sizeof(Vertex)) == 0;
+        double singleTangents = BestOf(3, [&]() { UGenerateTangents(single, 1); });
+        double parallelTangents = BestOf(3, [&]() { UGenerateTangents(parallel); });
+        bool tangentsMatch = single.tangents.size() == parallel.tangents.size()
+            && memcmp(single.tangents.data(), parallel.tangents.data(), single.tangents.size() * sizeof(glm::vec4)) == 0;
+
+        // The grid's uvs follow +x and +z, so every tangent is a unit vector in the surface along +x
+        float worstTangent = 0.0f;
+        for (size_t v = 0; v < parallel.vertices.size(); ++v)
+        {
+            glm::vec3 tangent(parallel.tangents[v]);
+            worstTangent = max(worstTangent, fabs(glm::dot(tangent, parallel.vertices[v].normal)));
+            worstTangent = max(worstTangent, fabs(glm::length(tangent) - 1.0f));
+            if (tangent.x <= 0.0f || parallel.tangents[v].w != -1.0f)
+                worstTangent = 1.0f;
+        }
+
+        unsigned threads = meshnormals::threadsFor(0, triangles);
+        cout << "INFO: Grid: " << triangles << " triangles, " << grid.vertices.size() << " -> " << parallel.vertices.size() << " vertices; "
+            << meshnormals::WIDTH << "-wide face kernels" << endl;
+        cout << "INFO:   normals: 1 thread " << triangles / singleNormals / 1000.0 << " M triangles/s, " << threads << " threads "
+            << triangles / parallelNormals / 1000.0 << " M triangles/s" << endl;
+        cout << "INFO:   tangents: 1 thread " << triangles / singleTangents / 1000.0 << " M triangles/s, " << threads << " threads "
+            << triangles / parallelTangents / 1000.0 << " M triangles/s; worst orthogonality / length error " << worstTangent << endl;
+
+        if (!cubeValid || !normalsMatch || !tangentsMatch || worstTangent > 1e-4f)
+        {
+            cout << "ERROR: Generated normals or tangents are wrong or differ between thread counts" << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+
+    int BenchQueue(size_t count)
+    {
+        // Objects in scene order, each with one of a few programs, many textures and both vertex
+        // layouts' VAOs, scattered in front of the camera
+        const uint32_t programs = 3, textures = 64, vaos = 2;
+        mt19937 random(1234);
+        uniform_int_distribution<uint32_t> program(1, programs), texture(1, textures), vao(1, vaos);
+        uniform_real_distribution<float> depth(0.0f, 1.0f);
+        vector<RenderState> states(count);
+        vector<float> depths(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            states[i].program = program(random);
+            states[i].vao = vao(random);
+            // The lamp-like program draws untextured
+            states[i].texture = states[i].program == programs ? 0 : texture(random);
+            depths[i] = depth(random);
+        }
+
+        RenderQueue queue;
+        auto build = [&]()
+        {
+            queue.clear();
+            for (size_t i = 0; i < count; ++i)
+                queue.push(URenderKey(RENDER_PASS_OPAQUE, states[i].program, states[i].texture, states[i].vao, URenderDepth(depths[i])),
+                    states[i], static_cast<uint32_t>(i));
+        };
+        auto none = [](const RenderPacket&, unsigned) {};
+
+        // The fixed sequence the viewer used to issue: a texture and VAO bind for every draw, the
+        // program switched wherever scene order changes it
+        build();
+        RenderBindStats unsorted = queue.submit(none);
+        size_t fixedTextures = 0;
+        for (const RenderState& state : states)
+            fixedTextures += state.texture != 0;
+
+        vector<RenderPacket> scene = queue.all(), reference;
+        double buildTime = BestOf(20, build);
+        double sortTime = BestOf(20, [&]() { build(); queue.sort(); }) - buildTime;
+        double stdSortTime = BestOf(20, [&]()
+        {
+            reference = scene;
+            stable_sort(reference.begin(), reference.end(), [](const RenderPacket& a, const RenderPacket& b) { return a.key < b.key; });
+        });
+
+        build();
+        queue.sort();
+        RenderBindStats sorted = queue.submit(none);
+        bool sortValid = true;
+        for (size_t i = 0; i < count; ++i)
+            sortValid = sortValid && queue.all()[i].item == reference[i].item;
+
+        cout << "INFO: " << count << " draws, " << programs << " programs, " << textures << " textures, " << vaos << " VAOs" << endl;
+        cout << "INFO:   fixed sequence: " << unsorted.programBinds << " program, " << fixedTextures << " texture, "
+            << count << " VAO binds" << endl;
+        cout << "INFO:   scene order, filtered: " << unsorted.programBinds << " program, " << unsorted.textureBinds << " texture, "
+            << unsorted.vaoBinds << " VAO binds" << endl;
+        cout << "INFO:   sorted queue: " << sorted.programBinds << " program, " << sorted.textureBinds << " texture, "
+            << sorted.vaoBinds << " VAO binds" << endl;
+        cout << "INFO:   keys " << buildTime * 1000.0 << " us, radix sort " << sortTime * 1000.0 << " us, std::stable_sort "
+            << stdSortTime * 1000.0 << " us per frame" << endl;
+
+        if (!sortValid)
+        {
+            cout << "ERROR: Radix sorted packets differ from std::stable_sort" << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+
+    // Object records laid out as ObjectData: model, then the transform the kernels fill
+    struct TransformRecord
+    {
+        glm::mat4 model;
+        ObjectTransform transform;
+    };
+
+
+    int BenchTransforms(size_t count)
+    {
+        // Half the objects rotated, translated and uniformly scaled, half with a per-axis scale as
+        // the position dequantization adds
+        mt19937 random(1234);
+        uniform_real_distribution<float> position(-50.0f, 50.0f), angle(0.0f, 6.2831853f), scale(0.5f, 2.0f);
+        vector<TransformRecord> records(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random), position(random)));
+            model = glm::rotate(model, angle(random), glm::normalize(glm::vec3(scale(random), scale(random), scale(random))));
+            model = i % 2 == 0 ? glm::scale(model, glm::vec3(scale(random))) : glm::scale(model, glm::vec3(scale(random), scale(random), scale(random)));
+            records[i].model = model;
+        }
+        glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f)
+            * glm::lookAt(glm::vec3(0.0f, 10.0f, 60.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        // What every vertex of every object used to compute
+        vector<TransformRecord> reference = records;
+        double inverseTime = BestOf(5, [&]()
+        {
+            for (TransformRecord& record : reference)
+            {
+                record.transform.modelViewProjection = viewProjection * record.model;
+                glm::mat3 normal = glm::transpose(glm::inverse(glm::mat3(record.model)));
+                for (int c = 0; c < 3; ++c)
+                    record.transform.normalMatrix[c] = glm::vec4(normal[c], 0.0f);
+            }
+        });
+        ObjectTransformStats stats;
+        double scalarTime = BestOf(5, [&]() { stats = UComputeObjectTransformsScalar(viewProjection, records.data(), sizeof(TransformRecord), count); });
+        vector<TransformRecord> scalar = records;
+        double batchTime = BestOf(5, [&]() { UComputeObjectTransforms(viewProjection, records.data(), sizeof(TransformRecord), count); });
+
+        // Normal matrices may differ in length on the rigid path, so directions are compared
+        float worst = 0.0f;
+        for (size_t i = 0; i < count; ++i)
+            for (int c = 0; c < 4; ++c)
+            {
+                worst = max(worst, glm::length(records[i].transform.modelViewProjection[c] - reference[i].transform.modelViewProjection[c])
+                    / max(glm::length(reference[i].transform.modelViewProjection[c]), 1.0f));
+                worst = max(worst, glm::length(scalar[i].transform.modelViewProjection[c] - records[i].transform.modelViewProjection[c])
+                    / max(glm::length(reference[i].transform.modelViewProjection[c]), 1.0f));
+                if (c == 3)
+                    continue;
+                glm::vec3 expected = glm::normalize(glm::vec3(reference[i].transform.normalMatrix[c]));
+                worst = max(worst, glm::length(glm::normalize(glm::vec3(records[i].transform.normalMatrix[c])) - expected));
+                worst = max(worst, glm::length(glm::normalize(glm::vec3(scalar[i].transform.normalMatrix[c])) - expected));
+            }
+
+        cout << "INFO: " << count << " objects, " << stats.rigid << " rigid, " << stats.general << " general" << endl;
+        cout << "INFO:   glm::inverse " << count / inverseTime / 1000.0 << " M objects/s, scalar kernel "
+            << count / scalarTime / 1000.0 << " M objects/s, " << UObjectTransformsSimdPath() << " kernel "
+            << count / batchTime / 1000.0 << " M objects/s (" << inverseTime / batchTime << "x); worst error " << worst << endl;
+
+        if (worst > 1e-4f)
+        {
+            cout << "ERROR: Batched object transforms differ from glm::inverse" << endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 2 && strcmp(argv[1], "cull") == 0)
+        return BenchCull(argc >= 3 ? strtoul(argv[2], nullptr, 10) : 1000000);
+    if (argc >= 2 && strcmp(argv[1], "bvh") == 0)
+        return BenchBvh(argc >= 3 ? strtoul(argv[2], nullptr, 10) : 100000);
+    if (argc >= 2 && strcmp(argv[1], "pick") == 0)
+        return BenchPick(argc >= 3 ? strtoul(argv[2], nullptr, 10) : 1000000);
+    if (argc >= 2 && strcmp(argv[1], "normals") == 0)
+        return BenchNormals(argc >= 3 ? strtoul(argv[2], nullptr, 10) : 1000000);
+    if (argc >= 2 && strcmp(argv[1], "queue") == 0)
+        return BenchQueue(argc >= 3 ? strtoul(argv[2], nullptr, 10) : 10000);
+    if (argc >= 2 && strcmp(argv[1], "transforms") == 0)
+        return BenchTransforms(argc >= 3 ? strtoul(argv[2], nullptr, 10) : 100000);
+
+    cout << "Usage: bench cull [count]" << endl;
+    cout << "       bench bvh [count]" << endl;
+    cout << "       bench pick [count]" << endl;
+    cout << "       bench normals [count]" << endl;
+    cout << "       bench queue [count]" << endl;
+    cout << "       bench transforms [count]" << endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,537 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include "frustum.h"
+
+// 32-byte BVH node. Children of an inner node are stored next to each other after it, so a
+// reverse walk over the node array visits every child before its parent.
+struct BvhNode
+{
+    glm::vec3 min;
+    uint32_t first;     // Leaf: first slot in the object list; inner: index of the left child
+    glm::vec3 max;
+    uint32_t count;     // Objects in the leaf; 0 for inner nodes
+};
+static_assert(sizeof(BvhNode) == 32, "BvhNode should stay two nodes per cache line");
+
+// Work done by one query, for comparing against brute force
+struct BvhQueryStats
+{
+    size_t nodesVisited;
+    size_t objectsTested;
+};
+
+namespace bvh
+{
+    const int SAH_BINS = 16;
+    const uint32_t MIN_LEAF_OBJECTS = 4;        // Smaller ranges are never split; halves the node count refit walks
+    const uint32_t MAX_LEAF_OBJECTS = 8;        // Larger ranges are split even when the SAH would keep a leaf
+    const float TRAVERSAL_COST = 1.0f;          // SAH cost of visiting a node, relative to testing one object
+    const uint32_t MAX_STACK_DEPTH = 64;        // Traversal stack size
+    const uint32_t MAX_TREE_DEPTH = 48;         // Deeper ranges become leaves, so the stack never overflows
+
+    inline float surfaceArea(const glm::vec3& min, const glm::vec3& max)
+    {
+        glm::vec3 d = glm::max(max - min, glm::vec3(0.0f));
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    // Slab test; returns the entry distance or FLT_MAX when the ray misses within [0, tMax]
+    inline float rayBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const glm::vec3& min, const glm::vec3& max, float tMax)
+    {
+        glm::vec3 t0 = (min - origin) * inverseDirection;
+        glm::vec3 t1 = (max - origin) * inverseDirection;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+        return enter <= exit ? enter : FLT_MAX;
+    }
+
+    inline bool sphereOverlapsBox(const glm::vec3& center, float radius, const glm::vec3& min, const glm::vec3& max)
+    {
+        glm::vec3 d = center - glm::clamp(center, min, max);
+        return glm::dot(d, d) <= radius * radius;
+    }
+}
+
+
+// Bounding volume hierarchy over scene objects given by world-space AABBs.
+// Moving objects are handled with update() + refit(); adding or removing objects, or letting
+// refits degrade the tree (degraded()), calls for a rebuild(), which is a binned SAH build.
+class SceneBvh
+{
+public:
+    SceneBvh() : structureDirty(false), builtCost(0.0f) {}
+
+    // Adds an object and returns its id; the tree picks it up at the next rebuild()
+    uint32_t add(const glm::vec3& min, const glm::vec3& max)
+    {
+        uint32_t id = static_cast<uint32_t>(objectSlot.size());
+        objectSlot.push_back(static_cast<uint32_t>(slotObject.size()));
+        slotObject.push_back(id);
+        slotMin.push_back(min);
+        slotMax.push_back(max);
+        live.push_back(true);
+        structureDirty = true;
+        return id;
+    }
+
+    // Moves an object; the nodes above it grow or shrink at the next refit()
+    void update(uint32_t id, const glm::vec3& min, const glm::vec3& max)
+    {
+        slotMin[objectSlot[id]] = min;
+        slotMax[objectSlot[id]] = max;
+    }
+
+    // Removes an object from queries right away; its id stays reserved
+    void remove(uint32_t id)
+    {
+        // An inverted box fails every query until the rebuild drops the object
+        live[id] = false;
+        slotMin[objectSlot[id]] = glm::vec3(FLT_MAX);
+        slotMax[objectSlot[id]] = glm::vec3(-FLT_MAX);
+        structureDirty = true;
+    }
+
+    size_t size() const { return objectSlot.size(); }
+    bool needsRebuild() const { return structureDirty; }
+    const std::vector<BvhNode>& nodes() const { return nodeList; }
+    // Object id stored in a leaf slot (BvhNode::first .. first + count - 1)
+    uint32_t objectAt(uint32_t slot) const { return slotObject[slot]; }
+
+    // Builds a new tree over the live objects with a binned surface area heuristic
+    void rebuild()
+    {
+        // The build sorts object ids; bounds move to the new slot order afterwards
+        size_t objectCount = objectSlot.size();
+        buildMin.resize(objectCount);
+        buildMax.resize(objectCount);
+        centroids.resize(objectCount);
+        for (size_t slot = 0; slot < slotObject.size(); ++slot)
+        {
+            uint32_t id = slotObject[slot];
+            buildMin[id] = slotMin[slot];
+            buildMax[id] = slotMax[slot];
+            centroids[id] = (slotMin[slot] + slotMax[slot]) * 0.5f;
+        }
+        slotObject.clear();
+        for (uint32_t id = 0; id < objectCount; ++id)
+            if (live[id])
+                slotObject.push_back(id);
+
+        nodeList.clear();
+        nodeList.reserve(slotObject.size() * 2);
+        nodeList.push_back(BvhNode());
+        buildNode(0, 0, static_cast<uint32_t>(slotObject.size()), 0);
+
+        // Removed objects keep a slot past the end of the tree so update() stays valid for them
+        for (uint32_t id = 0; id < objectCount; ++id)
+            if (!live[id])
+                slotObject.push_back(id);
+        slotMin.resize(objectCount);
+        slotMax.resize(objectCount);
+        for (size_t slot = 0; slot < objectCount; ++slot)
+        {
+            uint32_t id = slotObject[slot];
+            objectSlot[id] = static_cast<uint32_t>(slot);
+            slotMin[slot] = buildMin[id];
+            slotMax[slot] = buildMax[id];
+        }
+        // Build scratch is not kept between rebuilds; static trees over many triangles would carry it for nothing
+        std::vector<glm::vec3>().swap(buildMin);
+        std::vector<glm::vec3>().swap(buildMax);
+        std::vector<glm::vec3>().swap(centroids);
+
+        leafNodes.clear();
+        innerNodes.clear();
+        for (uint32_t i = 0; i < nodeList.size(); ++i)
+            (nodeList[i].count > 0 ? leafNodes : innerNodes).push_back(i);
+        std::sort(leafNodes.begin(), leafNodes.end(), [&](uint32_t a, uint32_t b) { return nodeList[a].first < nodeList[b].first; });
+
+        structureDirty = false;
+        builtCost = cost();
+    }
+
+    // Recomputes every node's box from the current object bounds, keeping the tree's shape
+    void refit()
+    {
+        // Leaves first, then inner nodes from the back; keeps the leaf / inner branch out of both loops
+        for (uint32_t i : leafNodes)
+        {
+            BvhNode& node = nodeList[i];
+            glm::vec3 lo = slotMin[node.first], hi = slotMax[node.first];
+            for (uint32_t k = node.first + 1; k < node.first + node.count; ++k)
+            {
+                lo = glm::min(lo, slotMin[k]);
+                hi = glm::max(hi, slotMax[k]);
+            }
+            node.min = lo;
+            node.max = hi;
+        }
+        for (size_t j = innerNodes.size(); j-- > 0;)
+        {
+            BvhNode& node = nodeList[innerNodes[j]];
+            const BvhNode& left = nodeList[node.first];
+            const BvhNode& right = nodeList[node.first + 1];
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+        }
+    }
+
+    // SAH cost of the current tree, in object tests per query relative to the root's area
+    float cost() const
+    {
+        if (nodeList.empty())
+            return 0.0f;
+        float rootArea = bvh::surfaceArea(nodeList[0].min, nodeList[0].max);
+        if (rootArea <= 0.0f)
+            return 0.0f;
+        float total = 0.0f;
+        for (const BvhNode& node : nodeList)
+            total += bvh::surfaceArea(node.min, node.max) * (node.count > 0 ? static_cast<float>(node.count) : bvh::TRAVERSAL_COST);
+        return total / rootArea;
+    }
+
+    // True when refits have let the tree's cost grow past threshold times its cost at the last rebuild
+    bool degraded(float threshold = 1.5f) const
+    {
+        return structureDirty || cost() > builtCost * threshold;
+    }
+
+    // Appends the ids of objects whose boxes intersect the frustum. Subtrees fully inside a plane
+    // stop testing it, and subtrees fully inside all planes are accepted without further tests.
+    void cullFrustum(const Frustum& frustum, std::vector<uint32_t>& visible, BvhQueryStats* stats = nullptr) const
+    {
+        if (nodeList.empty())
+            return;
+
+        struct Entry { uint32_t node; uint32_t planeMask; };
+        Entry stack[bvh::MAX_STACK_DEPTH];
+        int top = 0;
+        stack[top++] = Entry{ 0, 0x3F };
+
+        while (top > 0)
+        {
+            Entry entry = stack[--top];
+            const BvhNode& node = nodeList[entry.node];
+            if (stats)
+                ++stats->nodesVisited;
+
+            uint32_t mask = entry.planeMask;
+            if (!classify(frustum, node.min, node.max, mask))
+                continue;
+
+            if (mask == 0)
+            {
+                appendSubtree(entry.node, visible);
+                continue;
+            }
+            if (node.count > 0)
+            {
+                for (uint32_t k = node.first; k < node.first + node.count; ++k)
+                {
+                    uint32_t objectMask = mask;
+                    if (stats)
+                        ++stats->objectsTested;
+                    if (classify(frustum, slotMin[k], slotMax[k], objectMask))
+                        visible.push_back(slotObject[k]);
+                }
+                continue;
+            }
+            stack[top++] = Entry{ node.first + 1, mask };
+            stack[top++] = Entry{ node.first, mask };
+        }
+    }
+
+    // Nearest hit along the ray within [0, tMax). intersect(id, origin, direction, tMax) returns the
+    // exact hit distance of an object whose box the ray enters, or tMax or more (e.g. FLT_MAX) for a
+    // miss. On a hit, tMax becomes the hit distance and hitId the object.
+    template <typename Intersect>
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float& tMax, uint32_t& hitId, const Intersect& intersect,
+        BvhQueryStats* stats = nullptr) const
+    {
+        if (nodeList.empty())
+            return false;
+
+        glm::vec3 inverseDirection = 1.0f / direction;
+        bool hit = false;
+
+        struct Entry { uint32_t node; float enter; };
+        Entry stack[bvh::MAX_STACK_DEPTH];
+        int top = 0;
+        float rootEnter = bvh::rayBox(origin, inverseDirection, nodeList[0].min, nodeList[0].max, tMax);
+        if (rootEnter != FLT_MAX)
+            stack[top++] = Entry{ 0, rootEnter };
+
+        while (top > 0)
+        {
+            Entry entry = stack[--top];
+            if (entry.enter > tMax)
+                continue;
+            const BvhNode& node = nodeList[entry.node];
+            if (stats)
+                ++stats->nodesVisited;
+
+            if (node.count > 0)
+            {
+                for (uint32_t k = node.first; k < node.first + node.count; ++k)
+                {
+                    uint32_t id = slotObject[k];
+                    if (stats)
+                        ++stats->objectsTested;
+                    if (bvh::rayBox(origin, inverseDirection, slotMin[k], slotMax[k], tMax) == FLT_MAX)
+                        continue;
+                    float t = intersect(id, origin, direction, tMax);
+                    if (t < tMax)
+                    {
+                        tMax = t;
+                        hitId = id;
+                        hit = true;
+                    }
+                }
+                continue;
+            }
+
+            // Visit the nearer child first so later boxes are pruned by the closer hit
+            float enterLeft = bvh::rayBox(origin, inverseDirection, nodeList[node.first].min, nodeList[node.first].max, tMax);
+            float enterRight = bvh::rayBox(origin, inverseDirection, nodeList[node.first + 1].min, nodeList[node.first + 1].max, tMax);
+            Entry left = { node.first, enterLeft };
+            Entry right = { node.first + 1, enterRight };
+            if (enterLeft < enterRight)
+                std::swap(left, right);
+            if (left.enter != FLT_MAX)
+                stack[top++] = left;
+            if (right.enter != FLT_MAX)
+                stack[top++] = right;
+        }
+        return hit;
+    }
+
+    // Ray against the object boxes themselves
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float& tMax, uint32_t& hitId, BvhQueryStats* stats = nullptr) const
+    {
+        glm::vec3 inverseDirection = 1.0f / direction;
+        return raycast(origin, direction, tMax, hitId,
+            [&](uint32_t id, const glm::vec3& o, const glm::vec3&, float t)
+            {
+                return bvh::rayBox(o, inverseDirection, slotMin[objectSlot[id]], slotMax[objectSlot[id]], t);
+            },
+            stats);
+    }
+
+    // Appends the ids of objects whose boxes overlap the sphere
+    void querySphere(const glm::vec3& center, float radius, std::vector<uint32_t>& out, BvhQueryStats* stats = nullptr) const
+    {
+        if (nodeList.empty())
+            return;
+
+        uint32_t stack[bvh::MAX_STACK_DEPTH];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const BvhNode& node = nodeList[stack[--top]];
+            if (stats)
+                ++stats->nodesVisited;
+            if (!bvh::sphereOverlapsBox(center, radius, node.min, node.max))
+                continue;
+
+            if (node.count > 0)
+            {
+                for (uint32_t k = node.first; k < node.first + node.count; ++k)
+                {
+                    if (stats)
+                        ++stats->objectsTested;
+                    if (bvh::sphereOverlapsBox(center, radius, slotMin[k], slotMax[k]))
+                        out.push_back(slotObject[k]);
+                }
+                continue;
+            }
+            stack[top++] = node.first + 1;
+            stack[top++] = node.first;
+        }
+    }
+
+private:
+    // Object bounds are stored in leaf order, so refits and leaf tests read them sequentially
+    std::vector<glm::vec3> slotMin;
+    std::vector<glm::vec3> slotMax;
+    std::vector<uint32_t> slotObject;       // Object id in each slot; leaf ranges index slots
+    std::vector<uint32_t> objectSlot;       // Slot of each object id
+    std::vector<bool> live;
+    std::vector<BvhNode> nodeList;
+    std::vector<uint32_t> leafNodes;        // Leaf node indices in slot order
+    std::vector<uint32_t> innerNodes;       // Inner node indices, parents before children
+    std::vector<glm::vec3> buildMin;        // Build scratch, indexed by object id
+    std::vector<glm::vec3> buildMax;
+    std::vector<glm::vec3> centroids;
+    bool structureDirty;
+    float builtCost;
+
+    // Rejects the box against the planes left in mask and clears the planes the box is fully inside
+    static bool classify(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max, uint32_t& mask)
+    {
+        for (int p = 0; p < 6; ++p)
+        {
+            if (!(mask & (1u << p)))
+                continue;
+            const glm::vec4& plane = frustum.planes[p];
+            glm::vec3 normal(plane);
+            glm::vec3 farthest(normal.x >= 0.0f ? max.x : min.x, normal.y >= 0.0f ? max.y : min.y, normal.z >= 0.0f ? max.z : min.z);
+            if (glm::dot(normal, farthest) + plane.w < 0.0f)
+                return false;
+            glm::vec3 nearest(normal.x >= 0.0f ? min.x : max.x, normal.y >= 0.0f ? min.y : max.y, normal.z >= 0.0f ? min.z : max.z);
+            if (glm::dot(normal, nearest) + plane.w >= 0.0f)
+                mask &= ~(1u << p);
+        }
+        return true;
+    }
+
+    // Every object under root, skipping removed ones: their inverted boxes are never tested here
+    void appendSubtree(uint32_t root, std::vector<uint32_t>& out) const
+    {
+        uint32_t stack[bvh::MAX_STACK_DEPTH];
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0)
+        {
+            const BvhNode& node = nodeList[stack[--top]];
+            if (node.count > 0)
+            {
+                for (uint32_t k = node.first; k < node.first + node.count; ++k)
+                    if (live[slotObject[k]])
+                        out.push_back(slotObject[k]);
+                continue;
+            }
+            stack[top++] = node.first + 1;
+            stack[top++] = node.first;
+        }
+    }
+
+    void buildNode(uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth)
+    {
+        glm::vec3 lo(FLT_MAX), hi(-FLT_MAX), centroidLo(FLT_MAX), centroidHi(-FLT_MAX);
+        for (uint32_t k = first; k < first + count; ++k)
+        {
+            uint32_t id = slotObject[k];
+            lo = glm::min(lo, buildMin[id]);
+            hi = glm::max(hi, buildMax[id]);
+            centroidLo = glm::min(centroidLo, centroids[id]);
+            centroidHi = glm::max(centroidHi, centroids[id]);
+        }
+        nodeList[nodeIndex].min = lo;
+        nodeList[nodeIndex].max = hi;
+        nodeList[nodeIndex].first = first;
+        nodeList[nodeIndex].count = count;
+        if (count <= bvh::MIN_LEAF_OBJECTS || depth >= bvh::MAX_TREE_DEPTH)
+            return;
+
+        // Split along the axis with the widest spread of centroids
+        glm::vec3 extent = centroidHi - centroidLo;
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        uint32_t middle = first + count / 2;
+
+        if (extent[axis] > 0.0f)
+        {
+            struct Bin
+            {
+                glm::vec3 min;
+                glm::vec3 max;
+                uint32_t count;
+            };
+            Bin bins[bvh::SAH_BINS];
+            for (Bin& bin : bins)
+                bin = Bin{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX), 0 };
+
+            float scale = bvh::SAH_BINS / extent[axis];
+            auto binOf = [&](uint32_t id)
+            {
+                return std::min(bvh::SAH_BINS - 1, static_cast<int>((centroids[id][axis] - centroidLo[axis]) * scale));
+            };
+            for (uint32_t k = first; k < first + count; ++k)
+            {
+                uint32_t id = slotObject[k];
+                Bin& bin = bins[binOf(id)];
+                bin.min = glm::min(bin.min, buildMin[id]);
+                bin.max = glm::max(bin.max, buildMax[id]);
+                ++bin.count;
+            }
+
+            // Sweep from the right to get the area and count of every right-hand side, then from the left
+            float rightArea[bvh::SAH_BINS];
+            uint32_t rightCount[bvh::SAH_BINS];
+            glm::vec3 sweepMin(FLT_MAX), sweepMax(-FLT_MAX);
+            uint32_t sweepCount = 0;
+            for (int b = bvh::SAH_BINS - 1; b > 0; --b)
+            {
+                sweepMin = glm::min(sweepMin, bins[b].min);
+                sweepMax = glm::max(sweepMax, bins[b].max);
+                sweepCount += bins[b].count;
+                rightArea[b] = bvh::surfaceArea(sweepMin, sweepMax);
+                rightCount[b] = sweepCount;
+            }
+
+            float bestCost = FLT_MAX;
+            int bestSplit = -1;
+            sweepMin = glm::vec3(FLT_MAX);
+            sweepMax = glm::vec3(-FLT_MAX);
+            sweepCount = 0;
+            for (int b = 1; b < bvh::SAH_BINS; ++b)
+            {
+                sweepMin = glm::min(sweepMin, bins[b - 1].min);
+                sweepMax = glm::max(sweepMax, bins[b - 1].max);
+                sweepCount += bins[b - 1].count;
+                if (sweepCount == 0 || rightCount[b] == 0)
+                    continue;
+                float splitCost = bvh::surfaceArea(sweepMin, sweepMax) * sweepCount + rightArea[b] * rightCount[b];
+                if (splitCost < bestCost)
+                {
+                    bestCost = splitCost;
+                    bestSplit = b;
+                }
+            }
+
+            // Stay a leaf when splitting costs more than testing every object
+            float leafCost = bvh::surfaceArea(lo, hi) * count;
+            float parentArea = bvh::surfaceArea(lo, hi);
+            if (count <= bvh::MAX_LEAF_OBJECTS && bestCost + bvh::TRAVERSAL_COST * parentArea >= leafCost)
+                return;
+
+            if (bestSplit > 0)
+            {
+                uint32_t* split = std::partition(slotObject.data() + first, slotObject.data() + first + count,
+                    [&](uint32_t id) { return binOf(id) < bestSplit; });
+                middle = static_cast<uint32_t>(split - slotObject.data());
+            }
+        }
+        else if (count <= bvh::MAX_LEAF_OBJECTS)
+        {
+            return;
+        }
+
+        // Identical centroids or a degenerate split: halve by count
+        if (middle == first || middle == first + count)
+        {
+            middle = first + count / 2;
+            std::nth_element(slotObject.begin() + first, slotObject.begin() + middle, slotObject.begin() + first + count,
+                [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+        }
+
+        uint32_t left = static_cast<uint32_t>(nodeList.size());
+        nodeList.push_back(BvhNode());
+        nodeList.push_back(BvhNode());
+        nodeList[nodeIndex].first = left;
+        nodeList[nodeIndex].count = 0;
+        buildNode(left, first, middle - first, depth + 1);
+        buildNode(left + 1, middle, first + count - middle, depth + 1);
+    }
+};
+#endif
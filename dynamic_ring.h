@@ -0,0 +1,234 @@
+#ifndef DYNAMIC_RING_H
+#define DYNAMIC_RING_H
+
+#include <include/GL/glew.h>
+#include <include/GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+/* Upload ring for data written every frame: uniform blocks, per-draw records, indirect commands
+ * or streamed vertices. One buffer created with glBufferStorage stays persistently and coherently
+ * mapped; it is split into RING_FRAMES regions, and each frame writes only its own region. A fence
+ * placed after a frame's commands guards its region, and beginFrame() waits for it before the
+ * region is reused, so data is never overwritten while the GPU may still read it.
+ *
+ * Allocations are plain offsets into the buffer they name, which can be bound to any target
+ * (glBindBufferRange for blocks, GL_DRAW_INDIRECT_BUFFER, glBindVertexBuffer). A frame that needs
+ * more than a region moves to a buffer twice the size; the old one lives on until no frame that
+ * used it can still be in flight, so allocations made before the move stay valid. Always bind an
+ * allocation's own buffer: buffer() may have changed since.
+ */
+
+const int RING_FRAMES = 3;
+const int RING_WAIT_LIMIT_MS = 1000;   // Longest beginFrame() waits for a region before giving up
+
+struct RingAllocation
+{
+    void* data;         // Write-only mapped memory
+    GLuint buffer;      // Buffer the allocation lives in
+    GLintptr offset;    // Offset in buffer
+};
+
+// Time beginFrame() spent waiting on fences and bytes written, since the last takeStats()
+struct RingStats
+{
+    double waitSeconds = 0.0;
+    size_t waits = 0;       // Frames that found their region still in use
+    size_t bytes = 0;
+};
+
+class DynamicRing
+{
+public:
+    DynamicRing() : ringBuffer(0), mapped(nullptr), regionBytes(0), region(0), cursor(0), frame(0)
+    {
+        for (GLsync& fence : fences)
+            fence = 0;
+    }
+
+    // Returns false when the buffer cannot be mapped; destroy() the ring and upload without it
+    bool create(size_t bytesPerFrame = 256 * 1024)
+    {
+        return allocateBuffer(bytesPerFrame);
+    }
+
+    void destroy()
+    {
+        for (GLsync& fence : fences)
+        {
+            if (fence)
+                glDeleteSync(fence);
+            fence = 0;
+        }
+        releaseBuffer(ringBuffer);
+        for (const Retired& retired : retiredBuffers)
+            releaseBuffer(retired.buffer);
+        retiredBuffers.clear();
+        ringBuffer = 0;
+        mapped = nullptr;
+    }
+
+    // Moves to the next region, first waiting until the GPU is done with its previous use
+    void beginFrame()
+    {
+        ++frame;
+        region = (region + 1) % RING_FRAMES;
+        cursor = 0;
+        waitFor(fences[region]);
+
+        // Buffers left by a resize are free once every frame that wrote to them has completed
+        for (size_t i = 0; i < retiredBuffers.size();)
+        {
+            if (retiredBuffers[i].lastFrame + RING_FRAMES <= frame)
+            {
+                releaseBuffer(retiredBuffers[i].buffer);
+                retiredBuffers[i] = retiredBuffers.back();
+                retiredBuffers.pop_back();
+            }
+            else
+                ++i;
+        }
+    }
+
+    // Fences the region after the frame's last command that reads from it
+    void endFrame()
+    {
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    // Space for bytes at an offset that is a multiple of alignment, in this frame's region; data
+    // is nullptr when the ring had to grow and could not, and the caller uploads another way
+    RingAllocation allocate(size_t bytes, size_t alignment)
+    {
+        size_t offset = (cursor + alignment - 1) / alignment * alignment;
+        if (offset + bytes > regionBytes)
+        {
+            if (!grow(bytes + alignment))
+            {
+                RingAllocation failed = { nullptr, 0, 0 };
+                return failed;
+            }
+            offset = 0;
+        }
+        cursor = offset + bytes;
+        stats.bytes += bytes;
+        size_t absolute = region * regionBytes + offset;
+        RingAllocation allocation = { mapped + absolute, ringBuffer, static_cast<GLintptr>(absolute) };
+        return allocation;
+    }
+
+    GLuint buffer() const { return ringBuffer; }
+
+    RingStats takeStats()
+    {
+        RingStats taken = stats;
+        stats = RingStats();
+        return taken;
+    }
+
+private:
+    // A buffer replaced by a larger one, and the last frame that wrote to it
+    struct Retired
+    {
+        GLuint buffer;
+        size_t lastFrame;
+    };
+
+    GLuint ringBuffer;
+    unsigned char* mapped;
+    size_t regionBytes;
+    size_t region;
+    size_t cursor;          // Bytes used in the current region
+    size_t frame;
+    GLsync fences[RING_FRAMES];
+    std::vector<Retired> retiredBuffers;
+    RingStats stats;
+
+    // Makes a mapped buffer of RING_FRAMES regions the current one; on failure the current
+    // buffer is left as it was
+    bool allocateBuffer(size_t bytesPerFrame)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(bytesPerFrame * RING_FRAMES), nullptr, flags);
+        void* data = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(bytesPerFrame * RING_FRAMES), flags);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        if (!data)
+        {
+            std::cout << "ERROR::DYNAMIC_RING::MAP_FAILED " << bytesPerFrame / 1024 << " KB per frame" << std::endl;
+            glDeleteBuffers(1, &buffer);
+            return false;
+        }
+        ringBuffer = buffer;
+        mapped = static_cast<unsigned char*>(data);
+        regionBytes = bytesPerFrame;
+        return true;
+    }
+
+    static void releaseBuffer(GLuint buffer)
+    {
+        if (!buffer)
+            return;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+    }
+
+    // Switches to a buffer with regions at least twice as large; the rest of this frame is
+    // written to its region, and no earlier region of it is in use yet. Returns false, keeping
+    // the current buffer, when the larger one cannot be mapped
+    bool grow(size_t minimumBytes)
+    {
+        size_t bytes = std::max<size_t>(regionBytes * 2, 1);
+        while (bytes < minimumBytes)
+            bytes *= 2;
+        GLuint previous = ringBuffer;
+        if (!allocateBuffer(bytes))
+            return false;
+        std::cout << "INFO: Dynamic ring grows to " << bytes / 1024 << " KB per frame" << std::endl;
+        Retired retired = { previous, frame };
+        retiredBuffers.push_back(retired);
+        for (GLsync& fence : fences)
+        {
+            if (fence)
+                glDeleteSync(fence);
+            fence = 0;
+        }
+        return true;
+    }
+
+    void waitFor(GLsync& fence)
+    {
+        if (!fence)
+            return;
+        double start = glfwGetTime();
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED)
+        {
+            ++stats.waits;
+            // Flush once, then wait in 1 ms steps up to RING_WAIT_LIMIT_MS, so a hung GPU or lost
+            // context stalls the loop for at most that long per frame instead of forever
+            GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+            int waited = 0;
+            do
+            {
+                result = glClientWaitSync(fence, flags, 1000000);
+                flags = 0;
+            } while (result == GL_TIMEOUT_EXPIRED && ++waited < RING_WAIT_LIMIT_MS);
+        }
+        stats.waitSeconds += glfwGetTime() - start;
+        if (result == GL_WAIT_FAILED)
+            std::cout << "ERROR::DYNAMIC_RING::WAIT_FAILED" << std::endl;
+        else if (result == GL_TIMEOUT_EXPIRED)
+            std::cout << "ERROR::DYNAMIC_RING::WAIT_TIMEOUT region reused after " << RING_WAIT_LIMIT_MS << " ms" << std::endl;
+        glDeleteSync(fence);
+        fence = 0;
+    }
+};
+#endif
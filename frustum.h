@@ -0,0 +1,93 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+
+// Six clip planes (left, right, bottom, top, near, far) with normals pointing inside.
+// A point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0.
+struct Frustum
+{
+    glm::vec4 planes[6];
+};
+
+// Extracts the world-space planes from projection * view (Gribb / Hartmann). Works for both
+// perspective and orthographic projections.
+inline Frustum UExtractFrustum(const glm::mat4& viewProjection)
+{
+    const glm::mat4& m = viewProjection;
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum;
+    frustum.planes[0] = row3 + row0;
+    frustum.planes[1] = row3 - row0;
+    frustum.planes[2] = row3 + row1;
+    frustum.planes[3] = row3 - row1;
+    frustum.planes[4] = row3 + row2;
+    frustum.planes[5] = row3 - row2;
+
+    // Normalize so plane distances are in world units and sphere radii can be compared directly
+    for (glm::vec4& plane : frustum.planes)
+        plane /= glm::length(glm::vec3(plane));
+    return frustum;
+}
+
+inline bool UFrustumContainsSphere(const Frustum& frustum, const glm::vec3& center, float radius)
+{
+    for (const glm::vec4& plane : frustum.planes)
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+            return false;
+    return true;
+}
+
+// Conservative box test: the box is rejected only when it lies fully behind one plane.
+// Each plane is checked against the box corner furthest along its normal.
+inline bool UFrustumContainsAabb(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max)
+{
+    for (const glm::vec4& plane : frustum.planes)
+    {
+        glm::vec3 farthest(plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z);
+        if (glm::dot(glm::vec3(plane), farthest) + plane.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+// World-space AABB enclosing a transformed local AABB (Arvo's method)
+inline void UTransformAabb(const glm::mat4& model, const glm::vec3& min, const glm::vec3& max, glm::vec3& outMin, glm::vec3& outMax)
+{
+    glm::vec3 center = glm::vec3(model * glm::vec4((min + max) * 0.5f, 1.0f));
+    glm::vec3 halfExtent = (max - min) * 0.5f;
+    glm::vec3 extent(0.0f);
+    for (int column = 0; column < 3; ++column)
+        extent += glm::abs(glm::vec3(model[column])) * halfExtent[column];
+    outMin = center - extent;
+    outMax = center + extent;
+}
+
+// Per-frame results of the object culling pass
+struct ObjectCullStats
+{
+    size_t visible;
+    size_t culled;
+};
+
+// Tests an object's local bounds, placed by model, against the frustum: the cheap sphere test
+// rejects most off-screen objects and the tighter world AABB test catches the rest.
+// model may contain non-uniform scale.
+inline bool UFrustumContainsObject(const Frustum& frustum, const glm::mat4& model,
+    const glm::vec3& min, const glm::vec3& max, const glm::vec3& center, float radius)
+{
+    float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    if (!UFrustumContainsSphere(frustum, glm::vec3(model * glm::vec4(center, 1.0f)), radius * scale))
+        return false;
+
+    glm::vec3 worldMin, worldMax;
+    UTransformAabb(model, min, max, worldMin, worldMax);
+    return UFrustumContainsAabb(frustum, worldMin, worldMax);
+}
+#endif
@@ -0,0 +1,334 @@
+#ifndef FRUSTUM_SIMD_H
+#define FRUSTUM_SIMD_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The widest kernel the compiler targets is used: AVX2 when built with /arch:AVX2 or -mavx2,
+// SSE2 on any x86-64 build, plain C++ elsewhere
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FRUSTUM_SIMD_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_SIMD_SSE
+#endif
+
+#include "frustum.h"
+
+// World-space bounds of many objects as separate component arrays, so one load fetches the
+// same component of 4 or 8 objects. Spheres and boxes are independent; fill the ones you cull with.
+struct CullBoundsSoA
+{
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    size_t size() const { return centerX.size(); }
+
+    void resize(size_t count)
+    {
+        std::vector<float>* arrays[] = { &centerX, &centerY, &centerZ, &radius, &minX, &minY, &minZ, &maxX, &maxY, &maxZ };
+        for (std::vector<float>* array : arrays)
+            array->resize(count);
+    }
+
+    void setSphere(size_t i, const glm::vec3& center, float r)
+    {
+        centerX[i] = center.x;
+        centerY[i] = center.y;
+        centerZ[i] = center.z;
+        radius[i] = r;
+    }
+
+    void setAabb(size_t i, const glm::vec3& min, const glm::vec3& max)
+    {
+        minX[i] = min.x;
+        minY[i] = min.y;
+        minZ[i] = min.z;
+        maxX[i] = max.x;
+        maxY[i] = max.y;
+        maxZ[i] = max.z;
+    }
+};
+
+namespace frustumsimd
+{
+    inline bool sphereVisible(const Frustum& frustum, const CullBoundsSoA& bounds, size_t i)
+    {
+        for (const glm::vec4& plane : frustum.planes)
+            if (plane.x * bounds.centerX[i] + plane.y * bounds.centerY[i] + plane.z * bounds.centerZ[i] + plane.w < -bounds.radius[i])
+                return false;
+        return true;
+    }
+
+    inline bool aabbVisible(const Frustum& frustum, const CullBoundsSoA& bounds, size_t i)
+    {
+        for (const glm::vec4& plane : frustum.planes)
+        {
+            float x = plane.x >= 0.0f ? bounds.maxX[i] : bounds.minX[i];
+            float y = plane.y >= 0.0f ? bounds.maxY[i] : bounds.minY[i];
+            float z = plane.z >= 0.0f ? bounds.maxZ[i] : bounds.minZ[i];
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    // Branch-free compaction of 4 lanes: stores the set lanes' indices first, then garbage up to 4 entries;
+    // visible needs room for 4 entries past written
+    inline size_t compact4(uint32_t* visible, size_t written, uint32_t base, int mask)
+    {
+        // Set lanes of each 4-bit mask packed 2 bits each, and their count in bits 8-10
+        static const uint16_t table[16] = { 0x000, 0x100, 0x101, 0x204, 0x102, 0x208, 0x209, 0x324,
+                                            0x103, 0x20C, 0x20D, 0x334, 0x20E, 0x338, 0x339, 0x4E4 };
+        uint32_t entry = table[mask];
+        visible[written] = base + (entry & 3);
+        visible[written + 1] = base + ((entry >> 2) & 3);
+        visible[written + 2] = base + ((entry >> 4) & 3);
+        visible[written + 3] = base + ((entry >> 6) & 3);
+        return written + (entry >> 8);
+    }
+
+    // For every plane, the array holding the box corner furthest along the plane normal
+    inline void farthestCorner(const CullBoundsSoA& bounds, const glm::vec4& plane, const float*& x, const float*& y, const float*& z)
+    {
+        x = plane.x >= 0.0f ? bounds.maxX.data() : bounds.minX.data();
+        y = plane.y >= 0.0f ? bounds.maxY.data() : bounds.minY.data();
+        z = plane.z >= 0.0f ? bounds.maxZ.data() : bounds.minZ.data();
+    }
+}
+
+
+// Writes the indices of the spheres in [first, first + count) that intersect the frustum to
+// visible, which must have room for count entries, and returns how many were written
+inline size_t UCullSpheresScalar(const Frustum& frustum, const CullBoundsSoA& bounds, size_t first, size_t count, uint32_t* visible)
+{
+    size_t written = 0;
+    for (size_t i = first; i < first + count; ++i)
+    {
+        visible[written] = static_cast<uint32_t>(i);
+        written += frustumsimd::sphereVisible(frustum, bounds, i) ? 1 : 0;
+    }
+    return written;
+}
+
+inline size_t UCullAabbsScalar(const Frustum& frustum, const CullBoundsSoA& bounds, size_t first, size_t count, uint32_t* visible)
+{
+    size_t written = 0;
+    for (size_t i = first; i < first + count; ++i)
+    {
+        visible[written] = static_cast<uint32_t>(i);
+        written += frustumsimd::aabbVisible(frustum, bounds, i) ? 1 : 0;
+    }
+    return written;
+}
+
+
+#ifdef FRUSTUM_SIMD_SSE
+// 4 objects per iteration with SSE2
+inline size_t UCullSpheresSse(const Frustum& frustum, const CullBoundsSoA& bounds, size_t first, size_t count, uint32_t* visible)
+{
+    __m128 planes[6][4];
+    for (int p = 0; p < 6; ++p)
+        for (int c = 0; c < 4; ++c)
+            planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+
+    size_t end = first + count;
+    size_t written = 0;
+    size_t i = first;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(bounds.centerX.data() + i);
+        __m128 y = _mm_loadu_ps(bounds.centerY.data() + i);
+        __m128 z = _mm_loadu_ps(bounds.centerZ.data() + i);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(bounds.radius.data() + i));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[p][0], x), _mm_mul_ps(planes[p][1], y)),
+                _mm_add_ps(_mm_mul_ps(planes[p][2], z), planes[p][3]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+        written = frustumsimd::compact4(visible, written, static_cast<uint32_t>(i), _mm_movemask_ps(inside));
+    }
+    return written + UCullSpheresScalar(frustum, bounds, i, end - i, visible + written);
+}
+
+inline size_t UCullAabbsSse(const Frustum& frustum, const CullBoundsSoA& bounds, size_t first, size_t count, uint32_t* visible)
+{
+    __m128 planes[6][4];
+    const float* corner[6][3];
+    for (int p = 0; p < 6; ++p)
+    {
+        for (int c = 0; c < 4; ++c)
+            planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+        frustumsimd::farthestCorner(bounds, frustum.planes[p], corner[p][0], corner[p][1], corner[p][2]);
+    }
+
+    size_t end = first + count;
+    size_t written = 0;
+    size_t i = first;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p)
+        {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(planes[p][0], _mm_loadu_ps(corner[p][0] + i)), _mm_mul_ps(planes[p][1], _mm_loadu_ps(corner[p][1] + i))),
+                _mm_add_ps(_mm_mul_ps(planes[p][2], _mm_loadu_ps(corner[p][2] + i)), planes[p][3]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+        }
+        written = frustumsimd::compact4(visible, written, static_cast<uint32_t>(i), _mm_movemask_ps(inside));
+    }
+    return written + UCullAabbsScalar(frustum, bounds, i, end - i, visible + written);
+}
+#endif
+
+
+#ifdef FRUSTUM_SIMD_AVX2
+namespace frustumsimd
+{
+    // Signed distance of 8 points to one plane, fused when the target has FMA
+    inline __m256 planeDistance8(const __m256* plane, __m256 x, __m256 y, __m256 z)
+    {
+#ifdef __FMA__
+        return _mm256_fmadd_ps(plane[0], x, _mm256_fmadd_ps(plane[1], y, _mm256_fmadd_ps(plane[2], z, plane[3])));
+#else
+        return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane[0], x), _mm256_mul_ps(plane[1], y)),
+            _mm256_add_ps(_mm256_mul_ps(plane[2], z), plane[3]));
+#endif
+    }
+
+    // For every 8-bit lane mask: the indices of its set lanes packed 3 bits each, and their count in bits 24-27
+    inline const uint32_t* compactTable()
+    {
+        struct Table
+        {
+            uint32_t entries[256];
+            Table()
+            {
+                for (uint32_t mask = 0; mask < 256; ++mask)
+                {
+                    uint32_t packed = 0, count = 0;
+                    for (uint32_t lane = 0; lane < 8; ++lane)
+                        if (mask & (1u << lane))
+                            packed |= lane << (3 * count++);
+                    entries[mask] = packed | (count << 24);
+                }
+            }
+        };
+        static const Table table;
+        return table.entries;
+    }
+
+    // Branch-free compaction of 8 lanes: shuffles the visible indices to the front and stores all 8;
+    // visible needs room for 8 entries past written
+    inline size_t compact8(const uint32_t* table, uint32_t* visible, size_t written, uint32_t base, int mask)
+    {
+        uint32_t entry = table[mask];
+        __m256i lanes = _mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(entry)), _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21));
+        lanes = _mm256_and_si256(lanes, _mm256_set1_epi32(7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(visible + written), _mm256_add_epi32(lanes, _mm256_set1_epi32(static_cast<int>(base))));
+        return written + (entry >> 24);
+    }
+}
+
+// 8 objects per iteration with AVX2
+inline size_t UCullSpheresAvx2(const Frustum& frustum, const CullBoundsSoA& bounds, size_t first, size_t count, uint32_t* visible)
+{
+    __m256 planes[6][4];
+    for (int p = 0; p < 6; ++p)
+        for (int c = 0; c < 4; ++c)
+            planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+
+    const uint32_t* table = frustumsimd::compactTable();
+    size_t end = first + count;
+    size_t written = 0;
+    size_t i = first;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(bounds.centerX.data() + i);
+        __m256 y = _mm256_loadu_ps(bounds.centerY.data() + i);
+        __m256 z = _mm256_loadu_ps(bounds.centerZ.data() + i);
+        __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(bounds.radius.data() + i));
+
+        // Only the smallest signed distance matters, so track a running minimum and compare once
+        __m256 nearest = frustumsimd::planeDistance8(planes[0], x, y, z);
+        for (int p = 1; p < 6; ++p)
+            nearest = _mm256_min_ps(nearest, frustumsimd::planeDistance8(planes[p], x, y, z));
+        __m256 inside = _mm256_cmp_ps(nearest, negativeRadius, _CMP_GE_OQ);
+        written = frustumsimd::compact8(table, visible, written, static_cast<uint32_t>(i), _mm256_movemask_ps(inside));
+    }
+    return written + UCullSpheresScalar(frustum, bounds, i, end - i, visible + written);
+}
+
+inline size_t UCullAabbsAvx2(const Frustum& frustum, const CullBoundsSoA& bounds, size_t first, size_t count, uint32_t* visible)
+{
+    __m256 planes[6][4];
+    const float* corner[6][3];
+    for (int p = 0; p < 6; ++p)
+    {
+        for (int c = 0; c < 4; ++c)
+            planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+        frustumsimd::farthestCorner(bounds, frustum.planes[p], corner[p][0], corner[p][1], corner[p][2]);
+    }
+
+    const uint32_t* table = frustumsimd::compactTable();
+    size_t end = first + count;
+    size_t written = 0;
+    size_t i = first;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 nearest = frustumsimd::planeDistance8(planes[0],
+            _mm256_loadu_ps(corner[0][0] + i), _mm256_loadu_ps(corner[0][1] + i), _mm256_loadu_ps(corner[0][2] + i));
+        for (int p = 1; p < 6; ++p)
+            nearest = _mm256_min_ps(nearest, frustumsimd::planeDistance8(planes[p],
+                _mm256_loadu_ps(corner[p][0] + i), _mm256_loadu_ps(corner[p][1] + i), _mm256_loadu_ps(corner[p][2] + i)));
+        __m256 inside = _mm256_cmp_ps(nearest, _mm256_setzero_ps(), _CMP_GE_OQ);
+        written = frustumsimd::compact8(table, visible, written, static_cast<uint32_t>(i), _mm256_movemask_ps(inside));
+    }
+    return written + UCullAabbsScalar(frustum, bounds, i, end - i, visible + written);
+}
+#endif
+
+
+// Name of the kernel UCullSpheres / UCullAabbs run with in this build
+inline const char* UFrustumSimdPath()
+{
+#if defined(FRUSTUM_SIMD_AVX2)
+    return "AVX2";
+#elif defined(FRUSTUM_SIMD_SSE)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+// Culls with the widest kernel this build has
+inline size_t UCullSpheres(const Frustum& frustum, const CullBoundsSoA& bounds, size_t first, size_t count, uint32_t* visible)
+{
+#if defined(FRUSTUM_SIMD_AVX2)
+    return UCullSpheresAvx2(frustum, bounds, first, count, visible);
+#elif defined(FRUSTUM_SIMD_SSE)
+    return UCullSpheresSse(frustum, bounds, first, count, visible);
+#else
+    return UCullSpheresScalar(frustum, bounds, first, count, visible);
+#endif
+}
+
+inline size_t UCullAabbs(const Frustum& frustum, const CullBoundsSoA& bounds, size_t first, size_t count, uint32_t* visible)
+{
+#if defined(FRUSTUM_SIMD_AVX2)
+    return UCullAabbsAvx2(frustum, bounds, first, count, visible);
+#elif defined(FRUSTUM_SIMD_SSE)
+    return UCullAabbsSse(frustum, bounds, first, count, visible);
+#else
+    return UCullAabbsScalar(frustum, bounds, first, count, visible);
+#endif
+}
+#endif
@@ -0,0 +1,323 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <include/GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <iostream>
+
+/* Shadow copy of the GL state the render loop changes: program, VAO, textures per unit, a few
+ * enable bits, the depth function, the depth and color write masks and the clear values. Calls
+ * that would set what is already current are dropped.
+ *
+ * Every tracked value starts unknown, and invalidate() makes it unknown again; call it after code
+ * that changes state behind the cache's back. In debug mode each dropped call first checks the
+ * value it relies on against glGet*, and verify() compares the whole shadow state, so desyncs are
+ * reported where they happen instead of as wrong bindings later.
+ */
+
+namespace glstate
+{
+    // Texture targets tracked per unit, with their binding queries
+    const int TEXTURE_TARGETS = 2;
+    const GLenum TARGETS[TEXTURE_TARGETS] = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY };
+    const GLenum BINDINGS[TEXTURE_TARGETS] = { GL_TEXTURE_BINDING_2D, GL_TEXTURE_BINDING_2D_ARRAY };
+
+    // Capabilities whose enable bit is tracked; others are passed through
+    const int CAPABILITIES = 4;
+    const GLenum CAPS[CAPABILITIES] = { GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_SCISSOR_TEST };
+
+    const GLuint UNKNOWN = 0xffffffffu;
+    const int UNKNOWN_ENABLE = -1;
+}
+
+// Calls that reached the driver and calls dropped as redundant
+struct GLStateStats
+{
+    size_t issued = 0;
+    size_t skipped = 0;
+};
+
+class GLStateCache
+{
+public:
+    static const GLuint TEXTURE_UNITS = 16;    // Units past this are passed through untracked
+
+    GLStateCache() : debug(false) { invalidate(); }
+
+    // Forgets everything; the next call of each kind reaches the driver
+    void invalidate()
+    {
+        using namespace glstate;
+        program = UNKNOWN;
+        vertexArray = UNKNOWN;
+        activeUnit = UNKNOWN;
+        for (GLuint unit = 0; unit < TEXTURE_UNITS; ++unit)
+            for (int target = 0; target < TEXTURE_TARGETS; ++target)
+                textures[unit][target] = UNKNOWN;
+        for (int cap = 0; cap < CAPABILITIES; ++cap)
+            enabled[cap] = UNKNOWN_ENABLE;
+        depthFunction = UNKNOWN;
+        depthWrite = UNKNOWN_ENABLE;
+        colorWrite = UNKNOWN_ENABLE;
+        clearColorKnown = false;
+        clearDepthKnown = false;
+    }
+
+    void setDebug(bool enabled) { debug = enabled; }
+
+    void useProgram(GLuint newProgram)
+    {
+        if (newProgram == program && check(GL_CURRENT_PROGRAM, program, "program"))
+            return skip();
+        glUseProgram(newProgram);
+        program = newProgram;
+        issue();
+    }
+
+    void bindVertexArray(GLuint newVertexArray)
+    {
+        if (newVertexArray == vertexArray && check(GL_VERTEX_ARRAY_BINDING, vertexArray, "VAO"))
+            return skip();
+        glBindVertexArray(newVertexArray);
+        vertexArray = newVertexArray;
+        issue();
+    }
+
+    // Binds texture to target on the unit, selecting the unit only if that bind is needed
+    void bindTexture(GLuint unit, GLenum target, GLuint texture)
+    {
+        int targetIndex = targetSlot(target);
+        if (unit >= TEXTURE_UNITS || targetIndex < 0)
+        {
+            activeTexture(unit);
+            glBindTexture(target, texture);
+            issue();
+            return;
+        }
+        GLuint& bound = textures[unit][targetIndex];
+        if (texture == bound && checkTexture(unit, target, bound))
+            return skip();
+        activeTexture(unit);
+        glBindTexture(target, texture);
+        bound = texture;
+        issue();
+    }
+
+    void enable(GLenum cap) { setEnabled(cap, true); }
+    void disable(GLenum cap) { setEnabled(cap, false); }
+
+    void depthFunc(GLenum function)
+    {
+        if (function == depthFunction && check(GL_DEPTH_FUNC, depthFunction, "depth function"))
+            return skip();
+        glDepthFunc(function);
+        depthFunction = function;
+        issue();
+    }
+
+    void depthMask(bool write)
+    {
+        if (depthWrite == static_cast<int>(write) && checkDepthMask())
+            return skip();
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+        depthWrite = write;
+        issue();
+    }
+
+    // All four channels together, as the depth pre-pass needs them
+    void colorMask(bool write)
+    {
+        if (colorWrite == static_cast<int>(write) && checkColorMask())
+            return skip();
+        GLboolean value = write ? GL_TRUE : GL_FALSE;
+        glColorMask(value, value, value, value);
+        colorWrite = write;
+        issue();
+    }
+
+    void clearColor(const glm::vec4& color)
+    {
+        if (clearColorKnown && color == clearColorValue && checkClearColor())
+            return skip();
+        glClearColor(color.r, color.g, color.b, color.a);
+        clearColorValue = color;
+        clearColorKnown = true;
+        issue();
+    }
+
+    void clearDepth(GLfloat depth)
+    {
+        if (clearDepthKnown && depth == clearDepthValue && checkClearDepth())
+            return skip();
+        glClearDepth(depth);
+        clearDepthValue = depth;
+        clearDepthKnown = true;
+        issue();
+    }
+
+    // Compares every known shadow value with the driver's; returns false and forgets the state
+    // after reporting any mismatch
+    bool verify()
+    {
+        using namespace glstate;
+        bool synced = check(GL_CURRENT_PROGRAM, program, "program", true)
+            & check(GL_VERTEX_ARRAY_BINDING, vertexArray, "VAO", true)
+            & (activeUnit == UNKNOWN || check(GL_ACTIVE_TEXTURE, GL_TEXTURE0 + activeUnit, "active texture unit", true))
+            & (!clearColorKnown || checkClearColor(true))
+            & (!clearDepthKnown || checkClearDepth(true))
+            & check(GL_DEPTH_FUNC, depthFunction, "depth function", true)
+            & (depthWrite == UNKNOWN_ENABLE || checkDepthMask(true))
+            & (colorWrite == UNKNOWN_ENABLE || checkColorMask(true));
+        for (int cap = 0; cap < CAPABILITIES; ++cap)
+            if (enabled[cap] != UNKNOWN_ENABLE)
+                synced &= checkEnabled(cap, true);
+        for (GLuint unit = 0; unit < TEXTURE_UNITS; ++unit)
+            for (int target = 0; target < TEXTURE_TARGETS; ++target)
+                if (textures[unit][target] != UNKNOWN)
+                    synced &= checkTexture(unit, TARGETS[target], textures[unit][target], true);
+
+        if (!synced)
+            invalidate();
+        return synced;
+    }
+
+    // Counters since the last call
+    GLStateStats takeStats()
+    {
+        GLStateStats taken = stats;
+        stats = GLStateStats();
+        return taken;
+    }
+
+private:
+    GLuint program;
+    GLuint vertexArray;
+    GLuint activeUnit;
+    GLuint textures[TEXTURE_UNITS][glstate::TEXTURE_TARGETS];
+    int enabled[glstate::CAPABILITIES];
+    GLuint depthFunction;
+    int depthWrite;
+    int colorWrite;
+    glm::vec4 clearColorValue;
+    GLfloat clearDepthValue;
+    bool clearColorKnown;
+    bool clearDepthKnown;
+    bool debug;
+    GLStateStats stats;
+
+    void issue() { ++stats.issued; }
+    void skip() { ++stats.skipped; }
+
+    static int targetSlot(GLenum target)
+    {
+        using namespace glstate;
+        for (int i = 0; i < TEXTURE_TARGETS; ++i)
+            if (TARGETS[i] == target)
+                return i;
+        return -1;
+    }
+
+    void activeTexture(GLuint unit)
+    {
+        if (unit == activeUnit && check(GL_ACTIVE_TEXTURE, GL_TEXTURE0 + activeUnit, "active texture unit"))
+            return skip();
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+        issue();
+    }
+
+    void setEnabled(GLenum cap, bool on)
+    {
+        int slot = -1;
+        for (int i = 0; i < glstate::CAPABILITIES; ++i)
+            if (glstate::CAPS[i] == cap)
+                slot = i;
+        if (slot >= 0 && enabled[slot] == static_cast<int>(on) && checkEnabled(slot))
+            return skip();
+        if (on)
+            glEnable(cap);
+        else
+            glDisable(cap);
+        if (slot >= 0)
+            enabled[slot] = on;
+        issue();
+    }
+
+    // The debug checks below pass without querying unless debug mode is on or always is set; a
+    // mismatch is reported and makes the caller issue the call after all
+    bool report(bool synced, const char* what) const
+    {
+        if (!synced)
+            std::cout << "ERROR::GL_STATE::DESYNC " << what << " differs from the cached value" << std::endl;
+        return synced;
+    }
+
+    bool check(GLenum name, GLuint expected, const char* what, bool always = false) const
+    {
+        if ((!debug && !always) || expected == glstate::UNKNOWN)
+            return true;
+        GLint actual = 0;
+        glGetIntegerv(name, &actual);
+        return report(static_cast<GLuint>(actual) == expected, what);
+    }
+
+    bool checkTexture(GLuint unit, GLenum target, GLuint expected, bool always = false)
+    {
+        if (!debug && !always)
+            return true;
+        GLint current = 0, actual = 0;
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &current);
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glGetIntegerv(glstate::BINDINGS[targetSlot(target)], &actual);
+        glActiveTexture(static_cast<GLenum>(current));
+        return report(static_cast<GLuint>(actual) == expected, "texture binding");
+    }
+
+    bool checkEnabled(int slot, bool always = false) const
+    {
+        if (!debug && !always)
+            return true;
+        return report(static_cast<int>(glIsEnabled(glstate::CAPS[slot]) == GL_TRUE) == enabled[slot], "enable bit");
+    }
+
+    bool checkDepthMask(bool always = false) const
+    {
+        if (!debug && !always)
+            return true;
+        GLboolean actual = GL_FALSE;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &actual);
+        return report(static_cast<int>(actual == GL_TRUE) == depthWrite, "depth write mask");
+    }
+
+    bool checkColorMask(bool always = false) const
+    {
+        if (!debug && !always)
+            return true;
+        GLboolean actual[4] = {};
+        glGetBooleanv(GL_COLOR_WRITEMASK, actual);
+        bool all = actual[0] == GL_TRUE && actual[1] == GL_TRUE && actual[2] == GL_TRUE && actual[3] == GL_TRUE;
+        bool none = actual[0] == GL_FALSE && actual[1] == GL_FALSE && actual[2] == GL_FALSE && actual[3] == GL_FALSE;
+        return report(colorWrite ? all : none, "color write mask");
+    }
+
+    bool checkClearColor(bool always = false) const
+    {
+        if (!debug && !always)
+            return true;
+        glm::vec4 actual;
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, &actual.r);
+        return report(actual == clearColorValue, "clear color");
+    }
+
+    bool checkClearDepth(bool always = false) const
+    {
+        if (!debug && !always)
+            return true;
+        GLfloat actual = 0.0f;
+        glGetFloatv(GL_DEPTH_CLEAR_VALUE, &actual);
+        return report(actual == clearDepthValue, "clear depth");
+    }
+};
+#endif
@@ -0,0 +1,358 @@
+#ifndef INDIRECT_DRAW_H
+#define INDIRECT_DRAW_H
+
+#include <include/GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "dynamic_ring.h"
+#include "mesh_registry.h"
+#include "object_transforms.h"
+
+/* Multi-draw indirect submission. Every draw becomes a command in a GL_DRAW_INDIRECT_BUFFER plus
+ * a DrawObject record in a shader storage buffer; the vertex shader reads its record with
+ * gl_BaseInstanceARB (GL_ARB_shader_draw_parameters), which each command sets to its record's index:
+ *
+ *   struct DrawObject { mat4 model; mat4 modelViewProjection; mat3 normalMatrix; vec4 highlightColor;
+ *                       vec4 uvScale; uvec4 material; };
+ *   layout(std430, binding = 2) readonly buffer DrawObjects { DrawObject objects[]; };
+ *
+ * One glMultiDrawElementsIndirect call covers all draws that share a vertex layout and index type,
+ * which for a scene of float meshes is a single call. Record indices start at 0 in every batch, so
+ * each batch's records are bound as their own range of the storage buffer. An object drawn as
+ * meshlets keeps one record that all its meshlet commands point at.
+ *
+ * With a DynamicRing set, commands and records are written straight into its frame region and
+ * drawn from there, without the staging copy.
+ *
+ * Draws are queued with their view depth, and sortFrontToBack() reorders each batch by it before
+ * the upload, so a multi-draw call lets early depth testing reject what earlier draws cover.
+ *
+ * Every command has a twin addressing the mesh's position-only stream (mesh_registry.h), uploaded
+ * after the batch's commands, so a depth pass draws the same batch with draw(meshes, VERTEX_STREAM_POSITION).
+ */
+
+const GLuint DRAW_OBJECTS_BINDING = 2;
+
+// Layout of glMultiDrawElementsIndirect's commands
+struct DrawElementsCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+static_assert(sizeof(DrawElementsCommand) == 20, "Indirect commands must be tightly packed");
+
+// std430 mirror of the shader's DrawObject
+struct DrawObject
+{
+    glm::mat4 model;            // Includes the mesh's position dequantization
+    ObjectTransform transform;  // Filled from model by computeTransforms()
+    glm::vec4 highlightColor;   // w unused
+    glm::vec4 uvScale;          // zw unused
+    GLuint material[4];         // x: texture array layer, y: texture array; zw unused
+};
+static_assert(offsetof(DrawObject, transform) == 64, "DrawObject layout must match std430");
+static_assert(offsetof(DrawObject, highlightColor) == 176, "DrawObject layout must match std430");
+static_assert(offsetof(DrawObject, material) == 208, "DrawObject layout must match std430");
+static_assert(sizeof(DrawObject) == 224, "DrawObject layout must match std430");
+
+class IndirectDraws
+{
+public:
+    IndirectDraws() : commandBuffer(0), objectBuffer(0), commandCapacity(0), objectCapacity(0), objectAlignment(1),
+        ring(nullptr), commandSource(0), objectSource(0), commandBase(0), objectBase(0) {}
+
+    void create()
+    {
+        GLint alignment = 256;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        objectAlignment = static_cast<size_t>(alignment);
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &objectBuffer);
+    }
+
+    void destroy()
+    {
+        glDeleteBuffers(1, &commandBuffer);
+        glDeleteBuffers(1, &objectBuffer);
+        commandBuffer = objectBuffer = 0;
+        commandCapacity = objectCapacity = 0;
+    }
+
+    void setRing(DynamicRing* dynamicRing) { ring = dynamicRing; }
+
+    void clear()
+    {
+        for (Batch& batch : batches)
+        {
+            batch.commands.clear();
+            batch.positionCommands.clear();
+            batch.objects.clear();
+            batch.depths.clear();
+            batch.objectCommands.clear();
+        }
+    }
+
+    // Queues a whole registered mesh; depth is its view depth, for sortFrontToBack()
+    void add(const MeshRegistry& meshes, GLuint handle, const DrawObject& object, float depth = 0.0f)
+    {
+        const GLMesh& mesh = meshes.mesh(handle);
+        Batch& batch = batchFor(mesh.layout, mesh.indexType);
+        GLuint record = addObject(batch, object, depth, 1);
+        DrawElementsCommand command = { static_cast<GLuint>(mesh.nIndices), 1, mesh.firstIndex, mesh.baseVertex, record };
+        DrawElementsCommand positionCommand = { command.count, 1, mesh.positionFirstIndex, mesh.positionBaseVertex, record };
+        batch.commands.push_back(command);
+        batch.positionCommands.push_back(positionCommand);
+    }
+
+    // Queues the listed meshlets of a clustered mesh, one command each sharing the object's record
+    void addMeshlets(const MeshRegistry& meshes, GLuint handle, const std::vector<GLuint>& visible, const DrawObject& object, float depth = 0.0f)
+    {
+        if (visible.empty())
+            return;
+        const GLMesh& mesh = meshes.mesh(handle);
+        Batch& batch = batchFor(mesh.layout, mesh.indexType);
+        GLuint record = addObject(batch, object, depth, static_cast<GLuint>(visible.size()));
+        for (GLuint index : visible)
+        {
+            const Meshlet& meshlet = meshes.allMeshlets()[index];
+            DrawElementsCommand command = { meshlet.triangleCount * 3, 1, mesh.firstIndex + meshlet.firstIndex, mesh.baseVertex, record };
+            DrawElementsCommand positionCommand = { command.count, 1, mesh.positionFirstIndex + meshlet.firstIndex, mesh.positionBaseVertex, record };
+            batch.commands.push_back(command);
+            batch.positionCommands.push_back(positionCommand);
+        }
+    }
+
+    // Orders each batch's records nearest first and their commands with them; meshlets of one
+    // object keep their order
+    void sortFrontToBack()
+    {
+        for (Batch& batch : batches)
+        {
+            size_t count = batch.objects.size();
+            order.resize(count);
+            for (size_t i = 0; i < count; ++i)
+                order[i] = static_cast<GLuint>(i);
+            std::stable_sort(order.begin(), order.end(), [&](GLuint a, GLuint b) { return batch.depths[a] < batch.depths[b]; });
+
+            sortedCommands.resize(batch.commands.size());
+            sortedPositionCommands.resize(batch.positionCommands.size());
+            sortedObjects.resize(count);
+            sortedDepths.resize(count);
+            sortedObjectCommands.resize(count);
+            GLuint next = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const CommandRange& range = batch.objectCommands[order[i]];
+                for (GLuint k = 0; k < range.count; ++k)
+                {
+                    sortedCommands[next + k] = batch.commands[range.first + k];
+                    sortedCommands[next + k].baseInstance = static_cast<GLuint>(i);
+                    sortedPositionCommands[next + k] = batch.positionCommands[range.first + k];
+                    sortedPositionCommands[next + k].baseInstance = static_cast<GLuint>(i);
+                }
+                sortedObjects[i] = batch.objects[order[i]];
+                sortedDepths[i] = batch.depths[order[i]];
+                sortedObjectCommands[i] = { next, range.count };
+                next += range.count;
+            }
+            batch.commands.swap(sortedCommands);
+            batch.positionCommands.swap(sortedPositionCommands);
+            batch.objects.swap(sortedObjects);
+            batch.depths.swap(sortedDepths);
+            batch.objectCommands.swap(sortedObjectCommands);
+        }
+    }
+
+    // Derives every queued record's MVP and normal matrix from its model, a batch at a time
+    ObjectTransformStats computeTransforms(const glm::mat4& viewProjection)
+    {
+        ObjectTransformStats stats;
+        for (Batch& batch : batches)
+        {
+            ObjectTransformStats batchStats = UComputeObjectTransforms(viewProjection, batch.objects.data(), sizeof(DrawObject), batch.objects.size());
+            stats.rigid += batchStats.rigid;
+            stats.general += batchStats.general;
+        }
+        return stats;
+    }
+
+    // Uploads every batch's commands and records with one call per buffer
+    void upload()
+    {
+        size_t commands = 0, objectBytes = 0;
+        for (Batch& batch : batches)
+        {
+            batch.commandOffset = commands * sizeof(DrawElementsCommand);
+            batch.positionCommandOffset = batch.commandOffset + batch.commands.size() * sizeof(DrawElementsCommand);
+            batch.objectOffset = objectBytes;
+            commands += batch.commands.size() * 2;
+            objectBytes += (batch.objects.size() * sizeof(DrawObject) + objectAlignment - 1) / objectAlignment * objectAlignment;
+        }
+        if (commands == 0)
+            return;
+
+        if (ring)
+        {
+            RingAllocation commandAllocation = ring->allocate(commands * sizeof(DrawElementsCommand), sizeof(DrawElementsCommand));
+            RingAllocation objectAllocation = ring->allocate(objectBytes, objectAlignment);
+            if (commandAllocation.data && objectAllocation.data)
+            {
+                for (const Batch& batch : batches)
+                {
+                    if (batch.commands.empty())
+                        continue;
+                    std::memcpy(static_cast<unsigned char*>(commandAllocation.data) + batch.commandOffset, batch.commands.data(),
+                        batch.commands.size() * sizeof(DrawElementsCommand));
+                    std::memcpy(static_cast<unsigned char*>(commandAllocation.data) + batch.positionCommandOffset, batch.positionCommands.data(),
+                        batch.positionCommands.size() * sizeof(DrawElementsCommand));
+                    std::memcpy(static_cast<unsigned char*>(objectAllocation.data) + batch.objectOffset, batch.objects.data(),
+                        batch.objects.size() * sizeof(DrawObject));
+                }
+                // The object allocation may have grown the ring, so each range uses its own buffer
+                commandSource = commandAllocation.buffer;
+                objectSource = objectAllocation.buffer;
+                commandBase = commandAllocation.offset;
+                objectBase = objectAllocation.offset;
+                return;
+            }
+            // The ring could not grow: this frame goes through the own buffers
+        }
+        commandSource = commandBuffer;
+        objectSource = objectBuffer;
+        commandBase = objectBase = 0;
+
+        commandStaging.resize(commands);
+        objectStaging.resize(objectBytes);
+        for (const Batch& batch : batches)
+        {
+            std::copy(batch.commands.begin(), batch.commands.end(), commandStaging.begin() + batch.commandOffset / sizeof(DrawElementsCommand));
+            std::copy(batch.positionCommands.begin(), batch.positionCommands.end(),
+                commandStaging.begin() + batch.positionCommandOffset / sizeof(DrawElementsCommand));
+            if (!batch.objects.empty())
+                std::memcpy(objectStaging.data() + batch.objectOffset, batch.objects.data(), batch.objects.size() * sizeof(DrawObject));
+        }
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        if (commands * sizeof(DrawElementsCommand) > commandCapacity)
+        {
+            commandCapacity = commands * sizeof(DrawElementsCommand) * 2;
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(commandCapacity), nullptr, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, static_cast<GLsizeiptr>(commands * sizeof(DrawElementsCommand)), commandStaging.data());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+        if (objectBytes > objectCapacity)
+        {
+            objectCapacity = objectBytes * 2;
+            glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(objectCapacity), nullptr, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(objectBytes), objectStaging.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // Issues one glMultiDrawElementsIndirect per non-empty batch with the program and textures
+    // already bound; returns the number of calls
+    size_t draw(MeshRegistry& meshes, VertexStream stream = VERTEX_STREAM_FULL) const
+    {
+        size_t calls = 0;
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandSource);
+        for (const Batch& batch : batches)
+        {
+            if (batch.commands.empty())
+                continue;
+            size_t commandOffset = stream == VERTEX_STREAM_POSITION ? batch.positionCommandOffset : batch.commandOffset;
+            meshes.bind(batch.layout, stream);
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_OBJECTS_BINDING, objectSource, objectBase + static_cast<GLintptr>(batch.objectOffset),
+                static_cast<GLsizeiptr>(batch.objects.size() * sizeof(DrawObject)));
+            glMultiDrawElementsIndirect(GL_TRIANGLES, batch.indexType, (const void*)(commandBase + commandOffset),
+                static_cast<GLsizei>(batch.commands.size()), 0);
+            ++calls;
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        return calls;
+    }
+
+    size_t commandCount() const
+    {
+        size_t count = 0;
+        for (const Batch& batch : batches)
+            count += batch.commands.size();
+        return count;
+    }
+
+private:
+    // Commands of one record, contiguous in the batch
+    struct CommandRange
+    {
+        GLuint first;
+        GLuint count;
+    };
+
+    // Draws that can share one multi-draw call
+    struct Batch
+    {
+        VertexLayout layout;
+        GLenum indexType;
+        std::vector<DrawElementsCommand> commands;          // baseInstance is the index of the command's record
+        std::vector<DrawElementsCommand> positionCommands;  // The same draws from the position streams
+        std::vector<DrawObject> objects;
+        std::vector<float> depths;  // View depth of each record
+        std::vector<CommandRange> objectCommands;
+        size_t commandOffset;   // Bytes into the command buffer
+        size_t positionCommandOffset;
+        size_t objectOffset;    // Bytes into the object buffer, aligned for glBindBufferRange
+    };
+
+    GLuint commandBuffer;
+    GLuint objectBuffer;
+    size_t commandCapacity;     // Bytes
+    size_t objectCapacity;      // Bytes
+    size_t objectAlignment;
+    DynamicRing* ring;
+    GLuint commandSource;       // Buffers and offsets of the last upload
+    GLuint objectSource;
+    GLintptr commandBase;
+    GLintptr objectBase;
+    std::vector<Batch> batches; // Kept across frames so their vectors keep their capacity
+    std::vector<DrawElementsCommand> commandStaging;
+    std::vector<unsigned char> objectStaging;
+    std::vector<GLuint> order;  // Scratch of sortFrontToBack()
+    std::vector<DrawElementsCommand> sortedCommands;
+    std::vector<DrawElementsCommand> sortedPositionCommands;
+    std::vector<DrawObject> sortedObjects;
+    std::vector<float> sortedDepths;
+    std::vector<CommandRange> sortedObjectCommands;
+
+    // Appends a record for the next commandCount commands of the batch; returns its index
+    static GLuint addObject(Batch& batch, const DrawObject& object, float depth, GLuint commandCount)
+    {
+        GLuint record = static_cast<GLuint>(batch.objects.size());
+        batch.objects.push_back(object);
+        batch.depths.push_back(depth);
+        batch.objectCommands.push_back({ static_cast<GLuint>(batch.commands.size()), commandCount });
+        return record;
+    }
+
+    Batch& batchFor(VertexLayout layout, GLenum indexType)
+    {
+        for (Batch& batch : batches)
+            if (batch.layout == layout && batch.indexType == indexType)
+                return batch;
+        Batch batch;
+        batch.layout = layout;
+        batch.indexType = indexType;
+        batch.commandOffset = batch.positionCommandOffset = batch.objectOffset = 0;
+        batches.push_back(batch);
+        return batches.back();
+    }
+};
+#endif
@@ -0,0 +1,153 @@
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include <include/GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include "mesh_registry.h"
+#include "object_transforms.h"
+#include "uniforms.h"
+
+/* Instanced drawing: per-instance transform and material in a shader storage buffer, one
+ * glDrawElementsInstancedBaseVertex per mesh. Instances of a mesh are stored contiguously and the
+ * vertex shader reads
+ *
+ *   struct Instance { mat4 model; mat3 normalMatrix; uvec4 material; };
+ *   layout(std430, binding = 3) readonly buffer Instances { Instance instances[]; };
+ *   uniform uint uFirstInstance;
+ *   ... instances[uFirstInstance + gl_InstanceID] ...
+ *
+ * The buffer is uploaded once when the instances change, so a frame costs one call per mesh no
+ * matter how many instances there are. For the same reason instances carry their normal matrix but
+ * no MVP: it would change with the camera, and the shader needs the world position anyway.
+ */
+
+const GLuint INSTANCES_BINDING = 3;
+
+// std430 mirror of the shader's Instance
+struct InstanceData
+{
+    glm::mat4 model;                // Includes the mesh's position dequantization
+    glm::vec4 normalMatrix[3];      // UNormalMatrix(model)
+    GLuint material[4];             // x: texture array layer, y: texture array; zw unused
+};
+static_assert(offsetof(InstanceData, material) == 112, "InstanceData layout must match std430");
+static_assert(sizeof(InstanceData) == 128, "InstanceData layout must match std430");
+
+class InstanceBuffer
+{
+public:
+    InstanceBuffer() : buffer(0), capacity(0), uploaded(0) {}
+
+    void create() { glGenBuffers(1, &buffer); }
+
+    void destroy()
+    {
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        capacity = 0;
+        uploaded = 0;
+        groups.clear();
+    }
+
+    void clear()
+    {
+        groups.clear();
+        uploaded = 0;
+    }
+
+    void add(GLuint mesh, const InstanceData& instance)
+    {
+        size_t group = 0;
+        while (group < groups.size() && groups[group].mesh != mesh)
+            ++group;
+        if (group == groups.size())
+        {
+            Group newGroup;
+            newGroup.mesh = mesh;
+            newGroup.first = 0;
+            groups.push_back(newGroup);
+        }
+        groups[group].instances.push_back(instance);
+    }
+
+    // Lays the groups out one after another in the storage buffer
+    void upload()
+    {
+        size_t count = 0;
+        for (Group& group : groups)
+        {
+            group.first = static_cast<GLuint>(count);
+            count += group.instances.size();
+        }
+        uploaded = count;
+        if (count == 0)
+            return;
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        if (count > capacity)
+        {
+            capacity = count;
+            glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(InstanceData)), nullptr, GL_STATIC_DRAW);
+        }
+        for (const Group& group : groups)
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(group.first * sizeof(InstanceData)),
+                static_cast<GLsizeiptr>(group.instances.size() * sizeof(InstanceData)), group.instances.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // One instanced call per mesh with the instancing program in use; returns the number of calls
+    size_t draw(MeshRegistry& meshes, Uniform<GLuint> firstInstance, VertexStream stream = VERTEX_STREAM_FULL) const
+    {
+        if (uploaded == 0)
+            return 0;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCES_BINDING, buffer);
+        for (const Group& group : groups)
+        {
+            const GLMesh& mesh = meshes.mesh(group.mesh);
+            meshes.bind(mesh.layout, stream);
+            USetUniform(firstInstance, group.first);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.nIndices, mesh.indexType,
+                (void*)(mesh.streamFirstIndex(stream) * UIndexSize(mesh.indexType)), static_cast<GLsizei>(group.instances.size()),
+                mesh.streamBaseVertex(stream));
+        }
+        return groups.size();
+    }
+
+    // The same instances with one draw call each, as a scene without instancing would issue them
+    size_t drawEach(MeshRegistry& meshes, Uniform<GLuint> firstInstance) const
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCES_BINDING, buffer);
+        for (const Group& group : groups)
+        {
+            const GLMesh& mesh = meshes.mesh(group.mesh);
+            meshes.bind(mesh.layout);
+            for (GLuint i = 0; i < group.instances.size(); ++i)
+            {
+                USetUniform(firstInstance, group.first + i);
+                meshes.draw(group.mesh);
+            }
+        }
+        return uploaded;
+    }
+
+    size_t size() const { return uploaded; }
+
+private:
+    // Instances of one mesh
+    struct Group
+    {
+        GLuint mesh;
+        GLuint first;   // Index of the first instance in the buffer
+        std::vector<InstanceData> instances;
+    };
+
+    GLuint buffer;
+    size_t capacity;    // Instances
+    size_t uploaded;
+    std::vector<Group> groups;
+};
+#endif
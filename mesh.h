@@ -0,0 +1,164 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <include/GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+
+// Interleaved vertex matching the position / normal / uv layout of the scene arrays
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+};
+static_assert(sizeof(Vertex) == 8 * sizeof(GLfloat), "Vertex must stay 8 tightly packed floats");
+
+// Indexed geometry: unique vertices plus a triangle list referencing them
+struct MeshData
+{
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+    std::vector<glm::vec4> tangents;    // Optional, one per vertex: xyz tangent, w bitangent sign
+};
+
+// Local-space bounding volumes of a mesh: an axis-aligned box and a sphere around its center
+struct MeshBounds
+{
+    glm::vec3 min;
+    glm::vec3 max;
+    glm::vec3 center;
+    float radius;
+};
+
+// Hashes and compares vertices bit for bit so only exact duplicates are welded
+struct VertexHash
+{
+    size_t operator()(const Vertex& v) const
+    {
+        // FNV-1a over the raw bytes
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+        size_t hash = 2166136261u;
+        for (size_t i = 0; i < sizeof(Vertex); ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+};
+
+struct VertexEqual
+{
+    bool operator()(const Vertex& a, const Vertex& b) const
+    {
+        return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+};
+
+
+// Welds a flat triangle soup (8 floats per vertex) into unique vertices and an index list
+inline void UWeldMesh(const GLfloat* soup, size_t vertexCount, MeshData& mesh)
+{
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    mesh.tangents.clear();
+    mesh.indices.reserve(vertexCount);
+
+    std::unordered_map<Vertex, GLuint, VertexHash, VertexEqual> lookup;
+    lookup.reserve(vertexCount);
+
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const GLfloat* src = soup + i * 8;
+        Vertex v;
+        // Adding 0.0f turns -0.0f into 0.0f so both weld to the same vertex
+        v.position = glm::vec3(src[0] + 0.0f, src[1] + 0.0f, src[2] + 0.0f);
+        v.normal = glm::vec3(src[3] + 0.0f, src[4] + 0.0f, src[5] + 0.0f);
+        v.texCoord = glm::vec2(src[6] + 0.0f, src[7] + 0.0f);
+
+        auto found = lookup.find(v);
+        if (found != lookup.end())
+        {
+            mesh.indices.push_back(found->second);
+            continue;
+        }
+
+        GLuint index = static_cast<GLuint>(mesh.vertices.size());
+        lookup.emplace(v, index);
+        mesh.vertices.push_back(v);
+        mesh.indices.push_back(index);
+    }
+}
+
+
+// Smallest index type able to address every vertex of the mesh
+inline GLenum UIndexType(const MeshData& mesh)
+{
+    return mesh.vertices.size() <= 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+inline size_t UIndexSize(GLenum indexType)
+{
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+}
+
+// Converts the index list to the byte layout expected by glBufferData for the given type
+inline std::vector<unsigned char> UPackIndices(const MeshData& mesh, GLenum indexType)
+{
+    std::vector<unsigned char> packed(mesh.indices.size() * UIndexSize(indexType));
+    if (indexType == GL_UNSIGNED_SHORT)
+    {
+        GLushort* dst = reinterpret_cast<GLushort*>(packed.data());
+        for (size_t i = 0; i < mesh.indices.size(); ++i)
+            dst[i] = static_cast<GLushort>(mesh.indices[i]);
+    }
+    else if (!packed.empty())
+    {
+        std::memcpy(packed.data(), mesh.indices.data(), packed.size());
+    }
+    return packed;
+}
+
+
+// Box around every vertex and a sphere around the box center that encloses them all
+inline MeshBounds UComputeBounds(const MeshData& mesh)
+{
+    MeshBounds bounds = { glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), 0.0f };
+    if (mesh.vertices.empty())
+        return bounds;
+
+    bounds.min = mesh.vertices[0].position;
+    bounds.max = bounds.min;
+    for (const Vertex& v : mesh.vertices)
+    {
+        bounds.min = glm::min(bounds.min, v.position);
+        bounds.max = glm::max(bounds.max, v.position);
+    }
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+    for (const Vertex& v : mesh.vertices)
+        bounds.radius = std::max(bounds.radius, glm::length(v.position - bounds.center));
+    return bounds;
+}
+
+
+// Prints vertex / index counts and memory before and after welding
+inline void UPrintMeshStats(const char* name, size_t soupVertexCount, const MeshData& mesh)
+{
+    GLenum indexType = UIndexType(mesh);
+    size_t soupBytes = soupVertexCount * sizeof(Vertex);
+    size_t weldedBytes = mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * UIndexSize(indexType);
+
+    std::cout << "INFO: Mesh " << name << ": "
+        << soupVertexCount << " soup vertices -> "
+        << mesh.vertices.size() << " unique vertices, "
+        << mesh.indices.size() << (indexType == GL_UNSIGNED_SHORT ? " 16-bit" : " 32-bit") << " indices, "
+        << soupBytes << " -> " << weldedBytes << " bytes" << std::endl;
+}
+#endif
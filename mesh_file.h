@@ -0,0 +1,424 @@
+#ifndef MESH_FILE_H
+#define MESH_FILE_H
+
+#include <include/GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mesh.h"
+#include "vertex_pack.h"
+
+/* Binary .mesh format, little endian:
+ *   MeshFileHeader
+ *   vertex blob   (vertexCount * vertexStride bytes, laid out as described by the header)
+ *   index blob    (indexCount indices of indexType)
+ *   LOD table     (lodCount MeshFileLod entries)
+ * Every section starts on a 16-byte boundary, so a mapped file can be handed to
+ * glBufferSubData without parsing or copying.
+ */
+const char MESH_FILE_MAGIC[4] = { 'U', 'M', 'S', 'H' };
+const uint32_t MESH_FILE_VERSION = 1;
+const uint32_t MESH_FILE_ALIGNMENT = 16;
+const uint32_t MESH_FILE_MAX_ATTRIBUTES = 4;
+
+// One vertex attribute as passed to glVertexAttribFormat
+struct MeshFileAttribute
+{
+    uint32_t location;
+    uint32_t components;
+    uint32_t type;          // GLenum
+    uint32_t normalized;
+    uint32_t offset;
+    uint32_t reserved[3];
+};
+static_assert(sizeof(MeshFileAttribute) == 32, "MeshFileAttribute layout changed");
+
+struct MeshFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t vertexLayout;  // VertexLayout the blob was written in
+
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexType;     // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    uint32_t indexCount;
+
+    uint32_t lodCount;
+    uint32_t attributeCount;
+    uint32_t reserved[2];
+    MeshFileAttribute attributes[MESH_FILE_MAX_ATTRIBUTES];
+
+    uint64_t vertexOffset;
+    uint64_t vertexBytes;
+    uint64_t indexOffset;
+    uint64_t indexBytes;
+    uint64_t lodOffset;
+    uint64_t fileSize;
+
+    float boundsMin[4];     // Axis-aligned bounds in mesh space (w unused)
+    float boundsMax[4];
+    float sphere[4];        // Bounding sphere center and radius
+    float quantOffset[4];   // Position dequantization for packed vertices (w unused)
+    float quantScale[4];
+};
+static_assert(sizeof(MeshFileHeader) % MESH_FILE_ALIGNMENT == 0, "MeshFileHeader must keep the blobs aligned");
+
+// One LOD level: a vertex range and an index range inside the blobs
+struct MeshFileLod
+{
+    uint32_t baseVertex;
+    uint32_t vertexCount;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;            // Geometric error of the level in mesh units (0 for the source mesh)
+    uint32_t reserved[3];
+};
+static_assert(sizeof(MeshFileLod) == 32, "MeshFileLod layout changed");
+
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+    MappedFile() : bytes(nullptr), length(0)
+#ifdef _WIN32
+        , fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#endif
+    {}
+    ~MappedFile() { close(); }
+
+    bool open(const char* path)
+    {
+        close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+        length = static_cast<size_t>(size.QuadPart);
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle)
+            bytes = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            length = static_cast<size_t>(info.st_size);
+            void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED)
+            {
+                // Advice values are not flags; each needs its own call
+                madvise(address, length, MADV_SEQUENTIAL);
+                madvise(address, length, MADV_WILLNEED);
+                bytes = static_cast<const unsigned char*>(address);
+            }
+        }
+        ::close(fd);
+#endif
+        if (!bytes)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (bytes)
+            UnmapViewOfFile(bytes);
+        if (mappingHandle)
+            CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE)
+            CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (bytes)
+            munmap(const_cast<unsigned char*>(bytes), length);
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const unsigned char* bytes;
+    size_t length;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#endif
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+
+// A mapped .mesh file. All accessors point straight into the mapping.
+class MeshFile
+{
+public:
+    MeshFile() : header(nullptr) {}
+
+    // Maps and validates the file; prints the reason and returns false when it cannot be used
+    bool open(const char* path)
+    {
+        header = nullptr;
+        if (!file.open(path))
+        {
+            std::cout << "ERROR::MESH_FILE::CANNOT_MAP " << path << std::endl;
+            return false;
+        }
+
+        const MeshFileHeader* candidate = reinterpret_cast<const MeshFileHeader*>(file.data());
+        if (file.size() < sizeof(MeshFileHeader) || std::memcmp(candidate->magic, MESH_FILE_MAGIC, 4) != 0)
+        {
+            std::cout << "ERROR::MESH_FILE::NOT_A_MESH_FILE " << path << std::endl;
+            return false;
+        }
+        if (candidate->version != MESH_FILE_VERSION || candidate->headerSize != sizeof(MeshFileHeader))
+        {
+            std::cout << "ERROR::MESH_FILE::UNSUPPORTED_VERSION " << candidate->version << " in " << path << std::endl;
+            return false;
+        }
+        if (candidate->vertexLayout >= VERTEX_LAYOUT_COUNT
+            || candidate->vertexStride != UVertexStride(static_cast<VertexLayout>(candidate->vertexLayout))
+            || (candidate->indexType != GL_UNSIGNED_SHORT && candidate->indexType != GL_UNSIGNED_INT))
+        {
+            std::cout << "ERROR::MESH_FILE::UNSUPPORTED_LAYOUT " << path << std::endl;
+            return false;
+        }
+        uint64_t indexSize = UIndexSize(candidate->indexType);
+        if (candidate->fileSize != file.size()
+            || candidate->vertexBytes != uint64_t(candidate->vertexCount) * candidate->vertexStride
+            || candidate->indexBytes != uint64_t(candidate->indexCount) * indexSize
+            || !fits(candidate->vertexOffset, candidate->vertexBytes)
+            || !fits(candidate->indexOffset, candidate->indexBytes)
+            || !fits(candidate->lodOffset, uint64_t(candidate->lodCount) * sizeof(MeshFileLod)))
+        {
+            std::cout << "ERROR::MESH_FILE::TRUNCATED " << path << std::endl;
+            return false;
+        }
+
+        // Every level's ranges must lie inside the blobs and its indices inside its vertex range,
+        // since levels are uploaded and decoded for picking straight from the mapping
+        const MeshFileLod* lods = reinterpret_cast<const MeshFileLod*>(file.data() + candidate->lodOffset);
+        const unsigned char* indices = file.data() + candidate->indexOffset;
+        for (uint32_t i = 0; i < candidate->lodCount; ++i)
+        {
+            const MeshFileLod& level = lods[i];
+            bool valid = uint64_t(level.baseVertex) + level.vertexCount <= candidate->vertexCount
+                && uint64_t(level.firstIndex) + level.indexCount <= candidate->indexCount;
+            for (uint32_t k = 0; valid && k < level.indexCount; ++k)
+            {
+                uint32_t index = candidate->indexType == GL_UNSIGNED_SHORT
+                    ? reinterpret_cast<const GLushort*>(indices)[level.firstIndex + k]
+                    : reinterpret_cast<const GLuint*>(indices)[level.firstIndex + k];
+                valid = index < level.vertexCount;
+            }
+            if (!valid)
+            {
+                std::cout << "ERROR::MESH_FILE::BAD_LOD " << i << " in " << path << std::endl;
+                return false;
+            }
+        }
+
+        header = candidate;
+        return true;
+    }
+
+    void close()
+    {
+        file.close();
+        header = nullptr;
+    }
+
+    const MeshFileHeader& info() const { return *header; }
+    const void* vertexData() const { return file.data() + header->vertexOffset; }
+    const void* indexData() const { return file.data() + header->indexOffset; }
+    const MeshFileLod& lod(uint32_t level) const
+    {
+        return reinterpret_cast<const MeshFileLod*>(file.data() + header->lodOffset)[level];
+    }
+
+    MeshBounds bounds() const
+    {
+        MeshBounds b;
+        b.min = glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]);
+        b.max = glm::vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]);
+        b.center = glm::vec3(header->sphere[0], header->sphere[1], header->sphere[2]);
+        b.radius = header->sphere[3];
+        return b;
+    }
+
+    Quantization quantization() const
+    {
+        Quantization q;
+        q.offset = glm::vec3(header->quantOffset[0], header->quantOffset[1], header->quantOffset[2]);
+        q.scale = glm::vec3(header->quantScale[0], header->quantScale[1], header->quantScale[2]);
+        return q;
+    }
+
+private:
+    MappedFile file;
+    const MeshFileHeader* header;
+
+    // Whether bytes at offset lie inside the mapping, without wrapping around
+    bool fits(uint64_t offset, uint64_t bytes) const
+    {
+        return offset <= file.size() && bytes <= file.size() - offset;
+    }
+};
+
+
+namespace meshfile
+{
+    inline uint64_t align(uint64_t offset)
+    {
+        return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+    }
+
+    inline void describeLayout(VertexLayout layout, MeshFileHeader& header)
+    {
+        const MeshFileAttribute packed[3] = {
+            { 0, 3, GL_UNSIGNED_SHORT, 1, offsetof(PackedVertex, position), { 0, 0, 0 } },
+            { 1, 4, GL_INT_2_10_10_10_REV, 1, offsetof(PackedVertex, normal), { 0, 0, 0 } },
+            { 2, 2, GL_HALF_FLOAT, 0, offsetof(PackedVertex, texCoord), { 0, 0, 0 } },
+        };
+        const MeshFileAttribute full[3] = {
+            { 0, 3, GL_FLOAT, 0, offsetof(Vertex, position), { 0, 0, 0 } },
+            { 1, 3, GL_FLOAT, 0, offsetof(Vertex, normal), { 0, 0, 0 } },
+            { 2, 2, GL_FLOAT, 0, offsetof(Vertex, texCoord), { 0, 0, 0 } },
+        };
+        header.vertexLayout = layout;
+        header.vertexStride = static_cast<uint32_t>(UVertexStride(layout));
+        header.attributeCount = 3;
+        for (int i = 0; i < 3; ++i)
+            header.attributes[i] = layout == VERTEX_LAYOUT_PACKED ? packed[i] : full[i];
+    }
+}
+
+
+// Writes the LOD chain (finest first) to a .mesh file in the given vertex layout.
+// lodErrors holds one geometric error per level and may be empty.
+inline bool UWriteMeshFile(const char* path, const std::vector<MeshData>& lods, VertexLayout layout, const std::vector<float>& lodErrors)
+{
+    if (lods.empty() || lods[0].vertices.empty())
+    {
+        std::cout << "ERROR::MESH_FILE::EMPTY_MESH " << path << std::endl;
+        return false;
+    }
+
+    MeshFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MESH_FILE_MAGIC, 4);
+    header.version = MESH_FILE_VERSION;
+    header.headerSize = sizeof(MeshFileHeader);
+    meshfile::describeLayout(layout, header);
+
+    // One index type for the whole file, wide enough for the largest level
+    MeshData merged;
+    std::vector<MeshFileLod> table;
+    GLenum indexType = GL_UNSIGNED_SHORT;
+    for (size_t i = 0; i < lods.size(); ++i)
+    {
+        MeshFileLod entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.baseVertex = static_cast<uint32_t>(merged.vertices.size());
+        entry.vertexCount = static_cast<uint32_t>(lods[i].vertices.size());
+        entry.firstIndex = static_cast<uint32_t>(merged.indices.size());
+        entry.indexCount = static_cast<uint32_t>(lods[i].indices.size());
+        entry.error = i < lodErrors.size() ? lodErrors[i] : 0.0f;
+        table.push_back(entry);
+
+        if (UIndexType(lods[i]) == GL_UNSIGNED_INT)
+            indexType = GL_UNSIGNED_INT;
+        merged.vertices.insert(merged.vertices.end(), lods[i].vertices.begin(), lods[i].vertices.end());
+        merged.indices.insert(merged.indices.end(), lods[i].indices.begin(), lods[i].indices.end());
+    }
+
+    MeshBounds bounds = UComputeBounds(merged);
+
+    Quantization q = { glm::vec3(0.0f), glm::vec3(1.0f) };
+    if (layout == VERTEX_LAYOUT_PACKED)
+        q = UComputeQuantization(merged);
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        header.boundsMin[axis] = bounds.min[axis];
+        header.boundsMax[axis] = bounds.max[axis];
+        header.sphere[axis] = bounds.center[axis];
+        header.quantOffset[axis] = q.offset[axis];
+        header.quantScale[axis] = q.scale[axis];
+    }
+    header.sphere[3] = bounds.radius;
+
+    std::vector<unsigned char> vertices = UPackVertices(merged, layout, q);
+    std::vector<unsigned char> indices = UPackIndices(merged, indexType);
+
+    header.vertexCount = static_cast<uint32_t>(merged.vertices.size());
+    header.indexType = indexType;
+    header.indexCount = static_cast<uint32_t>(merged.indices.size());
+    header.lodCount = static_cast<uint32_t>(table.size());
+    header.vertexOffset = meshfile::align(sizeof(MeshFileHeader));
+    header.vertexBytes = vertices.size();
+    header.indexOffset = meshfile::align(header.vertexOffset + header.vertexBytes);
+    header.indexBytes = indices.size();
+    header.lodOffset = meshfile::align(header.indexOffset + header.indexBytes);
+    header.fileSize = header.lodOffset + table.size() * sizeof(MeshFileLod);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "ERROR::MESH_FILE::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+
+    const char padding[MESH_FILE_ALIGNMENT] = {};
+    auto padTo = [&](uint64_t offset) { out.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(out.tellp()))); };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    padTo(header.vertexOffset);
+    out.write(reinterpret_cast<const char*>(vertices.data()), vertices.size());
+    padTo(header.indexOffset);
+    out.write(reinterpret_cast<const char*>(indices.data()), indices.size());
+    padTo(header.lodOffset);
+    out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(MeshFileLod));
+
+    if (!out)
+    {
+        std::cout << "ERROR::MESH_FILE::WRITE_FAILED " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+#endif
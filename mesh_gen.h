@@ -0,0 +1,222 @@
+#ifndef MESH_GEN_H
+#define MESH_GEN_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mesh.h"
+
+// Describes an upright (optionally tapered) cylinder standing on base
+struct CylinderDesc
+{
+    glm::vec3 base;         // Center of the bottom face
+    float bottomRadius;
+    float topRadius;
+    float height;
+    int segments;           // Subdivisions around the axis
+    int rings;              // Subdivisions along the axis
+    bool capBottom;
+    bool capTop;
+    float thickness;        // Wall thickness; > 0 turns the cylinder into a capped tube (cup shape)
+};
+
+namespace meshgen
+{
+    const float PI = 3.14159265358979f;
+
+    // Appends one wall between heights y0 and y1; inward walls are wound and lit from the inside
+    inline void appendWall(const CylinderDesc& desc, float y0, float y1, float bottomRadius, float topRadius, bool inward, MeshData& mesh)
+    {
+        GLuint first = static_cast<GLuint>(mesh.vertices.size());
+        float slope = (bottomRadius - topRadius) / (y1 - y0);
+        float facing = inward ? -1.0f : 1.0f;
+
+        // segments + 1 columns so the texture seam gets its own vertices
+        for (int ring = 0; ring <= desc.rings; ++ring)
+        {
+            float t = static_cast<float>(ring) / desc.rings;
+            float radius = bottomRadius + (topRadius - bottomRadius) * t;
+            for (int segment = 0; segment <= desc.segments; ++segment)
+            {
+                float s = static_cast<float>(segment) / desc.segments;
+                float angle = s * 2.0f * PI;
+                float c = std::cos(angle);
+                float sn = std::sin(angle);
+
+                Vertex v;
+                v.position = desc.base + glm::vec3(c * radius, y0 + t * (y1 - y0), sn * radius);
+                v.normal = glm::normalize(glm::vec3(c, slope, sn)) * facing;
+                v.texCoord = glm::vec2(s, t);
+                mesh.vertices.push_back(v);
+            }
+        }
+
+        GLuint columns = static_cast<GLuint>(desc.segments + 1);
+        for (int ring = 0; ring < desc.rings; ++ring)
+        {
+            for (int segment = 0; segment < desc.segments; ++segment)
+            {
+                GLuint a = first + ring * columns + segment;
+                GLuint b = a + 1;
+                GLuint c = a + columns;
+                GLuint d = c + 1;
+                if (inward)
+                {
+                    GLuint tri[6] = { a, b, c, c, b, d };
+                    mesh.indices.insert(mesh.indices.end(), tri, tri + 6);
+                }
+                else
+                {
+                    GLuint tri[6] = { a, c, b, b, c, d };
+                    mesh.indices.insert(mesh.indices.end(), tri, tri + 6);
+                }
+            }
+        }
+    }
+
+    // Appends a flat disk (innerRadius == 0) or annulus at height y facing up or down
+    inline void appendCap(const CylinderDesc& desc, float y, float outerRadius, float innerRadius, bool up, MeshData& mesh)
+    {
+        GLuint first = static_cast<GLuint>(mesh.vertices.size());
+        glm::vec3 normal(0.0f, up ? 1.0f : -1.0f, 0.0f);
+
+        // Planar uv mapping of the cap onto the unit square
+        for (int segment = 0; segment <= desc.segments; ++segment)
+        {
+            float angle = static_cast<float>(segment) / desc.segments * 2.0f * PI;
+            float c = std::cos(angle);
+            float sn = std::sin(angle);
+            for (int edge = 0; edge < 2; ++edge)
+            {
+                float radius = edge == 0 ? outerRadius : innerRadius;
+                Vertex v;
+                v.position = desc.base + glm::vec3(c * radius, y, sn * radius);
+                v.normal = normal;
+                v.texCoord = glm::vec2(0.5f + 0.5f * c * radius / outerRadius, 0.5f + 0.5f * sn * radius / outerRadius);
+                mesh.vertices.push_back(v);
+            }
+        }
+
+        for (int segment = 0; segment < desc.segments; ++segment)
+        {
+            GLuint outer0 = first + segment * 2;
+            GLuint inner0 = outer0 + 1;
+            GLuint outer1 = outer0 + 2;
+            GLuint inner1 = outer0 + 3;
+            if (up)
+            {
+                GLuint tri[6] = { outer0, inner0, outer1, outer1, inner0, inner1 };
+                mesh.indices.insert(mesh.indices.end(), tri, tri + (innerRadius > 0.0f ? 6 : 3));
+            }
+            else
+            {
+                GLuint tri[6] = { outer0, outer1, inner0, outer1, inner1, inner0 };
+                mesh.indices.insert(mesh.indices.end(), tri, tri + (innerRadius > 0.0f ? 6 : 3));
+            }
+        }
+    }
+
+    // Appends one axis-aligned face of a box subdivided into divisions x divisions quads
+    inline void appendBoxFace(const glm::vec3& center, const glm::vec3& normal, const glm::vec3& uAxis, const glm::vec3& vAxis, int divisions, MeshData& mesh)
+    {
+        GLuint first = static_cast<GLuint>(mesh.vertices.size());
+        for (int j = 0; j <= divisions; ++j)
+        {
+            float v = static_cast<float>(j) / divisions;
+            for (int i = 0; i <= divisions; ++i)
+            {
+                float u = static_cast<float>(i) / divisions;
+                Vertex vertex;
+                vertex.position = center + uAxis * (u * 2.0f - 1.0f) + vAxis * (v * 2.0f - 1.0f);
+                vertex.normal = normal;
+                vertex.texCoord = glm::vec2(u, v);
+                mesh.vertices.push_back(vertex);
+            }
+        }
+
+        GLuint columns = static_cast<GLuint>(divisions + 1);
+        for (int j = 0; j < divisions; ++j)
+        {
+            for (int i = 0; i < divisions; ++i)
+            {
+                GLuint a = first + j * columns + i;
+                GLuint tri[6] = { a, a + 1, a + columns, a + columns, a + 1, a + columns + 1 };
+                mesh.indices.insert(mesh.indices.end(), tri, tri + 6);
+            }
+        }
+    }
+}
+
+
+// Generates a cylinder, cone frustum or capped tube described by desc.
+// A capped tube has an inner wall, a rim annulus as its top cap and a solid floor as its bottom cap.
+inline void UGenerateCylinder(const CylinderDesc& desc, MeshData& mesh)
+{
+    mesh.vertices.clear();
+    mesh.indices.clear();
+
+    meshgen::appendWall(desc, 0.0f, desc.height, desc.bottomRadius, desc.topRadius, false, mesh);
+    if (desc.capBottom)
+        meshgen::appendCap(desc, 0.0f, desc.bottomRadius, 0.0f, false, mesh);
+
+    if (desc.thickness <= 0.0f)
+    {
+        if (desc.capTop)
+            meshgen::appendCap(desc, desc.height, desc.topRadius, 0.0f, true, mesh);
+        return;
+    }
+
+    float floorY = desc.capBottom ? desc.thickness : 0.0f;
+    float innerFloor = desc.bottomRadius + (desc.topRadius - desc.bottomRadius) * floorY / desc.height - desc.thickness;
+    float innerTop = desc.topRadius - desc.thickness;
+
+    meshgen::appendWall(desc, floorY, desc.height, innerFloor, innerTop, true, mesh);
+    if (desc.capBottom)
+        meshgen::appendCap(desc, floorY, innerFloor, 0.0f, true, mesh);
+    if (desc.capTop)
+        meshgen::appendCap(desc, desc.height, desc.topRadius, innerTop, true, mesh);
+}
+
+
+// Generates an axis-aligned box of the given half extents with divisions x divisions quads per face
+inline void UGenerateBox(const glm::vec3& center, const glm::vec3& halfExtents, int divisions, MeshData& mesh)
+{
+    mesh.vertices.clear();
+    mesh.indices.clear();
+
+    glm::vec3 x(halfExtents.x, 0.0f, 0.0f);
+    glm::vec3 y(0.0f, halfExtents.y, 0.0f);
+    glm::vec3 z(0.0f, 0.0f, halfExtents.z);
+
+    meshgen::appendBoxFace(center + x, glm::vec3(1.0f, 0.0f, 0.0f), -z, y, divisions, mesh);
+    meshgen::appendBoxFace(center - x, glm::vec3(-1.0f, 0.0f, 0.0f), z, y, divisions, mesh);
+    meshgen::appendBoxFace(center + y, glm::vec3(0.0f, 1.0f, 0.0f), x, -z, divisions, mesh);
+    meshgen::appendBoxFace(center - y, glm::vec3(0.0f, -1.0f, 0.0f), x, z, divisions, mesh);
+    meshgen::appendBoxFace(center + z, glm::vec3(0.0f, 0.0f, 1.0f), x, y, divisions, mesh);
+    meshgen::appendBoxFace(center - z, glm::vec3(0.0f, 0.0f, -1.0f), -x, y, divisions, mesh);
+}
+
+
+// Largest distance between the true round surface and its faceted approximation with the given
+// number of segments: the sagitta of one segment's chord at the wider radius
+inline float UCylinderChordError(const CylinderDesc& desc, int segments)
+{
+    return std::max(desc.bottomRadius, desc.topRadius) * (1.0f - std::cos(meshgen::PI / segments));
+}
+
+
+// Generates one cylinder per entry of segmentCounts, finest level first
+inline std::vector<MeshData> UGenerateCylinderLods(CylinderDesc desc, const std::vector<int>& segmentCounts)
+{
+    std::vector<MeshData> levels(segmentCounts.size());
+    for (size_t i = 0; i < segmentCounts.size(); ++i)
+    {
+        desc.segments = segmentCounts[i];
+        UGenerateCylinder(desc, levels[i]);
+    }
+    return levels;
+}
+#endif
@@ -0,0 +1,1102 @@
+#ifndef MESH_IMPORT_H
+#define MESH_IMPORT_H
+
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <iostream>
+
+#include "mesh.h"
+#include "mesh_file.h"
+
+/* OBJ and glTF 2.0 (.gltf / .glb) importers producing one indexed MeshData.
+ * Texture coordinates are returned with v = 0 at the top of the image, which is how
+ * UCreateTexture uploads images (no vertical flip).
+ */
+
+namespace meshimport
+{
+    // Files smaller than this are parsed on one thread; splitting them costs more than it saves
+    const size_t MIN_BYTES_PER_THREAD = 1 << 20;
+
+    inline unsigned resolveThreadCount(unsigned threadCount, size_t bytes)
+    {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        size_t useful = std::max<size_t>(1, bytes / MIN_BYTES_PER_THREAD);
+        return static_cast<unsigned>(std::min<size_t>(threadCount, useful));
+    }
+
+    // Runs job(i) for i in [0, count) on up to count threads; job 0 runs on the calling thread
+    template <typename Job>
+    void parallelFor(unsigned count, const Job& job)
+    {
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < count; ++i)
+            workers.emplace_back([&job, i]() { job(i); });
+        if (count > 0)
+            job(0);
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    inline bool readFile(const std::string& path, std::string& contents)
+    {
+        std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+        if (!in)
+            return false;
+        contents.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        in.read(&contents[0], contents.size());
+        return static_cast<bool>(in);
+    }
+
+    inline bool hasExtension(const std::string& path, const char* extension)
+    {
+        size_t length = std::strlen(extension);
+        if (path.size() < length)
+            return false;
+        for (size_t i = 0; i < length; ++i)
+            if (std::tolower(static_cast<unsigned char>(path[path.size() - length + i])) != extension[i])
+                return false;
+        return true;
+    }
+
+    inline const char* skipSpaces(const char* p, const char* end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            ++p;
+        return p;
+    }
+
+    inline const char* nextLine(const char* p, const char* end)
+    {
+        const void* newline = std::memchr(p, '\n', end - p);
+        return newline ? static_cast<const char*>(newline) + 1 : end;
+    }
+
+    // Decimal number parser for OBJ / JSON numbers. Accurate to about an ulp, which is all the
+    // mesh data needs, and several times faster than strtod since it skips locale handling.
+    inline const char* parseNumber(const char* p, const char* end, double& value)
+    {
+        static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+        p = skipSpaces(p, end);
+        const char* start = p;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+
+        double mantissa = 0.0;
+        int exponent = 0;
+        bool digits = false;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p, digits = true)
+            mantissa = mantissa * 10.0 + (*p - '0');
+        if (p < end && *p == '.')
+        {
+            for (++p; p < end && *p >= '0' && *p <= '9'; ++p, digits = true)
+            {
+                mantissa = mantissa * 10.0 + (*p - '0');
+                --exponent;
+            }
+        }
+        if (!digits)
+        {
+            value = 0.0;
+            return start;
+        }
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            const char* q = p + 1;
+            bool negativeExponent = false;
+            if (q < end && (*q == '-' || *q == '+'))
+                negativeExponent = *q++ == '-';
+            if (q < end && *q >= '0' && *q <= '9')
+            {
+                int e = 0;
+                for (; q < end && *q >= '0' && *q <= '9'; ++q)
+                    e = std::min(e * 10 + (*q - '0'), 1000);
+                exponent += negativeExponent ? -e : e;
+                p = q;
+            }
+        }
+
+        double scale = std::abs(exponent) <= 22 ? powers[std::abs(exponent)] : std::pow(10.0, std::abs(exponent));
+        double result = exponent < 0 ? mantissa / scale : mantissa * scale;
+        value = negative ? -result : result;
+        return p;
+    }
+
+    inline const char* parseFloat(const char* p, const char* end, float& value)
+    {
+        double number;
+        p = parseNumber(p, end, number);
+        value = static_cast<float>(number);
+        return p;
+    }
+
+    inline const char* parseInt(const char* p, const char* end, long& value, bool& found)
+    {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+        value = 0;
+        found = false;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p, found = true)
+            value = value * 10 + (*p - '0');
+        if (negative)
+            value = -value;
+        return p;
+    }
+
+    // Area-weighted vertex normals for meshes that come without any; with missing set, only the
+    // vertices it flags get one and the others keep theirs
+    inline void computeNormals(std::vector<Vertex>& vertices, const GLuint* indices, size_t indexCount, const unsigned char* missing = nullptr)
+    {
+        for (size_t v = 0; v < vertices.size(); ++v)
+            if (!missing || missing[v])
+                vertices[v].normal = glm::vec3(0.0f);
+        for (size_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            const GLuint* corner = indices + i;
+            glm::vec3 n = glm::cross(vertices[corner[1]].position - vertices[corner[0]].position,
+                vertices[corner[2]].position - vertices[corner[0]].position);
+            for (int k = 0; k < 3; ++k)
+                if (!missing || missing[corner[k]])
+                    vertices[corner[k]].normal += n;
+        }
+        for (size_t v = 0; v < vertices.size(); ++v)
+        {
+            if (missing && !missing[v])
+                continue;
+            float length = glm::length(vertices[v].normal);
+            vertices[v].normal = length > 0.0f ? vertices[v].normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+
+
+    // ---- OBJ -----------------------------------------------------------------------------
+
+    // Position / texcoord / normal references of one face corner: -1 when absent, a file-wide
+    // index, or OBJ_RELATIVE plus an index counted from the start of the chunk, for negative
+    // (relative) references that can only be resolved once the earlier chunks are counted.
+    struct ObjCorner
+    {
+        int64_t position;
+        int64_t texCoord;
+        int64_t normal;
+    };
+    const int64_t OBJ_ABSENT = -1;
+    const int64_t OBJ_RELATIVE = int64_t(1) << 62;
+
+    struct ObjCornerHash
+    {
+        size_t operator()(const ObjCorner& c) const
+        {
+            uint64_t hash = static_cast<uint64_t>(c.position) * 0x9E3779B97F4A7C15ull;
+            hash ^= static_cast<uint64_t>(c.texCoord) * 0xC2B2AE3D27D4EB4Full + (hash >> 29);
+            hash ^= static_cast<uint64_t>(c.normal) * 0x165667B19E3779F9ull + (hash >> 31);
+            return static_cast<size_t>(hash ^ (hash >> 32));
+        }
+    };
+
+    struct ObjCornerEqual
+    {
+        bool operator()(const ObjCorner& a, const ObjCorner& b) const
+        {
+            return a.position == b.position && a.texCoord == b.texCoord && a.normal == b.normal;
+        }
+    };
+
+    // Open-addressing set of corners stored as indices into a caller-owned corner list. Several
+    // times faster than std::unordered_map for the millions of lookups a large file needs.
+    class ObjCornerTable
+    {
+    public:
+        ObjCornerTable() : slots(1024, EMPTY), count(0) {}
+
+        // Index of corner in corners, appending it first when it is new
+        GLuint insert(const ObjCorner& corner, std::vector<ObjCorner>& corners, bool& inserted)
+        {
+            if ((count + 1) * 2 > slots.size())
+                grow(corners);
+
+            size_t mask = slots.size() - 1;
+            for (size_t slot = ObjCornerHash()(corner) & mask;; slot = (slot + 1) & mask)
+            {
+                if (slots[slot] == EMPTY)
+                {
+                    slots[slot] = static_cast<GLuint>(corners.size());
+                    corners.push_back(corner);
+                    ++count;
+                    inserted = true;
+                    return slots[slot];
+                }
+                if (ObjCornerEqual()(corners[slots[slot]], corner))
+                {
+                    inserted = false;
+                    return slots[slot];
+                }
+            }
+        }
+
+    private:
+        static constexpr GLuint EMPTY = ~0u;
+        std::vector<GLuint> slots;
+        size_t count;
+
+        void grow(const std::vector<ObjCorner>& corners)
+        {
+            std::vector<GLuint> old(slots.size() * 2, EMPTY);
+            old.swap(slots);
+            size_t mask = slots.size() - 1;
+            for (GLuint index : old)
+            {
+                if (index == EMPTY)
+                    continue;
+                size_t slot = ObjCornerHash()(corners[index]) & mask;
+                while (slots[slot] != EMPTY)
+                    slot = (slot + 1) & mask;
+                slots[slot] = index;
+            }
+        }
+    };
+
+    // Everything one thread parsed from its slice of the file
+    struct ObjChunk
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> texCoords;
+        std::vector<glm::vec3> normals;
+        std::vector<ObjCorner> corners;     // Unique corners of the chunk
+        std::vector<GLuint> indices;        // Triangles as indices into corners
+        const char* error;                  // Start of the first malformed line, if any
+    };
+
+    inline const char* parseCornerIndex(const char* p, const char* end, size_t localCount, int64_t& index)
+    {
+        long value;
+        bool found;
+        p = parseInt(p, end, value, found);
+        if (!found || value == 0)
+            index = OBJ_ABSENT;
+        else if (value > 0)
+            index = value - 1;
+        else
+            index = OBJ_RELATIVE + static_cast<int64_t>(localCount) + value;
+        return p;
+    }
+
+    inline void parseObjChunk(const char* p, const char* end, ObjChunk& chunk)
+    {
+        ObjCornerTable cornerTable;
+        std::vector<GLuint> face;
+        chunk.error = nullptr;
+
+        for (const char* line = p; line < end; line = nextLine(line, end))
+        {
+            const char* q = skipSpaces(line, end);
+            if (end - q < 2)
+                continue;
+
+            if (q[0] == 'v' && (q[1] == ' ' || q[1] == '\t'))
+            {
+                glm::vec3 v;
+                q = parseFloat(q + 2, end, v.x);
+                q = parseFloat(q, end, v.y);
+                parseFloat(q, end, v.z);
+                chunk.positions.push_back(v);
+            }
+            else if (q[0] == 'v' && q[1] == 't')
+            {
+                glm::vec2 t;
+                q = parseFloat(q + 2, end, t.x);
+                parseFloat(q, end, t.y);
+                t.y = 1.0f - t.y;
+                chunk.texCoords.push_back(t);
+            }
+            else if (q[0] == 'v' && q[1] == 'n')
+            {
+                glm::vec3 n;
+                q = parseFloat(q + 2, end, n.x);
+                q = parseFloat(q, end, n.y);
+                parseFloat(q, end, n.z);
+                chunk.normals.push_back(n);
+            }
+            else if (q[0] == 'f' && (q[1] == ' ' || q[1] == '\t'))
+            {
+                face.clear();
+                q = skipSpaces(q + 1, end);
+                while (q < end && *q != '\n' && *q != '\r' && *q != '#')
+                {
+                    ObjCorner corner = { OBJ_ABSENT, OBJ_ABSENT, OBJ_ABSENT };
+                    const char* start = q;
+                    q = parseCornerIndex(q, end, chunk.positions.size(), corner.position);
+                    if (q < end && *q == '/')
+                    {
+                        q = parseCornerIndex(q + 1, end, chunk.texCoords.size(), corner.texCoord);
+                        if (q < end && *q == '/')
+                            q = parseCornerIndex(q + 1, end, chunk.normals.size(), corner.normal);
+                    }
+                    if (q == start || corner.position == OBJ_ABSENT)
+                    {
+                        if (!chunk.error)
+                            chunk.error = line;
+                        break;
+                    }
+
+                    bool inserted;
+                    face.push_back(cornerTable.insert(corner, chunk.corners, inserted));
+                    q = skipSpaces(q, end);
+                }
+
+                for (size_t i = 2; i < face.size(); ++i)
+                {
+                    chunk.indices.push_back(face[0]);
+                    chunk.indices.push_back(face[i - 1]);
+                    chunk.indices.push_back(face[i]);
+                }
+            }
+        }
+    }
+
+    inline int64_t resolveCornerIndex(int64_t index, size_t chunkOffset)
+    {
+        return index >= OBJ_RELATIVE / 2 ? static_cast<int64_t>(chunkOffset) + (index - OBJ_RELATIVE) : index;
+    }
+
+    inline size_t lineNumber(const char* begin, const char* at)
+    {
+        return std::count(begin, at, '\n') + 1;
+    }
+
+
+    // ---- glTF ----------------------------------------------------------------------------
+
+    // Minimal JSON document tree, enough for glTF
+    struct JsonValue
+    {
+        enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+        JsonValue() : type(NUL), number(0.0) {}
+
+        Type type;
+        double number;
+        std::string text;
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string, JsonValue> > members;
+
+        const JsonValue* find(const char* key) const
+        {
+            for (const auto& member : members)
+                if (member.first == key)
+                    return &member.second;
+            return nullptr;
+        }
+
+        double getNumber(const char* key, double fallback) const
+        {
+            const JsonValue* value = find(key);
+            return value && value->type == NUMBER ? value->number : fallback;
+        }
+
+        int getInt(const char* key, int fallback) const
+        {
+            return static_cast<int>(getNumber(key, fallback));
+        }
+
+        const JsonValue* at(const char* key, size_t index) const
+        {
+            const JsonValue* array = find(key);
+            return array && array->type == ARRAY && index < array->items.size() ? &array->items[index] : nullptr;
+        }
+    };
+
+    class JsonParser
+    {
+    public:
+        JsonParser(const char* begin, const char* end) : p(begin), end(end) {}
+
+        bool parse(JsonValue& root)
+        {
+            return value(root) && (skip(), p == end);
+        }
+
+    private:
+        const char* p;
+        const char* end;
+
+        void skip()
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+                ++p;
+        }
+
+        bool literal(const char* word)
+        {
+            size_t length = std::strlen(word);
+            if (static_cast<size_t>(end - p) < length || std::memcmp(p, word, length) != 0)
+                return false;
+            p += length;
+            return true;
+        }
+
+        bool string(std::string& out)
+        {
+            if (p >= end || *p != '"')
+                return false;
+            for (++p; p < end && *p != '"'; ++p)
+            {
+                if (*p != '\\')
+                {
+                    out += *p;
+                    continue;
+                }
+                if (++p >= end)
+                    return false;
+                switch (*p)
+                {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                {
+                    if (end - p < 5)
+                        return false;
+                    unsigned code = static_cast<unsigned>(std::strtoul(std::string(p + 1, p + 5).c_str(), nullptr, 16));
+                    p += 4;
+                    // UTF-8 encode; surrogate pairs are kept as two code units, names in glTF files are ASCII
+                    if (code < 0x80)
+                        out += static_cast<char>(code);
+                    else if (code < 0x800)
+                    {
+                        out += static_cast<char>(0xC0 | (code >> 6));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    else
+                    {
+                        out += static_cast<char>(0xE0 | (code >> 12));
+                        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: out += *p; break;
+                }
+            }
+            if (p >= end)
+                return false;
+            ++p;
+            return true;
+        }
+
+        bool value(JsonValue& out)
+        {
+            skip();
+            if (p >= end)
+                return false;
+
+            if (*p == '{')
+            {
+                out.type = JsonValue::OBJECT;
+                ++p;
+                skip();
+                if (p < end && *p == '}')
+                    return ++p, true;
+                for (;;)
+                {
+                    std::pair<std::string, JsonValue> member;
+                    skip();
+                    if (!string(member.first))
+                        return false;
+                    skip();
+                    if (p >= end || *p++ != ':' || !value(member.second))
+                        return false;
+                    out.members.push_back(std::move(member));
+                    skip();
+                    if (p < end && *p == ',')
+                        ++p;
+                    else
+                        return p < end && *p++ == '}';
+                }
+            }
+            if (*p == '[')
+            {
+                out.type = JsonValue::ARRAY;
+                ++p;
+                skip();
+                if (p < end && *p == ']')
+                    return ++p, true;
+                for (;;)
+                {
+                    out.items.push_back(JsonValue());
+                    if (!value(out.items.back()))
+                        return false;
+                    skip();
+                    if (p < end && *p == ',')
+                        ++p;
+                    else
+                        return p < end && *p++ == ']';
+                }
+            }
+            if (*p == '"')
+            {
+                out.type = JsonValue::STRING;
+                return string(out.text);
+            }
+            if (literal("true") || literal("false"))
+            {
+                out.type = JsonValue::BOOLEAN;
+                out.number = p[-1] == 'e' && p[-2] == 'u' ? 1.0 : 0.0;
+                return true;
+            }
+            if (literal("null"))
+                return true;
+
+            double number;
+            const char* next = parseNumber(p, end, number);
+            if (next == p)
+                return false;
+            out.type = JsonValue::NUMBER;
+            out.number = number;
+            p = next;
+            return true;
+        }
+    };
+
+    inline bool decodeBase64(const char* p, const char* end, std::vector<unsigned char>& out)
+    {
+        unsigned bits = 0;
+        int count = 0;
+        for (; p < end && *p != '='; ++p)
+        {
+            int value;
+            if (*p >= 'A' && *p <= 'Z') value = *p - 'A';
+            else if (*p >= 'a' && *p <= 'z') value = *p - 'a' + 26;
+            else if (*p >= '0' && *p <= '9') value = *p - '0' + 52;
+            else if (*p == '+') value = 62;
+            else if (*p == '/') value = 63;
+            else return false;
+            bits = (bits << 6) | value;
+            count += 6;
+            if (count >= 8)
+            {
+                count -= 8;
+                out.push_back(static_cast<unsigned char>(bits >> count));
+            }
+        }
+        return true;
+    }
+
+    // A parsed glTF document and the bytes of its buffers
+    struct GltfDocument
+    {
+        JsonValue json;
+        std::vector<std::vector<unsigned char> > buffers;
+    };
+
+    // Reads accessor elements as floats (normalized integers are mapped to [0, 1] / [-1, 1])
+    inline bool readAccessor(const GltfDocument& doc, int accessorIndex, int components, std::vector<float>& out)
+    {
+        const JsonValue* accessor = doc.json.at("accessors", accessorIndex);
+        if (!accessor || accessor->find("sparse"))
+            return false;
+        const JsonValue* view = doc.json.at("bufferViews", accessor->getInt("bufferView", -1));
+        if (!view)
+            return false;
+        int bufferIndex = view->getInt("buffer", -1);
+        if (bufferIndex < 0 || bufferIndex >= static_cast<int>(doc.buffers.size()))
+            return false;
+
+        int componentType = accessor->getInt("componentType", 0);
+        bool normalized = accessor->find("normalized") && accessor->find("normalized")->number != 0.0;
+        size_t count = static_cast<size_t>(accessor->getNumber("count", 0));
+        size_t componentSize = componentType == GL_FLOAT || componentType == GL_UNSIGNED_INT ? 4
+            : componentType == GL_UNSIGNED_SHORT || componentType == GL_SHORT ? 2 : 1;
+        size_t stride = static_cast<size_t>(view->getNumber("byteStride", 0));
+        if (stride == 0)
+            stride = componentSize * components;
+        size_t offset = static_cast<size_t>(view->getNumber("byteOffset", 0) + accessor->getNumber("byteOffset", 0));
+
+        const std::vector<unsigned char>& buffer = doc.buffers[bufferIndex];
+        if (count > 0 && offset + (count - 1) * stride + componentSize * components > buffer.size())
+            return false;
+
+        out.resize(count * components);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const unsigned char* element = buffer.data() + offset + i * stride;
+            for (int c = 0; c < components; ++c)
+            {
+                const unsigned char* src = element + c * componentSize;
+                float value;
+                switch (componentType)
+                {
+                case GL_FLOAT: std::memcpy(&value, src, 4); break;
+                case GL_UNSIGNED_INT: { uint32_t v; std::memcpy(&v, src, 4); value = static_cast<float>(v); break; }
+                case GL_UNSIGNED_SHORT: { uint16_t v; std::memcpy(&v, src, 2); value = normalized ? v / 65535.0f : v; break; }
+                case GL_SHORT: { int16_t v; std::memcpy(&v, src, 2); value = normalized ? std::max(v / 32767.0f, -1.0f) : v; break; }
+                case GL_UNSIGNED_BYTE: value = normalized ? *src / 255.0f : *src; break;
+                case GL_BYTE: { int8_t v = static_cast<int8_t>(*src); value = normalized ? std::max(v / 127.0f, -1.0f) : v; break; }
+                default: return false;
+                }
+                out[i * components + c] = value;
+            }
+        }
+        return true;
+    }
+
+    inline bool readIndices(const GltfDocument& doc, int accessorIndex, std::vector<GLuint>& out)
+    {
+        const JsonValue* accessor = doc.json.at("accessors", accessorIndex);
+        const JsonValue* view = accessor ? doc.json.at("bufferViews", accessor->getInt("bufferView", -1)) : nullptr;
+        if (!view)
+            return false;
+        int bufferIndex = view->getInt("buffer", -1);
+        if (bufferIndex < 0 || bufferIndex >= static_cast<int>(doc.buffers.size()))
+            return false;
+
+        int componentType = accessor->getInt("componentType", 0);
+        size_t size = componentType == GL_UNSIGNED_INT ? 4 : componentType == GL_UNSIGNED_SHORT ? 2 : componentType == GL_UNSIGNED_BYTE ? 1 : 0;
+        size_t count = static_cast<size_t>(accessor->getNumber("count", 0));
+        size_t offset = static_cast<size_t>(view->getNumber("byteOffset", 0) + accessor->getNumber("byteOffset", 0));
+        const std::vector<unsigned char>& buffer = doc.buffers[bufferIndex];
+        if (size == 0 || offset + count * size > buffer.size())
+            return false;
+
+        out.resize(count);
+        const unsigned char* src = buffer.data() + offset;
+        for (size_t i = 0; i < count; ++i, src += size)
+        {
+            if (size == 4) { uint32_t v; std::memcpy(&v, src, 4); out[i] = v; }
+            else if (size == 2) { uint16_t v; std::memcpy(&v, src, 2); out[i] = v; }
+            else out[i] = *src;
+        }
+        return true;
+    }
+
+    inline glm::mat4 nodeMatrix(const JsonValue& node)
+    {
+        const JsonValue* matrix = node.find("matrix");
+        if (matrix && matrix->items.size() == 16)
+        {
+            glm::mat4 m;
+            for (int i = 0; i < 16; ++i)
+                m[i / 4][i % 4] = static_cast<float>(matrix->items[i].number);
+            return m;
+        }
+
+        glm::vec3 t(0.0f), s(1.0f);
+        float q[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        if (const JsonValue* translation = node.find("translation"))
+            for (size_t i = 0; i < 3 && i < translation->items.size(); ++i)
+                t[i] = static_cast<float>(translation->items[i].number);
+        if (const JsonValue* scale = node.find("scale"))
+            for (size_t i = 0; i < 3 && i < scale->items.size(); ++i)
+                s[i] = static_cast<float>(scale->items[i].number);
+        if (const JsonValue* rotation = node.find("rotation"))
+            for (size_t i = 0; i < 4 && i < rotation->items.size(); ++i)
+                q[i] = static_cast<float>(rotation->items[i].number);
+
+        // Unit quaternion (x, y, z, w) to rotation matrix columns
+        float x = q[0], y = q[1], z = q[2], w = q[3];
+        glm::mat3 r(glm::vec3(1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w)),
+                    glm::vec3(2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w)),
+                    glm::vec3(2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y)));
+        return glm::translate(t) * glm::mat4(r) * glm::scale(s);
+    }
+
+    // One triangle primitive to decode, with the world transform of the node that instances it
+    struct GltfPrimitive
+    {
+        const JsonValue* primitive;
+        glm::mat4 transform;
+    };
+
+    inline void collectPrimitives(const GltfDocument& doc, int nodeIndex, const glm::mat4& parent, int depth, std::vector<GltfPrimitive>& out)
+    {
+        const JsonValue* node = doc.json.at("nodes", nodeIndex);
+        if (!node || depth > 64)
+            return;
+        glm::mat4 world = parent * nodeMatrix(*node);
+
+        if (const JsonValue* mesh = doc.json.at("meshes", node->getInt("mesh", -1)))
+            if (const JsonValue* primitives = mesh->find("primitives"))
+                for (const JsonValue& primitive : primitives->items)
+                {
+                    GltfPrimitive entry = { &primitive, world };
+                    out.push_back(entry);
+                }
+
+        if (const JsonValue* children = node->find("children"))
+            for (const JsonValue& child : children->items)
+                collectPrimitives(doc, static_cast<int>(child.number), world, depth + 1, out);
+    }
+
+    // Decodes one primitive into world-space vertices; returns an error message or nullptr
+    inline const char* decodePrimitive(const GltfDocument& doc, const GltfPrimitive& entry, MeshData& mesh)
+    {
+        const JsonValue& primitive = *entry.primitive;
+        if (primitive.getInt("mode", 4) != 4)
+            return nullptr;     // Points, lines and strips are skipped
+        const JsonValue* attributes = primitive.find("attributes");
+        if (!attributes || !attributes->find("POSITION"))
+            return "primitive without POSITION";
+
+        std::vector<float> positions, normals, texCoords;
+        if (!readAccessor(doc, attributes->getInt("POSITION", -1), 3, positions))
+            return "unreadable POSITION accessor";
+        size_t count = positions.size() / 3;
+        if (attributes->find("NORMAL") && (!readAccessor(doc, attributes->getInt("NORMAL", -1), 3, normals) || normals.size() != count * 3))
+            return "unreadable NORMAL accessor";
+        if (attributes->find("TEXCOORD_0") && (!readAccessor(doc, attributes->getInt("TEXCOORD_0", -1), 2, texCoords) || texCoords.size() != count * 2))
+            return "unreadable TEXCOORD_0 accessor";
+
+        if (primitive.find("indices"))
+        {
+            if (!readIndices(doc, primitive.getInt("indices", -1), mesh.indices))
+                return "unreadable index accessor";
+            for (GLuint index : mesh.indices)
+                if (index >= count)
+                    return "index out of range";
+        }
+        else
+        {
+            mesh.indices.resize(count);
+            for (size_t i = 0; i < count; ++i)
+                mesh.indices[i] = static_cast<GLuint>(i);
+        }
+        mesh.indices.resize(mesh.indices.size() / 3 * 3);
+
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(entry.transform)));
+        mesh.vertices.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            Vertex& v = mesh.vertices[i];
+            v.position = glm::vec3(entry.transform * glm::vec4(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2], 1.0f));
+            v.normal = normals.empty() ? glm::vec3(0.0f) : glm::normalize(normalMatrix * glm::vec3(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]));
+            v.texCoord = texCoords.empty() ? glm::vec2(0.0f) : glm::vec2(texCoords[i * 2], texCoords[i * 2 + 1]);
+        }
+
+        // Mirroring transforms flip the winding
+        if (glm::determinant(glm::mat3(entry.transform)) < 0.0f)
+            for (size_t i = 0; i < mesh.indices.size(); i += 3)
+                std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+
+        if (normals.empty())
+            computeNormals(mesh.vertices, mesh.indices.data(), mesh.indices.size());
+        return nullptr;
+    }
+
+    inline bool loadGltfDocument(const char* path, GltfDocument& doc)
+    {
+        std::string file;
+        if (!readFile(path, file))
+        {
+            std::cout << "ERROR::MESH_IMPORT::CANNOT_READ " << path << std::endl;
+            return false;
+        }
+
+        const char* jsonBegin = file.data();
+        const char* jsonEnd = file.data() + file.size();
+        std::vector<unsigned char> binaryChunk;
+        bool binary = false;
+
+        // .glb: 12-byte header, then a JSON chunk and an optional BIN chunk
+        if (file.size() >= 12 && std::memcmp(file.data(), "glTF", 4) == 0)
+        {
+            uint32_t header[3];
+            std::memcpy(header, file.data(), 12);
+            size_t offset = 12;
+            bool foundJson = false;
+            while (header[1] == 2 && offset + 8 <= file.size())
+            {
+                uint32_t chunk[2];
+                std::memcpy(chunk, file.data() + offset, 8);
+                if (offset + 8 + chunk[0] > file.size())
+                    break;
+                const char* data = file.data() + offset + 8;
+                if (chunk[1] == 0x4E4F534A)         // "JSON"
+                {
+                    jsonBegin = data;
+                    jsonEnd = data + chunk[0];
+                    foundJson = true;
+                }
+                else if (chunk[1] == 0x004E4942)    // "BIN\0"
+                {
+                    binaryChunk.assign(data, data + chunk[0]);
+                    binary = true;
+                }
+                offset += 8 + chunk[0];
+            }
+            if (!foundJson)
+            {
+                std::cout << "ERROR::MESH_IMPORT::BAD_GLB " << path << std::endl;
+                return false;
+            }
+        }
+
+        if (!JsonParser(jsonBegin, jsonEnd).parse(doc.json) || doc.json.type != JsonValue::OBJECT)
+        {
+            std::cout << "ERROR::MESH_IMPORT::BAD_JSON " << path << std::endl;
+            return false;
+        }
+
+        std::string directory(path);
+        size_t slash = directory.find_last_of("/\\");
+        directory = slash == std::string::npos ? std::string() : directory.substr(0, slash + 1);
+
+        const JsonValue* buffers = doc.json.find("buffers");
+        if (buffers)
+        {
+            for (size_t i = 0; i < buffers->items.size(); ++i)
+            {
+                const JsonValue* uri = buffers->items[i].find("uri");
+                doc.buffers.push_back(std::vector<unsigned char>());
+                std::vector<unsigned char>& bytes = doc.buffers.back();
+                if (!uri)
+                {
+                    if (i == 0 && binary)
+                        bytes.swap(binaryChunk);
+                }
+                else if (uri->text.compare(0, 5, "data:") == 0)
+                {
+                    size_t comma = uri->text.find(";base64,");
+                    if (comma == std::string::npos || !decodeBase64(uri->text.data() + comma + 8, uri->text.data() + uri->text.size(), bytes))
+                    {
+                        std::cout << "ERROR::MESH_IMPORT::BAD_DATA_URI " << path << std::endl;
+                        return false;
+                    }
+                }
+                else
+                {
+                    std::string contents;
+                    if (!readFile(directory + uri->text, contents))
+                    {
+                        std::cout << "ERROR::MESH_IMPORT::CANNOT_READ " << directory + uri->text << std::endl;
+                        return false;
+                    }
+                    bytes.assign(contents.begin(), contents.end());
+                }
+            }
+        }
+        return true;
+    }
+}
+
+
+// Loads a Wavefront OBJ file into an indexed mesh. The file is mapped and split at line
+// boundaries into one chunk per thread (threadCount 0 uses every core); each thread parses
+// its chunk and dedups its face corners, then the unique corners of all chunks are merged
+// through one hash map. Polygons are fan triangulated, groups and materials are ignored and
+// normals missing from some corners are generated from the faces for those vertices only.
+inline bool UImportObj(const char* path, MeshData& mesh, unsigned threadCount = 0)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cout << "ERROR::MESH_IMPORT::CANNOT_READ " << path << std::endl;
+        return false;
+    }
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    const char* end = begin + file.size();
+
+    unsigned chunkCount = meshimport::resolveThreadCount(threadCount, file.size());
+    std::vector<const char*> bounds(chunkCount + 1, end);
+    bounds[0] = begin;
+    for (unsigned i = 1; i < chunkCount; ++i)
+        bounds[i] = std::max(bounds[i - 1], meshimport::nextLine(begin + file.size() * i / chunkCount, end));
+
+    std::vector<meshimport::ObjChunk> chunks(chunkCount);
+    meshimport::parallelFor(chunkCount, [&](unsigned i) { meshimport::parseObjChunk(bounds[i], bounds[i + 1], chunks[i]); });
+
+    for (const meshimport::ObjChunk& chunk : chunks)
+    {
+        if (chunk.error)
+        {
+            std::cout << "ERROR::MESH_IMPORT::BAD_FACE " << path << ":" << meshimport::lineNumber(begin, chunk.error) << std::endl;
+            return false;
+        }
+    }
+
+    // Concatenate the attribute arrays; each chunk's relative references resolve against its offsets
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<size_t> positionOffsets, texCoordOffsets, normalOffsets, indexOffsets;
+    size_t indexCount = 0;
+    for (const meshimport::ObjChunk& chunk : chunks)
+    {
+        positionOffsets.push_back(positions.size());
+        texCoordOffsets.push_back(texCoords.size());
+        normalOffsets.push_back(normals.size());
+        indexOffsets.push_back(indexCount);
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        indexCount += chunk.indices.size();
+    }
+
+    // Merge the per-chunk unique corners into the final vertex list
+    meshimport::ObjCornerTable cornerTable;
+    std::vector<meshimport::ObjCorner> uniqueCorners;
+    std::vector<std::vector<GLuint> > remaps(chunkCount);
+    mesh.vertices.clear();
+    std::vector<unsigned char> missingNormals;  // Per vertex: 1 when its corner had no vn
+    bool anyMissing = false;
+    for (unsigned c = 0; c < chunkCount; ++c)
+    {
+        const meshimport::ObjChunk& chunk = chunks[c];
+        remaps[c].resize(chunk.corners.size());
+        for (size_t i = 0; i < chunk.corners.size(); ++i)
+        {
+            meshimport::ObjCorner corner;
+            corner.position = meshimport::resolveCornerIndex(chunk.corners[i].position, positionOffsets[c]);
+            corner.texCoord = meshimport::resolveCornerIndex(chunk.corners[i].texCoord, texCoordOffsets[c]);
+            corner.normal = meshimport::resolveCornerIndex(chunk.corners[i].normal, normalOffsets[c]);
+
+            if (corner.position < 0 || corner.position >= static_cast<int64_t>(positions.size())
+                || corner.texCoord >= static_cast<int64_t>(texCoords.size()) || corner.normal >= static_cast<int64_t>(normals.size()))
+            {
+                std::cout << "ERROR::MESH_IMPORT::INDEX_OUT_OF_RANGE " << path << std::endl;
+                return false;
+            }
+
+            bool inserted;
+            remaps[c][i] = cornerTable.insert(corner, uniqueCorners, inserted);
+            if (inserted)
+            {
+                Vertex v;
+                v.position = positions[corner.position];
+                v.normal = corner.normal >= 0 ? normals[corner.normal] : glm::vec3(0.0f);
+                v.texCoord = corner.texCoord >= 0 ? texCoords[corner.texCoord] : glm::vec2(0.0f);
+                mesh.vertices.push_back(v);
+                missingNormals.push_back(corner.normal < 0 ? 1 : 0);
+                anyMissing = anyMissing || corner.normal < 0;
+            }
+        }
+    }
+
+    // Remap every chunk's triangles straight into the output index list
+    mesh.indices.resize(indexCount);
+    meshimport::parallelFor(chunkCount, [&](unsigned c)
+    {
+        GLuint* out = mesh.indices.data() + indexOffsets[c];
+        for (GLuint index : chunks[c].indices)
+            *out++ = remaps[c][index];
+    });
+
+    if (mesh.indices.empty())
+    {
+        std::cout << "ERROR::MESH_IMPORT::NO_TRIANGLES " << path << std::endl;
+        return false;
+    }
+    if (anyMissing)
+        meshimport::computeNormals(mesh.vertices, mesh.indices.data(), mesh.indices.size(), missingNormals.data());
+    return true;
+}
+
+
+// Loads every triangle primitive of a glTF 2.0 scene (.gltf with external or embedded buffers,
+// or .glb) into one mesh, baking node transforms into the vertices. Primitives are decoded in
+// parallel (threadCount 0 uses every core). Sparse and quantized (non-float) positions are not supported.
+inline bool UImportGltf(const char* path, MeshData& mesh, unsigned threadCount = 0)
+{
+    meshimport::GltfDocument doc;
+    if (!meshimport::loadGltfDocument(path, doc))
+        return false;
+
+    std::vector<meshimport::GltfPrimitive> primitives;
+    const meshimport::JsonValue* scene = doc.json.at("scenes", doc.json.getInt("scene", 0));
+    if (scene && scene->find("nodes"))
+    {
+        for (const meshimport::JsonValue& root : scene->find("nodes")->items)
+            meshimport::collectPrimitives(doc, static_cast<int>(root.number), glm::mat4(1.0f), 0, primitives);
+    }
+    else if (const meshimport::JsonValue* meshes = doc.json.find("meshes"))
+    {
+        // No scene: every mesh once, untransformed
+        for (const meshimport::JsonValue& m : meshes->items)
+            if (const meshimport::JsonValue* list = m.find("primitives"))
+                for (const meshimport::JsonValue& primitive : list->items)
+                {
+                    meshimport::GltfPrimitive entry = { &primitive, glm::mat4(1.0f) };
+                    primitives.push_back(entry);
+                }
+    }
+
+    // Each worker decodes every n-th primitive
+    unsigned workers = std::max(1u, std::min<unsigned>(threadCount == 0 ? std::thread::hardware_concurrency() : threadCount,
+        static_cast<unsigned>(primitives.size())));
+    std::vector<MeshData> decoded(primitives.size());
+    std::vector<const char*> errors(primitives.size(), nullptr);
+    meshimport::parallelFor(workers, [&](unsigned w)
+    {
+        for (size_t i = w; i < primitives.size(); i += workers)
+            errors[i] = meshimport::decodePrimitive(doc, primitives[i], decoded[i]);
+    });
+
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    for (size_t i = 0; i < decoded.size(); ++i)
+    {
+        if (errors[i])
+        {
+            std::cout << "ERROR::MESH_IMPORT::BAD_GLTF " << path << ": " << errors[i] << std::endl;
+            return false;
+        }
+        GLuint base = static_cast<GLuint>(mesh.vertices.size());
+        mesh.vertices.insert(mesh.vertices.end(), decoded[i].vertices.begin(), decoded[i].vertices.end());
+        for (GLuint index : decoded[i].indices)
+            mesh.indices.push_back(base + index);
+    }
+
+    if (mesh.indices.empty())
+    {
+        std::cout << "ERROR::MESH_IMPORT::NO_TRIANGLES " << path << std::endl;
+        return false;
+    }
+
+    // Primitives split at material boundaries share vertices along the seam; weld them back
+    MeshData welded;
+    std::unordered_map<Vertex, GLuint, VertexHash, VertexEqual> unique;
+    for (GLuint index : mesh.indices)
+    {
+        auto inserted = unique.insert(std::make_pair(mesh.vertices[index], static_cast<GLuint>(welded.vertices.size())));
+        if (inserted.second)
+            welded.vertices.push_back(mesh.vertices[index]);
+        welded.indices.push_back(inserted.first->second);
+    }
+    mesh.vertices.swap(welded.vertices);
+    mesh.indices.swap(welded.indices);
+    return true;
+}
+
+
+// Picks the importer from the file extension (.obj, .gltf or .glb)
+inline bool UImportMesh(const char* path, MeshData& mesh, unsigned threadCount = 0)
+{
+    std::string name(path);
+    if (meshimport::hasExtension(name, ".obj"))
+        return UImportObj(path, mesh, threadCount);
+    if (meshimport::hasExtension(name, ".gltf") || meshimport::hasExtension(name, ".glb"))
+        return UImportGltf(path, mesh, threadCount);
+    std::cout << "ERROR::MESH_IMPORT::UNSUPPORTED_FORMAT " << path << std::endl;
+    return false;
+}
+#endif
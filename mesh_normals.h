@@ -0,0 +1,461 @@
+#ifndef MESH_NORMALS_H
+#define MESH_NORMALS_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MESH_NORMALS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MESH_NORMALS_SSE
+#endif
+
+#include "mesh.h"
+#include "mesh_import.h"    // parallelFor
+
+/* Load-time normal and tangent generation.
+ * Per-triangle work (face normals, corner angles, UV frames) runs BATCH triangles at a time through
+ * the widest SIMD lanes the build has; per-vertex work runs in parallel over vertex groups.
+ */
+
+namespace meshnormals
+{
+    // Meshes below this many triangles per thread are processed on fewer threads
+    const size_t MIN_TRIANGLES_PER_THREAD = 32768;
+    // Triangles gathered into SoA scratch per kernel call; a multiple of every lane width
+    const size_t BATCH = 8;
+
+    // Thin lane wrappers so the kernels below are written once for AVX2, SSE2 and scalar builds
+#if defined(MESH_NORMALS_AVX2)
+    typedef __m256 Lanes;
+    const size_t WIDTH = 8;
+    inline Lanes load(const float* p) { return _mm256_loadu_ps(p); }
+    inline void store(float* p, Lanes a) { _mm256_storeu_ps(p, a); }
+    inline Lanes set1(float a) { return _mm256_set1_ps(a); }
+    inline Lanes add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+    inline Lanes sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+    inline Lanes mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+    inline Lanes div(Lanes a, Lanes b) { return _mm256_div_ps(a, b); }
+    inline Lanes min(Lanes a, Lanes b) { return _mm256_min_ps(a, b); }
+    inline Lanes max(Lanes a, Lanes b) { return _mm256_max_ps(a, b); }
+    inline Lanes sqrt(Lanes a) { return _mm256_sqrt_ps(a); }
+    inline Lanes abs(Lanes a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    inline Lanes negativeAsOne(Lanes a) { return _mm256_and_ps(_mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_LT_OQ), _mm256_set1_ps(1.0f)); }
+#elif defined(MESH_NORMALS_SSE)
+    typedef __m128 Lanes;
+    const size_t WIDTH = 4;
+    inline Lanes load(const float* p) { return _mm_loadu_ps(p); }
+    inline void store(float* p, Lanes a) { _mm_storeu_ps(p, a); }
+    inline Lanes set1(float a) { return _mm_set1_ps(a); }
+    inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+    inline Lanes sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+    inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+    inline Lanes div(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+    inline Lanes min(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+    inline Lanes max(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+    inline Lanes sqrt(Lanes a) { return _mm_sqrt_ps(a); }
+    inline Lanes abs(Lanes a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    inline Lanes negativeAsOne(Lanes a) { return _mm_and_ps(_mm_cmplt_ps(a, _mm_setzero_ps()), _mm_set1_ps(1.0f)); }
+#else
+    typedef float Lanes;
+    const size_t WIDTH = 1;
+    inline Lanes load(const float* p) { return *p; }
+    inline void store(float* p, Lanes a) { *p = a; }
+    inline Lanes set1(float a) { return a; }
+    inline Lanes add(Lanes a, Lanes b) { return a + b; }
+    inline Lanes sub(Lanes a, Lanes b) { return a - b; }
+    inline Lanes mul(Lanes a, Lanes b) { return a * b; }
+    inline Lanes div(Lanes a, Lanes b) { return a / b; }
+    inline Lanes min(Lanes a, Lanes b) { return a < b ? a : b; }
+    inline Lanes max(Lanes a, Lanes b) { return a > b ? a : b; }
+    inline Lanes sqrt(Lanes a) { return std::sqrt(a); }
+    inline Lanes abs(Lanes a) { return std::fabs(a); }
+    inline Lanes negativeAsOne(Lanes a) { return a < 0.0f ? 1.0f : 0.0f; }
+#endif
+
+    inline Lanes dot(Lanes ax, Lanes ay, Lanes az, Lanes bx, Lanes by, Lanes bz)
+    {
+        return add(add(mul(ax, bx), mul(ay, by)), mul(az, bz));
+    }
+
+    // acos of a clamped cosine, within 7e-5 radians (Abramowitz and Stegun 4.4.45)
+    inline Lanes acos(Lanes x)
+    {
+        x = min(max(x, set1(-1.0f)), set1(1.0f));
+        Lanes a = abs(x);
+        Lanes poly = add(set1(1.5707288f), mul(a, add(set1(-0.2121144f), mul(a, add(set1(0.0742610f), mul(a, set1(-0.0187293f)))))));
+        Lanes r = mul(sqrt(sub(set1(1.0f), a)), poly);
+        // x < 0: pi - r
+        return add(r, mul(negativeAsOne(x), sub(set1(3.14159265f), add(r, r))));
+    }
+
+    // Triangle corners gathered into SoA scratch for one batch
+    struct CornerBatch
+    {
+        float p[3][3][BATCH];   // [corner][axis][triangle]
+        float uv[3][2][BATCH];
+    };
+
+    inline void gather(const MeshData& mesh, size_t firstTriangle, size_t count, bool texCoords, CornerBatch& batch)
+    {
+        for (size_t t = 0; t < BATCH; ++t)
+        {
+            // Short batches repeat their last triangle; those lanes are never written back
+            size_t triangle = firstTriangle + std::min(t, count - 1);
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const Vertex& v = mesh.vertices[mesh.indices[triangle * 3 + corner]];
+                for (int axis = 0; axis < 3; ++axis)
+                    batch.p[corner][axis][t] = v.position[axis];
+                if (texCoords)
+                {
+                    batch.uv[corner][0][t] = v.texCoord.x;
+                    batch.uv[corner][1][t] = v.texCoord.y;
+                }
+            }
+        }
+    }
+
+    // Unit face normals (zero for degenerate triangles) and the interior angle at each corner
+    inline void faceNormals(const MeshData& mesh, size_t first, size_t last, glm::vec3* normals, float* angles)
+    {
+        CornerBatch batch;
+        float out[6][BATCH];
+        for (size_t base = first; base < last; base += BATCH)
+        {
+            size_t count = std::min(BATCH, last - base);
+            gather(mesh, base, count, false, batch);
+            for (size_t lane = 0; lane < BATCH; lane += WIDTH)
+            {
+                Lanes ax = load(&batch.p[0][0][lane]), ay = load(&batch.p[0][1][lane]), az = load(&batch.p[0][2][lane]);
+                Lanes e0x = sub(load(&batch.p[1][0][lane]), ax), e0y = sub(load(&batch.p[1][1][lane]), ay), e0z = sub(load(&batch.p[1][2][lane]), az);
+                Lanes e1x = sub(load(&batch.p[2][0][lane]), ax), e1y = sub(load(&batch.p[2][1][lane]), ay), e1z = sub(load(&batch.p[2][2][lane]), az);
+                Lanes e2x = sub(e1x, e0x), e2y = sub(e1y, e0y), e2z = sub(e1z, e0z);
+
+                Lanes nx = sub(mul(e0y, e1z), mul(e0z, e1y));
+                Lanes ny = sub(mul(e0z, e1x), mul(e0x, e1z));
+                Lanes nz = sub(mul(e0x, e1y), mul(e0y, e1x));
+                Lanes inverseLength = div(set1(1.0f), max(sqrt(dot(nx, ny, nz, nx, ny, nz)), set1(FLT_MIN)));
+
+                Lanes l0 = max(sqrt(dot(e0x, e0y, e0z, e0x, e0y, e0z)), set1(FLT_MIN));
+                Lanes l1 = max(sqrt(dot(e1x, e1y, e1z, e1x, e1y, e1z)), set1(FLT_MIN));
+                Lanes l2 = max(sqrt(dot(e2x, e2y, e2z, e2x, e2y, e2z)), set1(FLT_MIN));
+                Lanes angleA = acos(div(dot(e0x, e0y, e0z, e1x, e1y, e1z), mul(l0, l1)));
+                Lanes angleB = acos(div(sub(set1(0.0f), dot(e0x, e0y, e0z, e2x, e2y, e2z)), mul(l0, l2)));
+
+                store(&out[0][lane], mul(nx, inverseLength));
+                store(&out[1][lane], mul(ny, inverseLength));
+                store(&out[2][lane], mul(nz, inverseLength));
+                store(&out[3][lane], angleA);
+                store(&out[4][lane], angleB);
+                store(&out[5][lane], max(sub(sub(set1(3.14159265f), angleA), angleB), set1(0.0f)));
+            }
+            for (size_t t = 0; t < count; ++t)
+            {
+                normals[base + t] = glm::vec3(out[0][t], out[1][t], out[2][t]);
+                angles[(base + t) * 3 + 0] = out[3][t];
+                angles[(base + t) * 3 + 1] = out[4][t];
+                angles[(base + t) * 3 + 2] = out[5][t];
+            }
+        }
+    }
+
+    // Tangent and bitangent directions of each face from its UV gradients, signed so they always
+    // follow +u and +v, and the sign of the UV area (MikkTSpace's orientation flag)
+    inline void faceTangents(const MeshData& mesh, size_t first, size_t last, glm::vec3* tangents, glm::vec3* bitangents, float* uvArea)
+    {
+        CornerBatch batch;
+        float out[7][BATCH];
+        for (size_t base = first; base < last; base += BATCH)
+        {
+            size_t count = std::min(BATCH, last - base);
+            gather(mesh, base, count, true, batch);
+            for (size_t lane = 0; lane < BATCH; lane += WIDTH)
+            {
+                Lanes ax = load(&batch.p[0][0][lane]), ay = load(&batch.p[0][1][lane]), az = load(&batch.p[0][2][lane]);
+                Lanes e1x = sub(load(&batch.p[1][0][lane]), ax), e1y = sub(load(&batch.p[1][1][lane]), ay), e1z = sub(load(&batch.p[1][2][lane]), az);
+                Lanes e2x = sub(load(&batch.p[2][0][lane]), ax), e2y = sub(load(&batch.p[2][1][lane]), ay), e2z = sub(load(&batch.p[2][2][lane]), az);
+                Lanes u0 = load(&batch.uv[0][0][lane]), v0 = load(&batch.uv[0][1][lane]);
+                Lanes du1 = sub(load(&batch.uv[1][0][lane]), u0), dv1 = sub(load(&batch.uv[1][1][lane]), v0);
+                Lanes du2 = sub(load(&batch.uv[2][0][lane]), u0), dv2 = sub(load(&batch.uv[2][1][lane]), v0);
+
+                Lanes area = sub(mul(du1, dv2), mul(du2, dv1));
+                Lanes sign = sub(set1(1.0f), add(negativeAsOne(area), negativeAsOne(area)));
+                store(&out[0][lane], mul(sub(mul(e1x, dv2), mul(e2x, dv1)), sign));
+                store(&out[1][lane], mul(sub(mul(e1y, dv2), mul(e2y, dv1)), sign));
+                store(&out[2][lane], mul(sub(mul(e1z, dv2), mul(e2z, dv1)), sign));
+                store(&out[3][lane], mul(sub(mul(e2x, du1), mul(e1x, du2)), sign));
+                store(&out[4][lane], mul(sub(mul(e2y, du1), mul(e1y, du2)), sign));
+                store(&out[5][lane], mul(sub(mul(e2z, du1), mul(e1z, du2)), sign));
+                store(&out[6][lane], area);
+            }
+            for (size_t t = 0; t < count; ++t)
+            {
+                tangents[base + t] = glm::vec3(out[0][t], out[1][t], out[2][t]);
+                bitangents[base + t] = glm::vec3(out[3][t], out[4][t], out[5][t]);
+                uvArea[base + t] = out[6][t];
+            }
+        }
+    }
+
+    inline unsigned threadsFor(unsigned threadCount, size_t triangles)
+    {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        size_t useful = std::max<size_t>(1, triangles / MIN_TRIANGLES_PER_THREAD);
+        return static_cast<unsigned>(std::min<size_t>(threadCount, useful));
+    }
+
+    // Runs job(first, last) over count items split evenly across threads
+    template <typename Job>
+    void parallelRanges(unsigned threads, size_t count, const Job& job)
+    {
+        meshimport::parallelFor(threads, [&](unsigned i) { job(count * i / threads, count * (i + 1) / threads); });
+    }
+
+    // Compressed lists of the corners (3 * triangle + k) that share a key, e.g. a vertex or a position
+    struct CornerGroups
+    {
+        std::vector<GLuint> offsets;    // Group g owns corners[offsets[g] .. offsets[g + 1])
+        std::vector<GLuint> corners;
+
+        void build(const std::vector<GLuint>& keys, size_t groupCount)
+        {
+            offsets.assign(groupCount + 1, 0);
+            for (GLuint key : keys)
+                ++offsets[key + 1];
+            for (size_t g = 0; g < groupCount; ++g)
+                offsets[g + 1] += offsets[g];
+            corners.resize(keys.size());
+            std::vector<GLuint> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t c = 0; c < keys.size(); ++c)
+                corners[cursor[keys[c]]++] = static_cast<GLuint>(c);
+        }
+        size_t size() const { return offsets.size() - 1; }
+    };
+
+    // Exact position match, with -0 and +0 treated alike
+    struct PositionHash
+    {
+        size_t operator()(const glm::vec3& p) const
+        {
+            uint32_t bits[3];
+            glm::vec3 canonical = p + glm::vec3(0.0f);
+            std::memcpy(bits, &canonical, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+    struct PositionEqual
+    {
+        bool operator()(const glm::vec3& a, const glm::vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+    };
+}
+
+
+// Replaces the mesh's normals with ones built from its faces. Where faces around a position meet at
+// less than creaseAngle degrees they share an angle-weighted normal; sharper edges split the vertex
+// (0 gives faceted normals, 180 fully smooth). With orientOutward, triangles are first rewound to
+// face away from the mesh center, for hand-written data whose winding cannot be trusted; flat meshes
+// keep the side their authored normals point to. Tangents, if any, are dropped.
+inline void UGenerateNormals(MeshData& mesh, float creaseAngle, bool orientOutward = false, unsigned threadCount = 0)
+{
+    size_t triangles = mesh.indices.size() / 3;
+    mesh.tangents.clear();
+    if (triangles == 0)
+        return;
+    unsigned threads = meshnormals::threadsFor(threadCount, triangles);
+
+    std::vector<glm::vec3> faceNormals(triangles);
+    std::vector<float> cornerAngles(triangles * 3);
+    meshnormals::parallelRanges(threads, triangles, [&](size_t first, size_t last)
+    {
+        meshnormals::faceNormals(mesh, first, last, faceNormals.data(), cornerAngles.data());
+    });
+
+    if (orientOutward)
+    {
+        MeshBounds bounds = UComputeBounds(mesh);
+        float tolerance = 1e-4f * bounds.radius;
+        for (size_t t = 0; t < triangles; ++t)
+        {
+            GLuint* corner = &mesh.indices[t * 3];
+            glm::vec3 centroid = (mesh.vertices[corner[0]].position + mesh.vertices[corner[1]].position + mesh.vertices[corner[2]].position) / 3.0f;
+            float outward = glm::dot(faceNormals[t], centroid - bounds.center);
+            if (std::fabs(outward) <= tolerance)
+                outward = glm::dot(faceNormals[t], mesh.vertices[corner[0]].normal + mesh.vertices[corner[1]].normal + mesh.vertices[corner[2]].normal);
+            if (outward < 0.0f)
+            {
+                std::swap(corner[1], corner[2]);
+                std::swap(cornerAngles[t * 3 + 1], cornerAngles[t * 3 + 2]);
+                faceNormals[t] = -faceNormals[t];
+            }
+        }
+    }
+
+    // Group corners by position, ignoring the normals and uvs that split the welded vertices
+    std::unordered_map<glm::vec3, GLuint, meshnormals::PositionHash, meshnormals::PositionEqual> positionIds;
+    positionIds.reserve(mesh.vertices.size());
+    std::vector<GLuint> vertexPosition(mesh.vertices.size());
+    for (size_t v = 0; v < mesh.vertices.size(); ++v)
+        vertexPosition[v] = positionIds.emplace(mesh.vertices[v].position, static_cast<GLuint>(positionIds.size())).first->second;
+    std::vector<GLuint> cornerPosition(mesh.indices.size());
+    for (size_t c = 0; c < mesh.indices.size(); ++c)
+        cornerPosition[c] = vertexPosition[mesh.indices[c]];
+    meshnormals::CornerGroups groups;
+    groups.build(cornerPosition, positionIds.size());
+
+    // Per group: smooth each corner over the faces within the crease angle, then weld corners that
+    // came from the same vertex and ended up with the same normal
+    float creaseCosine = std::cos(glm::radians(std::min(std::max(creaseAngle, 0.0f), 180.0f)));
+    std::vector<glm::vec3> cornerNormals(mesh.indices.size());
+    std::vector<GLuint> cornerVertex(mesh.indices.size());     // Group-local new vertex, then global
+    std::vector<GLuint> groupVertices(groups.size() + 1, 0);
+    meshnormals::parallelRanges(threads, groups.size(), [&](size_t first, size_t last)
+    {
+        for (size_t g = first; g < last; ++g)
+        {
+            GLuint begin = groups.offsets[g], end = groups.offsets[g + 1];
+            GLuint unique = 0;
+            for (GLuint i = begin; i < end; ++i)
+            {
+                GLuint c = groups.corners[i];
+                const glm::vec3& faceNormal = faceNormals[c / 3];
+                glm::vec3 sum(0.0f);
+                for (GLuint j = begin; j < end; ++j)
+                {
+                    GLuint other = groups.corners[j];
+                    if (glm::dot(faceNormal, faceNormals[other / 3]) >= creaseCosine)
+                        sum += faceNormals[other / 3] * cornerAngles[other];
+                }
+                float length = glm::length(sum);
+                cornerNormals[c] = length > 0.0f ? sum / length : (glm::length(faceNormal) > 0.0f ? faceNormal : glm::vec3(0.0f, 1.0f, 0.0f));
+
+                cornerVertex[c] = unique;
+                for (GLuint j = begin; j < i; ++j)
+                {
+                    GLuint other = groups.corners[j];
+                    if (mesh.indices[other] == mesh.indices[c] && cornerNormals[other] == cornerNormals[c])
+                    {
+                        cornerVertex[c] = cornerVertex[other];
+                        break;
+                    }
+                }
+                if (cornerVertex[c] == unique)
+                    ++unique;
+            }
+            groupVertices[g + 1] = unique;
+        }
+    });
+    for (size_t g = 0; g < groups.size(); ++g)
+        groupVertices[g + 1] += groupVertices[g];
+
+    std::vector<Vertex> vertices(groupVertices.back());
+    meshnormals::parallelRanges(threads, groups.size(), [&](size_t first, size_t last)
+    {
+        for (size_t g = first; g < last; ++g)
+            for (GLuint i = groups.offsets[g]; i < groups.offsets[g + 1]; ++i)
+            {
+                GLuint c = groups.corners[i];
+                GLuint index = groupVertices[g] + cornerVertex[c];
+                vertices[index] = mesh.vertices[mesh.indices[c]];
+                vertices[index].normal = cornerNormals[c];
+                cornerVertex[c] = index;
+            }
+    });
+    mesh.vertices.swap(vertices);
+    mesh.indices.assign(cornerVertex.begin(), cornerVertex.end());
+}
+
+
+// Generates per-vertex tangents into mesh.tangents following MikkTSpace's conventions: face
+// tangents from the UV gradients, projected into each vertex's normal plane and weighted by the
+// corner angle; w = +1 or -1 is the bitangent sign, bitangent = w * cross(normal, tangent), taken
+// from the side of cross(normal, tangent) the accumulated face bitangents fall on. Vertices shared
+// by faces of opposite UV orientation (mirrored seams) are split so each side keeps its sign.
+inline void UGenerateTangents(MeshData& mesh, unsigned threadCount = 0)
+{
+    size_t triangles = mesh.indices.size() / 3;
+    mesh.tangents.clear();
+    if (triangles == 0)
+        return;
+    unsigned threads = meshnormals::threadsFor(threadCount, triangles);
+
+    std::vector<glm::vec3> faceTangents(triangles), faceBitangents(triangles), faceNormals(triangles);
+    std::vector<float> uvArea(triangles), cornerAngles(triangles * 3);
+    meshnormals::parallelRanges(threads, triangles, [&](size_t first, size_t last)
+    {
+        meshnormals::faceTangents(mesh, first, last, faceTangents.data(), faceBitangents.data(), uvArea.data());
+        meshnormals::faceNormals(mesh, first, last, faceNormals.data(), cornerAngles.data());
+    });
+
+    // Split vertices used with both UV orientations: the negative side gets a copy
+    std::vector<unsigned char> orientations(mesh.vertices.size(), 0);
+    for (size_t c = 0; c < mesh.indices.size(); ++c)
+        orientations[mesh.indices[c]] |= uvArea[c / 3] < 0.0f ? 2 : 1;
+    std::vector<GLuint> mirrored(mesh.vertices.size(), ~0u);
+    for (size_t c = 0; c < mesh.indices.size(); ++c)
+    {
+        GLuint v = mesh.indices[c];
+        if (orientations[v] != 3 || uvArea[c / 3] >= 0.0f)
+            continue;
+        if (mirrored[v] == ~0u)
+        {
+            mirrored[v] = static_cast<GLuint>(mesh.vertices.size());
+            mesh.vertices.push_back(mesh.vertices[v]);
+        }
+        mesh.indices[c] = mirrored[v];
+    }
+
+    meshnormals::CornerGroups groups;
+    groups.build(mesh.indices, mesh.vertices.size());
+    mesh.tangents.resize(mesh.vertices.size());
+    meshnormals::parallelRanges(threads, groups.size(), [&](size_t first, size_t last)
+    {
+        for (size_t v = first; v < last; ++v)
+        {
+            const glm::vec3& n = mesh.vertices[v].normal;
+            glm::vec3 sum(0.0f), bitangentSum(0.0f);
+            float orientation = 1.0f;
+            for (GLuint i = groups.offsets[v]; i < groups.offsets[v + 1]; ++i)
+            {
+                GLuint c = groups.corners[i];
+                GLuint t = c / 3;
+                // Degenerate UVs fall back to the first edge so the vertex still gets a frame
+                glm::vec3 faceTangent = std::fabs(uvArea[t]) > 0.0f ? faceTangents[t]
+                    : mesh.vertices[mesh.indices[t * 3 + 1]].position - mesh.vertices[mesh.indices[t * 3]].position;
+                glm::vec3 projected = faceTangent - n * glm::dot(n, faceTangent);
+                float length = glm::length(projected);
+                if (length > 0.0f)
+                    sum += projected * (cornerAngles[c] / length);
+                glm::vec3 bitangent = faceBitangents[t] - n * glm::dot(n, faceBitangents[t]);
+                length = glm::length(bitangent);
+                if (length > 0.0f)
+                    bitangentSum += bitangent * (cornerAngles[c] / length);
+                orientation = uvArea[t] < 0.0f ? -1.0f : 1.0f;
+            }
+
+            glm::vec3 tangent = sum - n * glm::dot(n, sum);
+            float length = glm::length(tangent);
+            if (length > 0.0f)
+                tangent /= length;
+            else
+                tangent = glm::normalize(glm::cross(n, std::fabs(n.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f)));
+            // Without usable bitangents (degenerate UVs) the UV orientation decides, as it does for
+            // the split above
+            float handedness = glm::dot(glm::cross(n, tangent), bitangentSum);
+            float sign = handedness != 0.0f ? (handedness < 0.0f ? -1.0f : 1.0f) : orientation;
+            mesh.tangents[v] = glm::vec4(tangent, sign);
+        }
+    });
+}
+#endif
@@ -0,0 +1,293 @@
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <iostream>
+
+#include "mesh.h"
+
+// Post-transform cache statistics of an index buffer
+struct VertexCacheStats
+{
+    float acmr;     // Average cache miss ratio: transformed vertices per triangle
+    float atvr;     // Average transform to vertex ratio: transformed vertices per unique vertex
+};
+
+namespace meshopt
+{
+    const int CACHE_SIZE = 32;              // Modelled cache size for the Forsyth scores
+    const float CACHE_DECAY_POWER = 1.5f;
+    const float LAST_TRIANGLE_SCORE = 0.75f;
+    const float VALENCE_BOOST_SCALE = 2.0f;
+    const float VALENCE_BOOST_POWER = 0.5f;
+
+    inline float vertexScore(int cachePosition, int remainingTriangles)
+    {
+        if (remainingTriangles == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            // The three vertices of the last triangle get a fixed score so it is not simply repeated
+            if (cachePosition < 3)
+                score = LAST_TRIANGLE_SCORE;
+            else
+                score = std::pow(1.0f - (cachePosition - 3) / float(CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+
+        // Vertices with few triangles left are finished first so they can leave the cache
+        score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+        return score;
+    }
+}
+
+
+// Simulates a FIFO post-transform cache of the given size over the index buffer
+inline VertexCacheStats UAnalyzeVertexCache(const std::vector<GLuint>& indices, size_t vertexCount, int cacheSize = 16)
+{
+    VertexCacheStats stats = { 0.0f, 0.0f };
+    if (indices.empty() || vertexCount == 0)
+        return stats;
+
+    // Each vertex remembers the miss counter value at which it entered the cache
+    std::vector<size_t> cacheTimestamps(vertexCount, 0);
+    size_t misses = 0;
+    for (GLuint index : indices)
+    {
+        if (cacheTimestamps[index] == 0 || misses - cacheTimestamps[index] >= static_cast<size_t>(cacheSize))
+        {
+            ++misses;
+            cacheTimestamps[index] = misses;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / (indices.size() / 3);
+    stats.atvr = static_cast<float>(misses) / vertexCount;
+    return stats;
+}
+
+
+// Reorders triangles for post-transform cache locality (Tom Forsyth's linear-speed algorithm).
+// Ties are broken by triangle order, so the output only depends on the input.
+inline void UOptimizeVertexCache(std::vector<GLuint>& indices, size_t vertexCount)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Triangle adjacency per vertex
+    std::vector<int> remaining(vertexCount, 0);
+    for (GLuint index : indices)
+        ++remaining[index];
+
+    std::vector<size_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+    std::vector<size_t> adjacency(indices.size());
+    std::vector<size_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (size_t t = 0; t < triangleCount; ++t)
+        for (int k = 0; k < 3; ++k)
+            adjacency[fill[indices[t * 3 + k]]++] = t;
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertexScores[v] = meshopt::vertexScore(-1, remaining[v]);
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<GLuint> output;
+    output.reserve(indices.size());
+
+    std::vector<GLuint> cache;
+    std::vector<GLuint> nextCache;
+    size_t scanCursor = 0;
+    size_t bestTriangle = 0;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        emitted[bestTriangle] = true;
+        GLuint tri[3] = { indices[bestTriangle * 3], indices[bestTriangle * 3 + 1], indices[bestTriangle * 3 + 2] };
+        output.insert(output.end(), tri, tri + 3);
+
+        // The emitted triangle's vertices move to the front of the LRU cache
+        nextCache.assign(tri, tri + 3);
+        for (GLuint v : cache)
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                nextCache.push_back(v);
+
+        for (int k = 0; k < 3; ++k)
+            --remaining[tri[k]];
+
+        // Vertices pushed out of the cache lose their position score
+        for (size_t i = meshopt::CACHE_SIZE; i < nextCache.size(); ++i)
+        {
+            cachePosition[nextCache[i]] = -1;
+            vertexScores[nextCache[i]] = meshopt::vertexScore(-1, remaining[nextCache[i]]);
+        }
+        if (nextCache.size() > static_cast<size_t>(meshopt::CACHE_SIZE))
+            nextCache.resize(meshopt::CACHE_SIZE);
+        cache.swap(nextCache);
+
+        // Rescore the cached vertices and their pending triangles, tracking the best candidate
+        for (size_t i = 0; i < cache.size(); ++i)
+        {
+            cachePosition[cache[i]] = static_cast<int>(i);
+            vertexScores[cache[i]] = meshopt::vertexScore(static_cast<int>(i), remaining[cache[i]]);
+        }
+
+        float bestScore = -1.0f;
+        bool found = false;
+        for (GLuint v : cache)
+        {
+            for (size_t a = adjacencyOffset[v]; a < adjacencyOffset[v + 1]; ++a)
+            {
+                size_t t = adjacency[a];
+                if (emitted[t])
+                    continue;
+                float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                if (score > bestScore || (score == bestScore && t < bestTriangle))
+                {
+                    bestScore = score;
+                    bestTriangle = t;
+                    found = true;
+                }
+            }
+        }
+
+        // Nothing adjacent to the cache: restart from the first triangle not yet emitted
+        if (!found)
+        {
+            while (scanCursor < triangleCount && emitted[scanCursor])
+                ++scanCursor;
+            bestTriangle = scanCursor;
+        }
+    }
+
+    indices.swap(output);
+}
+
+
+// Reorders clusters of cache-optimized triangles so outward-facing, outer clusters draw first.
+// Clusters split where the cache simulation restarts, so post-transform locality is kept.
+inline void UOptimizeOverdraw(std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, int cacheSize = 16)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2)
+        return;
+
+    // Cluster boundaries: triangles whose three vertices all miss the cache
+    std::vector<size_t> clusterStarts;
+    std::vector<size_t> cacheTimestamps(vertices.size(), 0);
+    size_t misses = 0;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        int triangleMisses = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            GLuint index = indices[t * 3 + k];
+            if (cacheTimestamps[index] == 0 || misses - cacheTimestamps[index] >= static_cast<size_t>(cacheSize))
+            {
+                ++misses;
+                cacheTimestamps[index] = misses;
+                ++triangleMisses;
+            }
+        }
+        if (t == 0 || triangleMisses == 3)
+            clusterStarts.push_back(t);
+    }
+    clusterStarts.push_back(triangleCount);
+
+    glm::vec3 meshCentroid(0.0f);
+    for (const Vertex& v : vertices)
+        meshCentroid += v.position;
+    meshCentroid /= static_cast<float>(vertices.size());
+
+    // Sort key: how far the cluster sits out along its own facing direction
+    struct Cluster
+    {
+        size_t first;
+        size_t end;
+        float key;
+    };
+    std::vector<Cluster> clusters;
+    for (size_t c = 0; c + 1 < clusterStarts.size(); ++c)
+    {
+        // Area-weighted centroid and average normal of the cluster
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t)
+        {
+            const glm::vec3& a = vertices[indices[t * 3]].position;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& d = vertices[indices[t * 3 + 2]].position;
+            glm::vec3 areaNormal = glm::cross(b - a, d - a);
+            float triangleArea = glm::length(areaNormal);
+            centroid += (a + b + d) * (triangleArea / 3.0f);
+            normal += areaNormal;
+            area += triangleArea;
+        }
+        float normalLength = glm::length(normal);
+        float key = 0.0f;
+        if (area > 0.0f && normalLength > 0.0f)
+            key = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+        Cluster cluster = { clusterStarts[c], clusterStarts[c + 1], key };
+        clusters.push_back(cluster);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+    std::vector<GLuint> output;
+    output.reserve(indices.size());
+    for (const Cluster& cluster : clusters)
+        output.insert(output.end(), indices.begin() + cluster.first * 3, indices.begin() + cluster.end * 3);
+    indices.swap(output);
+}
+
+
+// Renumbers vertices in order of first use so vertex fetch walks the buffer linearly.
+// Vertices not referenced by any triangle are dropped.
+inline void UOptimizeVertexFetch(MeshData& mesh)
+{
+    const GLuint unused = ~0u;
+    std::vector<GLuint> remap(mesh.vertices.size(), unused);
+    std::vector<Vertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    std::vector<glm::vec4> tangents;
+    tangents.reserve(mesh.tangents.size());
+
+    for (GLuint& index : mesh.indices)
+    {
+        if (remap[index] == unused)
+        {
+            remap[index] = static_cast<GLuint>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+            if (!mesh.tangents.empty())
+                tangents.push_back(mesh.tangents[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices.swap(vertices);
+    mesh.tangents.swap(tangents);
+}
+
+
+// Runs the cache, overdraw and fetch passes and prints ACMR / ATVR before and after
+inline void UOptimizeMesh(MeshData& mesh, const char* name)
+{
+    VertexCacheStats before = UAnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+    UOptimizeVertexCache(mesh.indices, mesh.vertices.size());
+    UOptimizeOverdraw(mesh.indices, mesh.vertices);
+    UOptimizeVertexFetch(mesh);
+
+    VertexCacheStats after = UAnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+    std::cout << "INFO: Mesh " << name << " vertex cache: ACMR " << before.acmr << " -> " << after.acmr
+        << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+}
+#endif
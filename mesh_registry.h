@@ -0,0 +1,528 @@
+#ifndef MESH_REGISTRY_H
+#define MESH_REGISTRY_H
+
+#include <include/GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <iostream>
+
+#include "mesh.h"
+#include "vertex_pack.h"
+#include "meshlet.h"
+#include "gl_state.h"
+
+// Location of a mesh inside the shared vertex / index arena
+struct GLMesh
+{
+    GLint baseVertex;   // Offset of the mesh's first vertex in the vertex buffer
+    GLuint firstIndex;  // Offset of the mesh's first index, in units of indexType
+    GLsizei nIndices;   // Number of indices of the mesh
+    GLuint nVertices;   // Number of unique vertices of the mesh
+    GLenum indexType;   // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    VertexLayout layout;        // Which arena the mesh lives in
+    Quantization quantization;  // Identity for float meshes
+    GLuint firstMeshlet;        // Range in the registry's meshlet list; nMeshlets is 0 for unclustered meshes
+    GLuint nMeshlets;
+    MeshBounds bounds;          // Mesh-space AABB and sphere, before quantization
+    GLint positionBaseVertex;   // Position-only stream; without one these equal baseVertex and
+    GLuint positionFirstIndex;  // firstIndex, and positionVertices is 0
+    GLuint positionVertices;
+    bool live;          // False once the mesh has been removed
+
+    GLint streamBaseVertex(VertexStream stream) const { return stream == VERTEX_STREAM_POSITION ? positionBaseVertex : baseVertex; }
+    GLuint streamFirstIndex(VertexStream stream) const { return stream == VERTEX_STREAM_POSITION ? positionFirstIndex : firstIndex; }
+};
+
+// Sub-allocates every mesh from one vertex buffer and one index buffer behind a single VAO
+// per vertex layout. Meshes are appended at the end of their arena; removed meshes leave
+// holes until compact() runs.
+//
+// With setPositionStreams(true) every mesh also gets a position-only copy in a second set of
+// arenas, welded by position and drawn with its own index range, for passes that write depth
+// alone: a float vertex fetch drops from 32 to 12 bytes, a packed one from 16 to 8, and vertices
+// split only by normal or uv are transformed once.
+class MeshRegistry
+{
+public:
+    MeshRegistry() : boundLayout(VERTEX_LAYOUT_COUNT), boundStream(VERTEX_STREAM_FULL), validatePacking(false),
+        positionStreams(false), state(nullptr) {}
+
+    // Creates the VAOs and the initial buffers (capacities in vertices and index bytes)
+    void create(GLuint initialVertices = 4096, GLsizeiptr initialIndexBytes = 4096 * sizeof(GLuint))
+    {
+        for (int layout = 0; layout < VERTEX_LAYOUT_COUNT; ++layout)
+        {
+            Arena& arena = arenas[layout];
+            arena.layout = static_cast<VertexLayout>(layout);
+            arena.stride = UVertexStride(arena.layout);
+
+            // Vertex format is fixed once; only the buffer binding changes when the arena grows
+            glGenVertexArrays(1, &arena.vao);
+            bindVertexArray(arena.vao);
+            USetVertexFormat(arena.layout);
+            bindVertexArray(0);
+
+            reallocate(arena, initialVertices, initialIndexBytes, false);
+
+            if (!positionStreams)
+                continue;
+            Arena& positions = positionArenas[layout];
+            positions.layout = arena.layout;
+            positions.stride = UPositionStride(positions.layout);
+            positions.positions = true;
+            glGenVertexArrays(1, &positions.vao);
+            bindVertexArray(positions.vao);
+            USetPositionFormat(positions.layout);
+            bindVertexArray(0);
+            reallocate(positions, initialVertices, initialIndexBytes, false);
+        }
+    }
+
+    void destroy()
+    {
+        for (Arena* set : { arenas, positionArenas })
+            for (int layout = 0; layout < VERTEX_LAYOUT_COUNT; ++layout)
+            {
+                Arena& arena = set[layout];
+                if (arena.vao)
+                {
+                    glDeleteVertexArrays(1, &arena.vao);
+                    glDeleteBuffers(1, &arena.vbo);
+                    glDeleteBuffers(1, &arena.ibo);
+                }
+                arena = Arena();
+            }
+        meshes.clear();
+        freeSlots.clear();
+        meshlets.clear();
+    }
+
+    // Prints the maximum packed-layout error of every mesh added with VERTEX_LAYOUT_PACKED
+    void setValidatePacking(bool enabled) { validatePacking = enabled; }
+
+    // Builds a position-only stream for every mesh; set before create()
+    void setPositionStreams(bool enabled) { positionStreams = enabled; }
+    bool hasPositionStreams() const { return positionStreams; }
+
+    // Routes every VAO bind through the cache so its shadow state stays current
+    void setStateCache(GLStateCache* cache) { state = cache; }
+
+    // Uploads the mesh into the arena of the given layout, growing it if needed, and returns its handle.
+    // With buildMeshlets the mesh is also split into clusters for per-cluster culling.
+    GLuint add(const MeshData& data, VertexLayout layout = VERTEX_LAYOUT_FLOAT, bool buildMeshlets = false)
+    {
+        GLenum indexType = UIndexType(data);
+        std::vector<unsigned char> indices = UPackIndices(data, indexType);
+
+        Quantization quantization = { glm::vec3(0.0f), glm::vec3(1.0f) };
+        if (layout == VERTEX_LAYOUT_PACKED)
+            quantization = UComputeQuantization(data);
+        std::vector<unsigned char> vertices = UPackVertices(data, layout, quantization);
+
+        if (validatePacking && layout == VERTEX_LAYOUT_PACKED)
+        {
+            PackingError error = UMeasurePackingError(data);
+            std::cout << "INFO: Packed mesh " << meshes.size() << " max error: position " << error.position
+                << ", normal " << error.normal << " deg, uv " << error.texCoord << std::endl;
+        }
+
+        GLuint handle = addRaw(layout, vertices.data(), static_cast<GLuint>(data.vertices.size()),
+            indices.data(), static_cast<GLsizei>(data.indices.size()), indexType, quantization, UComputeBounds(data));
+
+        if (buildMeshlets)
+        {
+            std::vector<Meshlet> clusters;
+            UBuildMeshlets(data, clusters);
+            meshes[handle].firstMeshlet = static_cast<GLuint>(meshlets.size());
+            meshes[handle].nMeshlets = static_cast<GLuint>(clusters.size());
+            meshlets.insert(meshlets.end(), clusters.begin(), clusters.end());
+        }
+        return handle;
+    }
+
+    // Uploads vertices already in the given layout and indices of indexType without converting them,
+    // e.g. straight out of a mapped .mesh file. quantization is the one the positions were packed with;
+    // bounds are in mesh space.
+    GLuint addRaw(VertexLayout layout, const void* vertexData, GLuint vertexCount,
+        const void* indexData, GLsizei indexCount, GLenum indexType, const Quantization& quantization, const MeshBounds& bounds)
+    {
+        GLMesh mesh;
+        append(arenas[layout], vertexData, vertexCount, indexData, indexCount, indexType, mesh.baseVertex, mesh.firstIndex);
+        mesh.positionBaseVertex = mesh.baseVertex;
+        mesh.positionFirstIndex = mesh.firstIndex;
+        mesh.positionVertices = 0;
+        if (positionStreams)
+        {
+            std::vector<unsigned char> positions, positionIndices;
+            mesh.positionVertices = UBuildPositionStream(layout, vertexData, vertexCount, indexData, indexCount, indexType,
+                positions, positionIndices);
+            append(positionArenas[layout], positions.data(), mesh.positionVertices, positionIndices.data(), indexCount, indexType,
+                mesh.positionBaseVertex, mesh.positionFirstIndex);
+        }
+        mesh.nIndices = indexCount;
+        mesh.nVertices = vertexCount;
+        mesh.indexType = indexType;
+        mesh.layout = layout;
+        mesh.quantization = quantization;
+        mesh.firstMeshlet = 0;
+        mesh.nMeshlets = 0;
+        mesh.bounds = bounds;
+        mesh.live = true;
+
+        GLuint handle;
+        if (!freeSlots.empty())
+        {
+            handle = freeSlots.back();
+            freeSlots.pop_back();
+            meshes[handle] = mesh;
+        }
+        else
+        {
+            handle = static_cast<GLuint>(meshes.size());
+            meshes.push_back(mesh);
+        }
+        if (positionStreams)
+            printPositionStream(handle);
+        return handle;
+    }
+
+    // Releases the mesh's handle; its arena space is reclaimed by the next compact()
+    void remove(GLuint handle)
+    {
+        if (handle >= meshes.size() || !meshes[handle].live)
+            return;
+        meshes[handle].live = false;
+        freeSlots.push_back(handle);
+    }
+
+    // Repacks all live meshes to the front of fresh buffers, dropping holes left by removed meshes
+    void compact()
+    {
+        for (Arena& arena : arenas)
+            compact(arena);
+        for (Arena& arena : positionArenas)
+            compact(arena);
+        // Without position streams the position ranges follow the full ones
+        if (!positionStreams)
+            for (GLMesh& mesh : meshes)
+            {
+                mesh.positionBaseVertex = mesh.baseVertex;
+                mesh.positionFirstIndex = mesh.firstIndex;
+            }
+
+        std::vector<Meshlet> liveMeshlets;
+        for (GLMesh& mesh : meshes)
+        {
+            if (!mesh.live || mesh.nMeshlets == 0)
+                continue;
+            GLuint first = static_cast<GLuint>(liveMeshlets.size());
+            liveMeshlets.insert(liveMeshlets.end(), meshlets.begin() + mesh.firstMeshlet, meshlets.begin() + mesh.firstMeshlet + mesh.nMeshlets);
+            mesh.firstMeshlet = first;
+        }
+        meshlets.swap(liveMeshlets);
+    }
+
+    // Binds the float arena's VAO; every float mesh can then be drawn without further VAO switches
+    void bind()
+    {
+        bind(VERTEX_LAYOUT_FLOAT);
+    }
+
+    // Without position streams VERTEX_STREAM_POSITION binds the full stream, which every mesh's
+    // position range then points into
+    void bind(VertexLayout layout, VertexStream stream = VERTEX_STREAM_FULL)
+    {
+        bindVertexArray(vertexArray(layout, stream));
+        boundLayout = layout;
+        boundStream = stream;
+    }
+
+    void unbind()
+    {
+        bindVertexArray(0);
+        boundLayout = VERTEX_LAYOUT_COUNT;
+    }
+
+    // Draws one mesh, switching VAO only when the mesh lives in a different layout's arena
+    void draw(GLuint handle, VertexStream stream = VERTEX_STREAM_FULL)
+    {
+        const GLMesh& mesh = meshes[handle];
+        if (mesh.layout != boundLayout || stream != boundStream)
+            bind(mesh.layout, stream);
+        glDrawElementsBaseVertex(GL_TRIANGLES, mesh.nIndices, mesh.indexType,
+            (void*)(mesh.streamFirstIndex(stream) * UIndexSize(mesh.indexType)), mesh.streamBaseVertex(stream));
+    }
+
+    // Draws only the listed meshlets of a clustered mesh in a single multi-draw call; the position
+    // stream keeps the index order, so meshlet ranges apply to both
+    void drawMeshlets(GLuint handle, const std::vector<GLuint>& visible, VertexStream stream = VERTEX_STREAM_FULL)
+    {
+        if (visible.empty())
+            return;
+
+        const GLMesh& mesh = meshes[handle];
+        if (mesh.layout != boundLayout || stream != boundStream)
+            bind(mesh.layout, stream);
+
+        size_t indexSize = UIndexSize(mesh.indexType);
+        drawCounts.resize(visible.size());
+        drawOffsets.resize(visible.size());
+        drawBaseVertices.assign(visible.size(), mesh.streamBaseVertex(stream));
+        for (size_t i = 0; i < visible.size(); ++i)
+        {
+            const Meshlet& meshlet = meshlets[visible[i]];
+            drawCounts[i] = static_cast<GLsizei>(meshlet.triangleCount * 3);
+            drawOffsets[i] = (void*)((mesh.streamFirstIndex(stream) + meshlet.firstIndex) * indexSize);
+        }
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, drawCounts.data(), mesh.indexType, drawOffsets.data(),
+            static_cast<GLsizei>(visible.size()), drawBaseVertices.data());
+    }
+
+    // Matrix mapping the mesh's stored positions to mesh space; fold it into the model matrix
+    glm::mat4 dequantize(GLuint handle) const
+    {
+        const Quantization& q = meshes[handle].quantization;
+        return glm::translate(q.offset) * glm::scale(q.scale);
+    }
+
+    const GLMesh& mesh(GLuint handle) const { return meshes[handle]; }
+    const std::vector<Meshlet>& allMeshlets() const { return meshlets; }
+    GLuint vertexArray(VertexLayout layout = VERTEX_LAYOUT_FLOAT, VertexStream stream = VERTEX_STREAM_FULL) const
+    {
+        return stream == VERTEX_STREAM_POSITION && positionStreams ? positionArenas[layout].vao : arenas[layout].vao;
+    }
+    GLuint vertexBuffer(VertexLayout layout = VERTEX_LAYOUT_FLOAT) const { return arenas[layout].vbo; }
+    GLuint indexBuffer(VertexLayout layout = VERTEX_LAYOUT_FLOAT) const { return arenas[layout].ibo; }
+
+    // Prints arena usage, including space held by removed meshes
+    void printStats() const
+    {
+        std::cout << "INFO: Mesh arena: " << (meshes.size() - freeSlots.size()) << " meshes" << std::endl;
+        for (const Arena* set : { arenas, positionArenas })
+            for (int layout = 0; layout < VERTEX_LAYOUT_COUNT; ++layout)
+            {
+                const Arena& arena = set[layout];
+                if (!arena.vao)
+                    continue;
+                std::cout << "INFO:   " << (arena.layout == VERTEX_LAYOUT_PACKED ? "packed" : "float")
+                    << (arena.positions ? " position" : "") << " arena (" << arena.stride << " bytes/vertex): "
+                    << liveVertices(arena) << "/" << arena.vertexCount << "/" << arena.vertexCapacity << " vertices (live/used/capacity), "
+                    << liveIndexBytes(arena) << "/" << arena.indexBytes << "/" << arena.indexCapacity << " index bytes" << std::endl;
+            }
+    }
+
+private:
+    // One vertex buffer, index buffer and VAO holding every mesh of a single layout, either their
+    // full vertices or their position streams
+    struct Arena
+    {
+        Arena() : layout(VERTEX_LAYOUT_FLOAT), positions(false), stride(0), vao(0), vbo(0), ibo(0), vertexCapacity(0), vertexCount(0),
+            indexCapacity(0), indexBytes(0) {}
+
+        VertexLayout layout;
+        bool positions;
+        size_t stride;
+        GLuint vao;
+        GLuint vbo;
+        GLuint ibo;
+        GLuint vertexCapacity;
+        GLuint vertexCount;
+        GLsizeiptr indexCapacity;
+        GLsizeiptr indexBytes;
+    };
+
+    Arena arenas[VERTEX_LAYOUT_COUNT];
+    Arena positionArenas[VERTEX_LAYOUT_COUNT];  // Unused without position streams
+    VertexLayout boundLayout;
+    VertexStream boundStream;
+    bool validatePacking;
+    bool positionStreams;
+    GLStateCache* state;
+
+    void bindVertexArray(GLuint vao)
+    {
+        if (state)
+            state->bindVertexArray(vao);
+        else
+            glBindVertexArray(vao);
+    }
+    std::vector<GLMesh> meshes;
+    std::vector<GLuint> freeSlots;
+    std::vector<Meshlet> meshlets;
+
+    // Scratch arrays reused by drawMeshlets
+    std::vector<GLsizei> drawCounts;
+    std::vector<void*> drawOffsets;
+    std::vector<GLint> drawBaseVertices;
+
+    // The mesh's range in the arena's stream
+    static GLint& baseVertexIn(GLMesh& mesh, const Arena& arena) { return arena.positions ? mesh.positionBaseVertex : mesh.baseVertex; }
+    static GLuint& firstIndexIn(GLMesh& mesh, const Arena& arena) { return arena.positions ? mesh.positionFirstIndex : mesh.firstIndex; }
+    static GLuint verticesIn(const GLMesh& mesh, const Arena& arena) { return arena.positions ? mesh.positionVertices : mesh.nVertices; }
+
+    // Appends a mesh's vertices and indices to the arena, growing it if needed
+    void append(Arena& arena, const void* vertexData, GLuint vertexCount, const void* indexData, GLsizei indexCount, GLenum indexType,
+        GLint& baseVertex, GLuint& firstIndex)
+    {
+        size_t indexSize = UIndexSize(indexType);
+
+        // Indices of each mesh start on a multiple of their own size
+        GLsizeiptr indexOffset = (arena.indexBytes + indexSize - 1) / indexSize * indexSize;
+        GLuint neededVertices = arena.vertexCount + vertexCount;
+        GLsizeiptr neededIndexBytes = indexOffset + static_cast<GLsizeiptr>(indexCount * indexSize);
+
+        if (neededVertices > arena.vertexCapacity || neededIndexBytes > arena.indexCapacity)
+            reallocate(arena, std::max(neededVertices, arena.vertexCapacity * 2), std::max(neededIndexBytes, arena.indexCapacity * 2), true);
+
+        baseVertex = static_cast<GLint>(arena.vertexCount);
+        firstIndex = static_cast<GLuint>(indexOffset / indexSize);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, arena.vbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, arena.vertexCount * arena.stride, vertexCount * arena.stride, vertexData);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, arena.ibo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset, indexCount * indexSize, indexData);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        arena.vertexCount = neededVertices;
+        arena.indexBytes = neededIndexBytes;
+    }
+
+    // Vertex count and the bytes a depth pass fetches for one draw, each vertex read once, from the
+    // full stream against the position stream
+    void printPositionStream(GLuint handle) const
+    {
+        const GLMesh& mesh = meshes[handle];
+        size_t fullBytes = mesh.nVertices * UVertexStride(mesh.layout);
+        size_t positionBytes = mesh.positionVertices * UPositionStride(mesh.layout);
+        std::cout << "INFO: Position stream of mesh " << handle << ": " << mesh.nVertices << " -> " << mesh.positionVertices
+            << " vertices (-" << (mesh.nVertices ? 100.0 * (mesh.nVertices - mesh.positionVertices) / mesh.nVertices : 0.0)
+            << "%), " << UVertexStride(mesh.layout) << " -> " << UPositionStride(mesh.layout) << " bytes/vertex, "
+            << fullBytes / 1024.0 << " -> " << positionBytes / 1024.0 << " KB fetched per depth draw (-"
+            << (fullBytes ? 100.0 * (fullBytes - positionBytes) / fullBytes : 0.0) << "%)" << std::endl;
+    }
+
+    GLuint liveVertices(const Arena& arena) const
+    {
+        GLuint total = 0;
+        for (const GLMesh& mesh : meshes)
+            if (mesh.live && mesh.layout == arena.layout)
+                total += verticesIn(mesh, arena);
+        return total;
+    }
+
+    // Upper bound including alignment padding between meshes of different index types
+    GLsizeiptr liveIndexBytes(const Arena& arena) const
+    {
+        GLsizeiptr total = 0;
+        for (const GLMesh& mesh : meshes)
+            if (mesh.live && mesh.layout == arena.layout)
+                total += mesh.nIndices * UIndexSize(mesh.indexType) + sizeof(GLuint);
+        return total;
+    }
+
+    void compact(Arena& arena)
+    {
+        if (!arena.vao)
+            return;
+        GLuint newVertexCapacity = std::max<GLuint>(liveVertices(arena), 1);
+        GLsizeiptr newIndexCapacity = std::max<GLsizeiptr>(liveIndexBytes(arena), sizeof(GLuint));
+
+        GLuint newVbo, newIbo;
+        allocateBuffers(arena, newVertexCapacity, newIndexCapacity, newVbo, newIbo);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, arena.vbo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newVbo);
+        GLuint vertexCursor = 0;
+        for (GLMesh& mesh : meshes)
+        {
+            if (!mesh.live || mesh.layout != arena.layout)
+                continue;
+            GLint& baseVertex = baseVertexIn(mesh, arena);
+            GLuint vertices = verticesIn(mesh, arena);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                baseVertex * arena.stride, vertexCursor * arena.stride, vertices * arena.stride);
+            baseVertex = static_cast<GLint>(vertexCursor);
+            vertexCursor += vertices;
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, arena.ibo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newIbo);
+        GLsizeiptr indexCursor = 0;
+        for (GLMesh& mesh : meshes)
+        {
+            if (!mesh.live || mesh.layout != arena.layout)
+                continue;
+            size_t indexSize = UIndexSize(mesh.indexType);
+            GLuint& firstIndex = firstIndexIn(mesh, arena);
+            indexCursor = (indexCursor + indexSize - 1) / indexSize * indexSize;
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                firstIndex * indexSize, indexCursor, mesh.nIndices * indexSize);
+            firstIndex = static_cast<GLuint>(indexCursor / indexSize);
+            indexCursor += mesh.nIndices * indexSize;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        replaceBuffers(arena, newVbo, newIbo, newVertexCapacity, newIndexCapacity);
+        arena.vertexCount = vertexCursor;
+        arena.indexBytes = indexCursor;
+    }
+
+    void allocateBuffers(const Arena& arena, GLuint vertices, GLsizeiptr indexCapacityBytes, GLuint& newVbo, GLuint& newIbo)
+    {
+        glGenBuffers(1, &newVbo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newVbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, vertices * arena.stride, nullptr, GL_STATIC_DRAW);
+
+        glGenBuffers(1, &newIbo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newIbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, indexCapacityBytes, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    // Points the VAO at the new buffers and frees the old ones
+    void replaceBuffers(Arena& arena, GLuint newVbo, GLuint newIbo, GLuint newVertexCapacity, GLsizeiptr newIndexCapacity)
+    {
+        bindVertexArray(arena.vao);
+        glBindVertexBuffer(0, newVbo, 0, static_cast<GLsizei>(arena.stride));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, newIbo);
+        bindVertexArray(0);
+        boundLayout = VERTEX_LAYOUT_COUNT;
+
+        glDeleteBuffers(1, &arena.vbo);
+        glDeleteBuffers(1, &arena.ibo);
+        arena.vbo = newVbo;
+        arena.ibo = newIbo;
+        arena.vertexCapacity = newVertexCapacity;
+        arena.indexCapacity = newIndexCapacity;
+    }
+
+    // Grows the arena, optionally keeping the data already uploaded
+    void reallocate(Arena& arena, GLuint newVertexCapacity, GLsizeiptr newIndexCapacity, bool keepContents)
+    {
+        GLuint newVbo, newIbo;
+        allocateBuffers(arena, newVertexCapacity, newIndexCapacity, newVbo, newIbo);
+
+        if (keepContents)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, arena.vbo);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, newVbo);
+            if (arena.vertexCount > 0)
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, arena.vertexCount * arena.stride);
+
+            glBindBuffer(GL_COPY_READ_BUFFER, arena.ibo);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, newIbo);
+            if (arena.indexBytes > 0)
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, arena.indexBytes);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+
+        replaceBuffers(arena, newVbo, newIbo, newVertexCapacity, newIndexCapacity);
+    }
+};
+#endif
@@ -0,0 +1,367 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "mesh.h"
+#include "mesh_normals.h"   // Position grouping and corner lists
+#include "mesh_optimize.h"  // Vertex fetch compaction
+
+/* Quadric error metric simplification (Garland and Heckbert) by half-edge collapses, so every
+ * surviving vertex keeps its exact attributes and no new vertices are made.
+ * Vertices are classified each pass by where they sit:
+ *   manifold   interior vertex with one set of attributes; may collapse along any edge
+ *   border     on a straight stretch of an open edge of the surface; may only slide along that border
+ *   seam       two attribute copies (uv / normal split) at one position; both copies move together
+ *              along the seam so the two sides stay stitched
+ *   locked     anything more complex (border corners, non-manifold fans, border seams); never moves
+ *
+ * Each pass sorts the allowed collapses by error and applies the cheapest ones that do not touch,
+ * stopping early where the error climbs well above the pass's cheapest, so a costly collapse waits
+ * for the next pass and competes with the collapses that are cheap by then.
+ */
+
+namespace meshsimplify
+{
+    // Border and seam edges resist sliding off their line this much more than faces resist bending
+    const double EDGE_WEIGHT = 10.0;
+    // Collapses may rotate a surrounding triangle's normal by up to about 75 degrees
+    const double MIN_NORMAL_COSINE = 0.25;
+    // A border that turns by more than about 25 degrees at a vertex makes it a locked corner
+    const double MIN_BORDER_COSINE = 0.9;
+    // A pass stops at collapses this many times costlier than its cheapest one...
+    const float PASS_ERROR_GROWTH = 4.0f;
+    // ...unless they are below this fraction of the mesh's bounding radius
+    const float NEGLIGIBLE_ERROR = 1e-4f;
+    // A level that keeps more than this fraction of the previous level's triangles ends the LOD chain
+    const float MIN_LOD_REDUCTION = 0.9f;
+
+    enum VertexKind { KIND_MANIFOLD, KIND_BORDER, KIND_SEAM, KIND_LOCKED };
+
+    // Sum of squared distances to a set of weighted planes: v'Av + 2b'v + c, over the total weight
+    struct Quadric
+    {
+        double a00, a11, a22, a01, a02, a12;
+        double b0, b1, b2;
+        double c;
+        double weight;
+
+        void addPlane(const glm::dvec3& n, double d, double w)
+        {
+            a00 += w * n.x * n.x; a11 += w * n.y * n.y; a22 += w * n.z * n.z;
+            a01 += w * n.x * n.y; a02 += w * n.x * n.z; a12 += w * n.y * n.z;
+            b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+            c += w * d * d;
+            weight += w;
+        }
+        void add(const Quadric& q)
+        {
+            a00 += q.a00; a11 += q.a11; a22 += q.a22; a01 += q.a01; a02 += q.a02; a12 += q.a12;
+            b0 += q.b0; b1 += q.b1; b2 += q.b2; c += q.c; weight += q.weight;
+        }
+        // Root mean square distance of p from the planes, in mesh units
+        double error(const Quadric& other, const glm::vec3& p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            double e = (a00 + other.a00) * x * x + (a11 + other.a11) * y * y + (a22 + other.a22) * z * z
+                + 2.0 * ((a01 + other.a01) * x * y + (a02 + other.a02) * x * z + (a12 + other.a12) * y * z)
+                + 2.0 * ((b0 + other.b0) * x + (b1 + other.b1) * y + (b2 + other.b2) * z) + c + other.c;
+            double w = weight + other.weight;
+            return w > 0.0 ? std::sqrt(std::max(e, 0.0) / w) : 0.0;
+        }
+    };
+
+    // Triangle corners grouped by a per-vertex key (the vertex itself or its position), so the edges
+    // leaving a key can be walked; an edge whose twin running the other way is missing is open
+    struct EdgeIndex
+    {
+        std::vector<GLuint> cornerKeys;
+        meshnormals::CornerGroups groups;
+
+        void build(const std::vector<GLuint>& indices, const std::vector<GLuint>& key, size_t keyCount)
+        {
+            cornerKeys.resize(indices.size());
+            for (size_t c = 0; c < indices.size(); ++c)
+                cornerKeys[c] = key[indices[c]];
+            groups.build(cornerKeys, keyCount);
+        }
+        bool has(GLuint a, GLuint b) const
+        {
+            for (GLuint i = groups.offsets[a]; i < groups.offsets[a + 1]; ++i)
+            {
+                GLuint c = groups.corners[i];
+                if (cornerKeys[c - c % 3 + (c % 3 + 1) % 3] == b)
+                    return true;
+            }
+            return false;
+        }
+        bool open(GLuint a, GLuint b) const { return has(a, b) != has(b, a); }
+    };
+
+    struct Collapse
+    {
+        GLuint source;
+        GLuint target;
+        float error;
+    };
+
+    // Whether moving vertex source onto target's position turns any surviving triangle around it over
+    inline bool flips(const MeshData& mesh, const std::vector<GLuint>& position, const meshnormals::CornerGroups& vertexCorners, GLuint source, GLuint target)
+    {
+        const glm::vec3& to = mesh.vertices[target].position;
+        for (GLuint i = vertexCorners.offsets[source]; i < vertexCorners.offsets[source + 1]; ++i)
+        {
+            GLuint corner = vertexCorners.corners[i];
+            const GLuint* tri = &mesh.indices[corner - corner % 3];
+            GLuint k = corner % 3;
+            GLuint b = tri[(k + 1) % 3], c = tri[(k + 2) % 3];
+            if (position[b] == position[target] || position[c] == position[target])
+                continue;   // Collapses to a degenerate triangle and is removed
+
+            glm::dvec3 pb(mesh.vertices[b].position), pc(mesh.vertices[c].position);
+            glm::dvec3 before = glm::cross(pb - glm::dvec3(mesh.vertices[source].position), pc - glm::dvec3(mesh.vertices[source].position));
+            glm::dvec3 after = glm::cross(pb - glm::dvec3(to), pc - glm::dvec3(to));
+            if (glm::dot(before, after) < MIN_NORMAL_COSINE * glm::length(before) * glm::length(after))
+                return true;
+        }
+        return false;
+    }
+}
+
+
+// Collapses edges of mesh in order of quadric error until it has at most targetTriangles triangles,
+// no allowed collapse is left, or the next one would exceed maxError (mesh units). Unused vertices
+// are dropped. Returns the largest error of the collapses made, in mesh units.
+inline float USimplifyMesh(MeshData& mesh, size_t targetTriangles, float maxError = FLT_MAX)
+{
+    using namespace meshsimplify;
+    size_t vertexCount = mesh.vertices.size();
+    if (mesh.indices.size() / 3 <= targetTriangles || vertexCount == 0)
+        return 0.0f;
+
+    // Attribute copies of one point share a position id; quadrics live on positions
+    std::unordered_map<glm::vec3, GLuint, meshnormals::PositionHash, meshnormals::PositionEqual> positionIds;
+    positionIds.reserve(vertexCount);
+    std::vector<GLuint> position(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        position[v] = positionIds.emplace(mesh.vertices[v].position, static_cast<GLuint>(positionIds.size())).first->second;
+    size_t positionCount = positionIds.size();
+    std::vector<GLuint> identity(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        identity[v] = static_cast<GLuint>(v);
+
+    // Face planes weighted by area, plus planes through border and seam edges perpendicular to their face
+    std::vector<Quadric> quadrics(positionCount, Quadric());
+    EdgeIndex positionEdges, vertexEdges;
+    positionEdges.build(mesh.indices, position, positionCount);
+    vertexEdges.build(mesh.indices, identity, vertexCount);
+    for (size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+        glm::dvec3 p[3];
+        for (int k = 0; k < 3; ++k)
+            p[k] = glm::dvec3(mesh.vertices[mesh.indices[i + k]].position);
+        glm::dvec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+        double area = glm::length(normal);
+        if (area == 0.0)
+            continue;
+        normal /= area;
+        for (int k = 0; k < 3; ++k)
+            quadrics[position[mesh.indices[i + k]]].addPlane(normal, -glm::dot(normal, p[0]), area * 0.5);
+
+        for (int k = 0; k < 3; ++k)
+        {
+            GLuint a = mesh.indices[i + k], b = mesh.indices[i + (k + 1) % 3];
+            if (!positionEdges.open(position[a], position[b]) && !vertexEdges.open(a, b))
+                continue;
+            glm::dvec3 edge = p[(k + 1) % 3] - p[k];
+            double length = glm::length(edge);
+            if (length == 0.0)
+                continue;
+            glm::dvec3 side = glm::normalize(glm::cross(edge, normal));
+            quadrics[position[a]].addPlane(side, -glm::dot(side, p[k]), EDGE_WEIGHT * length * length);
+            quadrics[position[b]].addPlane(side, -glm::dot(side, p[k]), EDGE_WEIGHT * length * length);
+        }
+    }
+
+    double worstError = 0.0;
+    std::vector<VertexKind> kinds(positionCount);
+    std::vector<GLuint> wedges(positionCount), firstWedge(positionCount), partner(vertexCount);
+    std::vector<unsigned char> openPositionEdges(positionCount), openVertexEdges(vertexCount), locked(positionCount);
+    std::vector<GLuint> borderEnds(positionCount * 2);  // Other ends of a position's first two open edges
+    float negligibleError = NEGLIGIBLE_ERROR * UComputeBounds(mesh).radius;
+    std::vector<GLuint> remap(vertexCount);
+    std::vector<Collapse> candidates;
+    const meshnormals::CornerGroups& vertexCorners = vertexEdges.groups;
+
+    while (mesh.indices.size() / 3 > targetTriangles)
+    {
+        // Classify the positions still referenced
+        positionEdges.build(mesh.indices, position, positionCount);
+        vertexEdges.build(mesh.indices, identity, vertexCount);
+        std::fill(wedges.begin(), wedges.end(), 0);
+        std::fill(openPositionEdges.begin(), openPositionEdges.end(), 0);
+        std::fill(openVertexEdges.begin(), openVertexEdges.end(), 0);
+        std::fill(partner.begin(), partner.end(), ~0u);
+        for (GLuint v = 0; v < vertexCount; ++v)
+        {
+            if (vertexCorners.offsets[v] == vertexCorners.offsets[v + 1])
+                continue;
+            GLuint p = position[v];
+            if (wedges[p]++ == 0)
+                firstWedge[p] = v;
+            else
+            {
+                partner[v] = firstWedge[p];
+                partner[firstWedge[p]] = v;
+            }
+        }
+        for (size_t i = 0; i < mesh.indices.size(); i += 3)
+            for (int k = 0; k < 3; ++k)
+            {
+                GLuint a = mesh.indices[i + k], b = mesh.indices[i + (k + 1) % 3];
+                if (positionEdges.open(position[a], position[b]))
+                {
+                    for (GLuint end = 0; end < 2; ++end)
+                    {
+                        GLuint p = position[end == 0 ? a : b], other = position[end == 0 ? b : a];
+                        if (openPositionEdges[p] < 2)
+                            borderEnds[p * 2 + openPositionEdges[p]] = other;
+                        openPositionEdges[p] = static_cast<unsigned char>(std::min(openPositionEdges[p] + 1, 255));
+                    }
+                }
+                if (vertexEdges.open(a, b))
+                {
+                    openVertexEdges[a] = static_cast<unsigned char>(std::min(openVertexEdges[a] + 1, 255));
+                    openVertexEdges[b] = static_cast<unsigned char>(std::min(openVertexEdges[b] + 1, 255));
+                }
+            }
+        // A border vertex may slide only where its two border edges continue each other's line
+        auto straightBorder = [&](size_t p)
+        {
+            glm::dvec3 at(mesh.vertices[firstWedge[p]].position);
+            glm::dvec3 in = glm::dvec3(mesh.vertices[firstWedge[borderEnds[p * 2]]].position) - at;
+            glm::dvec3 out = glm::dvec3(mesh.vertices[firstWedge[borderEnds[p * 2 + 1]]].position) - at;
+            return glm::dot(in, out) < -MIN_BORDER_COSINE * glm::length(in) * glm::length(out);
+        };
+        for (size_t p = 0; p < positionCount; ++p)
+        {
+            if (wedges[p] == 1)
+                kinds[p] = openPositionEdges[p] == 0 ? KIND_MANIFOLD
+                    : openPositionEdges[p] == 2 && straightBorder(p) ? KIND_BORDER : KIND_LOCKED;
+            else if (wedges[p] == 2 && openPositionEdges[p] == 0 && openVertexEdges[firstWedge[p]] == 2 && openVertexEdges[partner[firstWedge[p]]] == 2)
+                kinds[p] = KIND_SEAM;
+            else
+                kinds[p] = KIND_LOCKED;
+        }
+
+        // Cheapest allowed direction of every edge
+        candidates.clear();
+        for (size_t i = 0; i < mesh.indices.size(); i += 3)
+            for (int k = 0; k < 3; ++k)
+            {
+                GLuint a = mesh.indices[i + k], b = mesh.indices[i + (k + 1) % 3];
+                if (a > b && !vertexEdges.open(a, b))
+                    continue;   // Interior edges are seen from both sides; take them once
+                Collapse best = { 0, 0, FLT_MAX };
+                for (int direction = 0; direction < 2; ++direction)
+                {
+                    GLuint s = direction == 0 ? a : b, t = direction == 0 ? b : a;
+                    VertexKind kind = kinds[position[s]];
+                    bool allowed = kind == KIND_MANIFOLD
+                        || (kind == KIND_BORDER && positionEdges.open(position[s], position[t]))
+                        || (kind == KIND_SEAM && kinds[position[t]] == KIND_SEAM && vertexEdges.open(s, t)
+                            && vertexEdges.open(partner[s], partner[t]));
+                    if (!allowed)
+                        continue;
+                    float error = static_cast<float>(quadrics[position[s]].error(quadrics[position[t]], mesh.vertices[t].position));
+                    if (error < best.error)
+                        best = { s, t, error };
+                }
+                if (best.error <= maxError)
+                    candidates.push_back(best);
+            }
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+        // Apply the cheapest collapses whose neighbourhoods do not overlap; each removes about two
+        // triangles. Past the first, none costs more than PASS_ERROR_GROWTH times the cheapest
+        size_t wanted = (mesh.indices.size() / 3 - targetTriangles + 1) / 2;
+        size_t applied = 0;
+        float errorLimit = candidates.empty() ? 0.0f : std::max(candidates.front().error * PASS_ERROR_GROWTH, negligibleError);
+        for (GLuint v = 0; v < vertexCount; ++v)
+            remap[v] = v;
+        std::fill(locked.begin(), locked.end(), 0);
+        for (const Collapse& collapse : candidates)
+        {
+            if (applied >= wanted || (applied > 0 && collapse.error > errorLimit))
+                break;
+            GLuint s = collapse.source, t = collapse.target;
+            if (locked[position[s]] || locked[position[t]] || position[s] == position[t])
+                continue;
+            bool seam = kinds[position[s]] == KIND_SEAM;
+            if (flips(mesh, position, vertexCorners, s, t) || (seam && flips(mesh, position, vertexCorners, partner[s], partner[t])))
+                continue;
+
+            remap[s] = t;
+            if (seam)
+                remap[partner[s]] = partner[t];
+            quadrics[position[t]].add(quadrics[position[s]]);
+            worstError = std::max(worstError, static_cast<double>(collapse.error));
+            ++applied;
+
+            // Triangles around s changed shape, so nothing else touching them collapses this pass
+            for (GLuint moved : { s, seam ? partner[s] : s })
+                for (GLuint i = vertexCorners.offsets[moved]; i < vertexCorners.offsets[moved + 1]; ++i)
+                {
+                    GLuint first = vertexCorners.corners[i] - vertexCorners.corners[i] % 3;
+                    for (int k = 0; k < 3; ++k)
+                        locked[position[mesh.indices[first + k]]] = 1;
+                }
+        }
+        if (applied == 0)
+            break;
+
+        // Rewrite the triangles and drop the ones that collapsed to a line
+        size_t kept = 0;
+        for (size_t i = 0; i < mesh.indices.size(); i += 3)
+        {
+            GLuint a = remap[mesh.indices[i]], b = remap[mesh.indices[i + 1]], c = remap[mesh.indices[i + 2]];
+            if (position[a] == position[b] || position[b] == position[c] || position[c] == position[a])
+                continue;
+            mesh.indices[kept++] = a;
+            mesh.indices[kept++] = b;
+            mesh.indices[kept++] = c;
+        }
+        mesh.indices.resize(kept);
+    }
+
+    UOptimizeVertexFetch(mesh);
+    return static_cast<float>(worstError);
+}
+
+
+// Builds an LOD chain from mesh: level 0 is the mesh itself and level i + 1 aims for ratios[i] of its
+// triangles, each simplified from the level before. errors receives each level's geometric error
+// in mesh units, accumulated along the chain. The chain stops early once simplification stalls.
+inline void UGenerateLods(const MeshData& mesh, const std::vector<float>& ratios, std::vector<MeshData>& lods, std::vector<float>& errors)
+{
+    lods.assign(1, mesh);
+    errors.assign(1, 0.0f);
+    size_t sourceTriangles = mesh.indices.size() / 3;
+    for (float ratio : ratios)
+    {
+        MeshData level = lods.back();
+        size_t previousTriangles = level.indices.size() / 3;
+        float error = USimplifyMesh(level, static_cast<size_t>(sourceTriangles * ratio));
+        if (level.indices.empty() || level.indices.size() / 3 > previousTriangles * meshsimplify::MIN_LOD_REDUCTION)
+            break;
+        errors.push_back(errors.back() + error);
+        lods.push_back(level);
+    }
+}
+#endif
@@ -0,0 +1,160 @@
+/* Offline converter from OBJ / glTF to the binary .mesh format read by the viewer.
+ *
+ *   meshconv <input.obj|.gltf|.glb> <output.mesh> [--packed] [--no-optimize] [--no-lods] [--threads N]
+ *   meshconv --benchmark <input> [--threads N]
+ *
+ *   --packed        store 16-byte packed vertices instead of 32-byte float vertices
+ *   --no-optimize   keep the triangle and vertex order of the source file
+ *   --no-lods       store only the source mesh instead of a simplified LOD chain
+ *   --threads N     importer threads (default: every core)
+ *   --benchmark     time the importer single threaded and with N threads, in MB/s
+ *
+ * Built as its own executable next to the viewer; it only needs the GLEW and GLM headers.
+ */
+#include <iostream>         // cout
+#include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <chrono>           // Load timing
+#include <fstream>          // Input size for the benchmark
+#include <thread>           // hardware_concurrency
+#include <string>           // LOD names
+
+#include "mesh.h"                   // Mesh data and index packing
+#include "mesh_optimize.h"          // Vertex cache, overdraw and fetch ordering
+#include "mesh_simplify.h"          // Quadric LOD simplification
+#include "mesh_import.h"            // OBJ / glTF importers
+#include "mesh_file.h"              // .mesh writer / mapper
+
+using namespace std; // Standard namespace
+
+namespace
+{
+    // Triangle ratios of the simplified LOD levels, relative to the source mesh
+    const vector<float> LOD_RATIOS = { 0.5f, 0.25f, 0.125f, 0.0625f };
+
+    double MillisecondsSince(chrono::steady_clock::time_point start)
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    // Best of a few imports, so the first run's page cache misses do not skew the result
+    double BestImportTime(const char* path, unsigned threads)
+    {
+        const int runs = 3;
+        double best = 0.0;
+        for (int run = 0; run < runs; ++run)
+        {
+            MeshData mesh;
+            auto start = chrono::steady_clock::now();
+            if (!UImportMesh(path, mesh, threads))
+                return -1.0;
+            double time = MillisecondsSince(start);
+            best = run == 0 ? time : min(best, time);
+        }
+        return best;
+    }
+
+    int Benchmark(const char* path, unsigned threads)
+    {
+        ifstream in(path, ios::binary | ios::ate);
+        double megabytes = static_cast<double>(in.tellg()) / (1024.0 * 1024.0);
+        if (threads == 0)
+            threads = max(1u, thread::hardware_concurrency());
+
+        double single = BestImportTime(path, 1);
+        double parallel = BestImportTime(path, threads);
+        if (single < 0.0 || parallel < 0.0)
+            return EXIT_FAILURE;
+
+        cout << "INFO: Import " << path << " (" << megabytes << " MB)" << endl;
+        cout << "INFO:   1 thread:   " << single << " ms, " << megabytes / (single / 1000.0) << " MB/s" << endl;
+        cout << "INFO:   " << threads << " threads: " << parallel << " ms, " << megabytes / (parallel / 1000.0) << " MB/s ("
+            << single / parallel << "x)" << endl;
+        return EXIT_SUCCESS;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* inputPath = nullptr;
+    const char* outputPath = nullptr;
+    VertexLayout layout = VERTEX_LAYOUT_FLOAT;
+    bool optimize = true;
+    bool generateLods = true;
+    bool benchmark = false;
+    unsigned threads = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--packed") == 0)
+            layout = VERTEX_LAYOUT_PACKED;
+        else if (strcmp(argv[i], "--no-optimize") == 0)
+            optimize = false;
+        else if (strcmp(argv[i], "--no-lods") == 0)
+            generateLods = false;
+        else if (strcmp(argv[i], "--benchmark") == 0)
+            benchmark = true;
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = static_cast<unsigned>(atoi(argv[++i]));
+        else if (!inputPath)
+            inputPath = argv[i];
+        else if (!outputPath)
+            outputPath = argv[i];
+        else
+            cout << "WARNING: Unknown option " << argv[i] << endl;
+    }
+
+    if (benchmark && inputPath)
+        return Benchmark(inputPath, threads);
+
+    if (!inputPath || !outputPath)
+    {
+        cout << "Usage: meshconv <input.obj|.gltf|.glb> <output.mesh> [--packed] [--no-optimize] [--no-lods] [--threads N]" << endl;
+        cout << "       meshconv --benchmark <input> [--threads N]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    auto start = chrono::steady_clock::now();
+    MeshData mesh;
+    if (!UImportMesh(inputPath, mesh, threads))
+        return EXIT_FAILURE;
+    cout << "INFO: Imported " << inputPath << ": " << mesh.vertices.size() << " vertices, "
+        << mesh.indices.size() / 3 << " triangles in " << MillisecondsSince(start) << " ms" << endl;
+
+    if (optimize)
+        UOptimizeMesh(mesh, inputPath);
+
+    vector<MeshData> lods(1, mesh);
+    vector<float> errors(1, 0.0f);
+    if (generateLods)
+    {
+        start = chrono::steady_clock::now();
+        UGenerateLods(mesh, LOD_RATIOS, lods, errors);
+        cout << "INFO: Simplified into " << lods.size() - 1 << " LOD(s) in " << MillisecondsSince(start) << " ms" << endl;
+        for (size_t i = 1; i < lods.size(); ++i)
+        {
+            cout << "INFO:   LOD " << i << ": " << lods[i].vertices.size() << " vertices, " << lods[i].indices.size() / 3
+                << " triangles, error " << errors[i] << endl;
+            if (optimize)
+                UOptimizeMesh(lods[i], (string(inputPath) + " LOD " + to_string(i)).c_str());
+        }
+    }
+    if (!UWriteMeshFile(outputPath, lods, layout, errors))
+        return EXIT_FAILURE;
+
+    // Map the result back the way the viewer does to validate it and time the load
+    start = chrono::steady_clock::now();
+    MeshFile file;
+    if (!file.open(outputPath))
+        return EXIT_FAILURE;
+    double mapTime = MillisecondsSince(start);
+
+    const MeshFileHeader& header = file.info();
+    cout << "INFO: Wrote " << outputPath << ": " << header.fileSize << " bytes, "
+        << (header.vertexLayout == VERTEX_LAYOUT_PACKED ? "packed" : "float") << " vertices, "
+        << (header.indexType == GL_UNSIGNED_SHORT ? 16 : 32) << "-bit indices, "
+        << header.lodCount << " LOD(s); mapped in " << mapTime << " ms" << endl;
+
+    return EXIT_SUCCESS;
+}
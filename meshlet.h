@@ -0,0 +1,192 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mesh.h"
+#include "frustum.h"
+
+// Default meshlet limits: about 64 vertices and 124 triangles per cluster
+const GLuint MESHLET_MAX_VERTICES = 64;
+const GLuint MESHLET_MAX_TRIANGLES = 124;
+
+// A contiguous run of triangles in the mesh's index buffer plus its culling bounds
+struct Meshlet
+{
+    GLuint firstIndex;      // Offset into the mesh's index list
+    GLuint triangleCount;
+    GLuint vertexCount;     // Unique vertices referenced by the meshlet
+    glm::vec3 center;       // Bounding sphere in mesh space
+    float radius;
+    glm::vec3 coneAxis;     // Average facing direction of the triangles
+    float coneCutoff;       // sin of the cone half angle; > 1 when the meshlet can never be backface culled
+};
+
+// Per-frame results of the meshlet culling pass
+struct MeshletCullStats
+{
+    size_t clusters;
+    size_t frustumCulled;
+    size_t backfaceCulled;
+    size_t triangles;
+    size_t trianglesCulled;
+};
+
+namespace meshlets
+{
+    inline void computeBounds(const MeshData& mesh, Meshlet& meshlet)
+    {
+        const GLuint* tri = mesh.indices.data() + meshlet.firstIndex;
+        size_t indexCount = meshlet.triangleCount * 3;
+
+        // Sphere around the center of the bounding box
+        glm::vec3 lo = mesh.vertices[tri[0]].position;
+        glm::vec3 hi = lo;
+        for (size_t i = 1; i < indexCount; ++i)
+        {
+            lo = glm::min(lo, mesh.vertices[tri[i]].position);
+            hi = glm::max(hi, mesh.vertices[tri[i]].position);
+        }
+        meshlet.center = (lo + hi) * 0.5f;
+        meshlet.radius = 0.0f;
+        for (size_t i = 0; i < indexCount; ++i)
+            meshlet.radius = std::max(meshlet.radius, glm::length(mesh.vertices[tri[i]].position - meshlet.center));
+
+        // Normal cone around the area-weighted average face normal
+        std::vector<glm::vec3> normals;
+        glm::vec3 axis(0.0f);
+        for (size_t t = 0; t < meshlet.triangleCount; ++t)
+        {
+            const glm::vec3& a = mesh.vertices[tri[t * 3]].position;
+            glm::vec3 n = glm::cross(mesh.vertices[tri[t * 3 + 1]].position - a, mesh.vertices[tri[t * 3 + 2]].position - a);
+            float length = glm::length(n);
+            if (length <= 0.0f)
+                continue;
+            axis += n;
+            normals.push_back(n / length);
+        }
+
+        meshlet.coneAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+        meshlet.coneCutoff = 2.0f;
+        float axisLength = glm::length(axis);
+        if (normals.empty() || axisLength <= 0.0f)
+            return;
+
+        meshlet.coneAxis = axis / axisLength;
+        float minDot = 1.0f;
+        for (const glm::vec3& n : normals)
+            minDot = std::min(minDot, glm::dot(n, meshlet.coneAxis));
+
+        // Normals spread over a hemisphere or more: some triangle always faces the camera
+        if (minDot > 0.0f)
+            meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+
+// Splits the mesh's triangle list, in its current order, into meshlets of at most maxVertices
+// unique vertices and maxTriangles triangles. Run it after the cache optimizer so neighbouring
+// triangles end up in the same meshlet.
+inline void UBuildMeshlets(const MeshData& mesh, std::vector<Meshlet>& out,
+    GLuint maxVertices = MESHLET_MAX_VERTICES, GLuint maxTriangles = MESHLET_MAX_TRIANGLES)
+{
+    out.clear();
+    size_t triangleCount = mesh.indices.size() / 3;
+
+    // Tag of the meshlet each vertex was last counted in
+    std::vector<size_t> lastMeshlet(mesh.vertices.size(), ~size_t(0));
+
+    // Vertices of the triangle not yet referenced by the meshlet being filled
+    auto countNewVertices = [&](const GLuint* tri)
+    {
+        GLuint count = 0;
+        for (int k = 0; k < 3; ++k)
+            if (lastMeshlet[tri[k]] != out.size() && (k == 0 || tri[k] != tri[0]) && (k < 2 || tri[k] != tri[1]))
+                ++count;
+        return count;
+    };
+
+    Meshlet current = {};
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const GLuint* tri = mesh.indices.data() + t * 3;
+        GLuint newVertices = countNewVertices(tri);
+
+        if (current.triangleCount == maxTriangles || current.vertexCount + newVertices > maxVertices)
+        {
+            meshlets::computeBounds(mesh, current);
+            out.push_back(current);
+            current = Meshlet();
+            current.firstIndex = static_cast<GLuint>(t * 3);
+            newVertices = countNewVertices(tri);
+        }
+
+        for (int k = 0; k < 3; ++k)
+            lastMeshlet[tri[k]] = out.size();
+        current.vertexCount += newVertices;
+        ++current.triangleCount;
+    }
+
+    if (current.triangleCount > 0)
+    {
+        meshlets::computeBounds(mesh, current);
+        out.push_back(current);
+    }
+}
+
+
+// Tests each meshlet against the frustum and its normal cone against the camera, appending
+// the indices of the surviving meshlets to visible. model must be a rigid transform with
+// uniform scale. For orthographic views pass the camera's forward vector as viewDirection;
+// for perspective views pass a zero vector and the camera position as eye.
+inline void UCullMeshlets(const std::vector<Meshlet>& meshlets, GLuint firstMeshlet, GLuint count,
+    const glm::mat4& model, const Frustum& frustum, const glm::vec3& eye, const glm::vec3& viewDirection,
+    std::vector<GLuint>& visible, MeshletCullStats& stats)
+{
+    glm::mat3 rotation(model);
+    float scale = glm::length(rotation[0]);
+
+    for (GLuint i = firstMeshlet; i < firstMeshlet + count; ++i)
+    {
+        const Meshlet& meshlet = meshlets[i];
+        ++stats.clusters;
+        stats.triangles += meshlet.triangleCount;
+
+        glm::vec3 center = glm::vec3(model * glm::vec4(meshlet.center, 1.0f));
+        float radius = meshlet.radius * scale;
+        if (!UFrustumContainsSphere(frustum, center, radius))
+        {
+            ++stats.frustumCulled;
+            stats.trianglesCulled += meshlet.triangleCount;
+            continue;
+        }
+
+        if (meshlet.coneCutoff <= 1.0f)
+        {
+            glm::vec3 axis = rotation * meshlet.coneAxis / scale;
+            bool backfacing;
+            if (glm::dot(viewDirection, viewDirection) > 0.0f)
+            {
+                backfacing = glm::dot(viewDirection, axis) >= meshlet.coneCutoff;
+            }
+            else
+            {
+                glm::vec3 toCenter = center - eye;
+                backfacing = glm::dot(toCenter, axis) >= meshlet.coneCutoff * glm::length(toCenter) + radius;
+            }
+            if (backfacing)
+            {
+                ++stats.backfaceCulled;
+                stats.trianglesCulled += meshlet.triangleCount;
+                continue;
+            }
+        }
+
+        visible.push_back(i);
+    }
+}
+#endif
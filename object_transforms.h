@@ -0,0 +1,241 @@
+#ifndef OBJECT_TRANSFORMS_H
+#define OBJECT_TRANSFORMS_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OBJECT_TRANSFORMS_SSE
+#endif
+
+/* Per-object matrices the vertex shaders would otherwise derive for every vertex: the combined
+ * model-view-projection matrix and the normal matrix, transpose(inverse(mat3(model))).
+ *
+ * Records are batched in place: each starts with its model matrix, immediately followed by the
+ * ObjectTransform to fill, and records are stride bytes apart. ObjectData (uniform_blocks.h) and
+ * DrawObject (indirect_draw.h) are laid out that way, so their staged arrays are processed directly.
+ *
+ * A model whose upper 3x3 has orthogonal columns of equal length (rotation, translation and uniform
+ * scale) skips the inverse: its normal matrix is the 3x3 itself, which differs from the exact one
+ * only in length, and every fragment shader normalizes the interpolated normal.
+ */
+
+// std140 / std430 mirror of { mat4 modelViewProjection; mat3 normalMatrix; }
+struct ObjectTransform
+{
+    glm::mat4 modelViewProjection;
+    glm::vec4 normalMatrix[3];      // Columns; w unused
+};
+static_assert(sizeof(ObjectTransform) == 112, "ObjectTransform layout must match std140");
+
+// How many models took the rigid fast path and how many needed the inverse
+struct ObjectTransformStats
+{
+    size_t rigid = 0;
+    size_t general = 0;
+};
+
+namespace objecttransforms
+{
+    // Relative tolerance of the rigid test, against the squared length of the first column
+    const float RIGID_EPSILON = 1e-4f;
+
+    inline bool isRigid(const glm::vec3& c0, const glm::vec3& c1, const glm::vec3& c2)
+    {
+        float length0 = glm::dot(c0, c0);
+        float tolerance = RIGID_EPSILON * length0;
+        return std::fabs(glm::dot(c1, c1) - length0) <= tolerance && std::fabs(glm::dot(c2, c2) - length0) <= tolerance
+            && std::fabs(glm::dot(c0, c1)) <= tolerance && std::fabs(glm::dot(c1, c2)) <= tolerance
+            && std::fabs(glm::dot(c0, c2)) <= tolerance;
+    }
+
+    inline glm::mat4& model(void* records, size_t stride, size_t i)
+    {
+        return *reinterpret_cast<glm::mat4*>(static_cast<unsigned char*>(records) + i * stride);
+    }
+
+    inline ObjectTransform& transform(void* records, size_t stride, size_t i)
+    {
+        return *reinterpret_cast<ObjectTransform*>(static_cast<unsigned char*>(records) + i * stride + sizeof(glm::mat4));
+    }
+}
+
+// Normal matrix of one model; returns whether the rigid fast path applied
+inline bool UNormalMatrix(const glm::mat4& model, glm::vec4 normalMatrix[3])
+{
+    glm::vec3 c0(model[0]), c1(model[1]), c2(model[2]);
+    if (objecttransforms::isRigid(c0, c1, c2))
+    {
+        normalMatrix[0] = glm::vec4(c0, 0.0f);
+        normalMatrix[1] = glm::vec4(c1, 0.0f);
+        normalMatrix[2] = glm::vec4(c2, 0.0f);
+        return true;
+    }
+    // Columns of the inverse transpose are the cofactor columns over the determinant
+    glm::vec3 n0 = glm::cross(c1, c2), n1 = glm::cross(c2, c0), n2 = glm::cross(c0, c1);
+    float determinant = glm::dot(c0, n0);
+    float scale = determinant != 0.0f ? 1.0f / determinant : 0.0f;
+    normalMatrix[0] = glm::vec4(n0 * scale, 0.0f);
+    normalMatrix[1] = glm::vec4(n1 * scale, 0.0f);
+    normalMatrix[2] = glm::vec4(n2 * scale, 0.0f);
+    return false;
+}
+
+inline ObjectTransformStats UComputeObjectTransformsScalar(const glm::mat4& viewProjection, void* records, size_t stride, size_t count)
+{
+    using namespace objecttransforms;
+    ObjectTransformStats stats;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const glm::mat4& m = model(records, stride, i);
+        ObjectTransform& out = transform(records, stride, i);
+        out.modelViewProjection = viewProjection * m;
+        if (UNormalMatrix(m, out.normalMatrix))
+            ++stats.rigid;
+        else
+            ++stats.general;
+    }
+    return stats;
+}
+
+#ifdef OBJECT_TRANSFORMS_SSE
+namespace objecttransforms
+{
+    inline __m128 select(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    inline __m128 abs(__m128 a)
+    {
+        return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+    }
+
+    // Normal matrices of 4 models, one per lane: each column is transposed into x, y and z registers,
+    // so the rigid test, cofactors and determinant are plain lane-wise arithmetic. Both normal
+    // matrices are computed and one is selected per lane, which costs less than a branch that
+    // mixed scenes mispredict. Returns the rigid lanes as a movemask.
+    inline int normalMatrices4(void* records, size_t stride, size_t first)
+    {
+        __m128 x[3], y[3], z[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            __m128 w;
+            x[c] = _mm_loadu_ps(&model(records, stride, first)[c][0]);
+            y[c] = _mm_loadu_ps(&model(records, stride, first + 1)[c][0]);
+            z[c] = _mm_loadu_ps(&model(records, stride, first + 2)[c][0]);
+            w = _mm_loadu_ps(&model(records, stride, first + 3)[c][0]);
+            _MM_TRANSPOSE4_PS(x[c], y[c], z[c], w);
+        }
+        auto dot = [&](int a, int b)
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x[a], x[b]), _mm_mul_ps(y[a], y[b])), _mm_mul_ps(z[a], z[b]));
+        };
+
+        __m128 length0 = dot(0, 0);
+        __m128 tolerance = _mm_mul_ps(length0, _mm_set1_ps(RIGID_EPSILON));
+        __m128 rigid = _mm_and_ps(_mm_cmple_ps(abs(_mm_sub_ps(dot(1, 1), length0)), tolerance),
+            _mm_cmple_ps(abs(_mm_sub_ps(dot(2, 2), length0)), tolerance));
+        rigid = _mm_and_ps(rigid, _mm_and_ps(_mm_cmple_ps(abs(dot(0, 1)), tolerance), _mm_cmple_ps(abs(dot(1, 2)), tolerance)));
+        rigid = _mm_and_ps(rigid, _mm_cmple_ps(abs(dot(0, 2)), tolerance));
+
+        // Cofactor column i is the cross product of columns i + 1 and i + 2
+        __m128 nx[3], ny[3], nz[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            int a = (i + 1) % 3, b = (i + 2) % 3;
+            nx[i] = _mm_sub_ps(_mm_mul_ps(y[a], z[b]), _mm_mul_ps(z[a], y[b]));
+            ny[i] = _mm_sub_ps(_mm_mul_ps(z[a], x[b]), _mm_mul_ps(x[a], z[b]));
+            nz[i] = _mm_sub_ps(_mm_mul_ps(x[a], y[b]), _mm_mul_ps(y[a], x[b]));
+        }
+        __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x[0], nx[0]), _mm_mul_ps(y[0], ny[0])), _mm_mul_ps(z[0], nz[0]));
+        __m128 scale = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), determinant), _mm_cmpneq_ps(determinant, _mm_setzero_ps()));
+
+        for (int c = 0; c < 3; ++c)
+        {
+            __m128 columnX = select(rigid, x[c], _mm_mul_ps(nx[c], scale));
+            __m128 columnY = select(rigid, y[c], _mm_mul_ps(ny[c], scale));
+            __m128 columnZ = select(rigid, z[c], _mm_mul_ps(nz[c], scale));
+            __m128 columnW = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(columnX, columnY, columnZ, columnW);
+            _mm_storeu_ps(&transform(records, stride, first).normalMatrix[c][0], columnX);
+            _mm_storeu_ps(&transform(records, stride, first + 1).normalMatrix[c][0], columnY);
+            _mm_storeu_ps(&transform(records, stride, first + 2).normalMatrix[c][0], columnZ);
+            _mm_storeu_ps(&transform(records, stride, first + 3).normalMatrix[c][0], columnW);
+        }
+        return _mm_movemask_ps(rigid);
+    }
+}
+
+namespace objecttransforms
+{
+    inline void modelViewProjection(const __m128 vp[4], void* records, size_t stride, size_t i)
+    {
+        const float* m = &model(records, stride, i)[0][0];
+        ObjectTransform& out = transform(records, stride, i);
+        for (int c = 0; c < 4; ++c)
+        {
+            __m128 column = _mm_loadu_ps(m + c * 4);
+            __m128 x = _mm_shuffle_ps(column, column, _MM_SHUFFLE(0, 0, 0, 0));
+            __m128 y = _mm_shuffle_ps(column, column, _MM_SHUFFLE(1, 1, 1, 1));
+            __m128 z = _mm_shuffle_ps(column, column, _MM_SHUFFLE(2, 2, 2, 2));
+            __m128 w = _mm_shuffle_ps(column, column, _MM_SHUFFLE(3, 3, 3, 3));
+            __m128 product = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vp[0], x), _mm_mul_ps(vp[1], y)),
+                _mm_add_ps(_mm_mul_ps(vp[2], z), _mm_mul_ps(vp[3], w)));
+            _mm_storeu_ps(&out.modelViewProjection[c][0], product);
+        }
+    }
+}
+
+// Four models per iteration: their MVPs one at a time with a matrix column per register, four
+// broadcasts and multiply-adds per column, then their normal matrices across the lanes
+inline ObjectTransformStats UComputeObjectTransformsSse(const glm::mat4& viewProjection, void* records, size_t stride, size_t count)
+{
+    using namespace objecttransforms;
+    static const int RIGID_LANES[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    const __m128 vp[4] = { _mm_loadu_ps(&viewProjection[0][0]), _mm_loadu_ps(&viewProjection[1][0]),
+        _mm_loadu_ps(&viewProjection[2][0]), _mm_loadu_ps(&viewProjection[3][0]) };
+    size_t rigidCount = 0, i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        for (size_t j = i; j < i + 4; ++j)
+            objecttransforms::modelViewProjection(vp, records, stride, j);
+        rigidCount += RIGID_LANES[normalMatrices4(records, stride, i)];
+    }
+    for (; i < count; ++i)
+    {
+        objecttransforms::modelViewProjection(vp, records, stride, i);
+        rigidCount += UNormalMatrix(model(records, stride, i), transform(records, stride, i).normalMatrix);
+    }
+
+    ObjectTransformStats stats;
+    stats.rigid = rigidCount;
+    stats.general = count - rigidCount;
+    return stats;
+}
+#endif
+
+
+// Name of the kernel UComputeObjectTransforms runs with in this build
+inline const char* UObjectTransformsSimdPath()
+{
+#if defined(OBJECT_TRANSFORMS_SSE)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+// Fills the ObjectTransform after each record's model matrix with the widest kernel this build has
+inline ObjectTransformStats UComputeObjectTransforms(const glm::mat4& viewProjection, void* records, size_t stride, size_t count)
+{
+#if defined(OBJECT_TRANSFORMS_SSE)
+    return UComputeObjectTransformsSse(viewProjection, records, stride, count);
+#else
+    return UComputeObjectTransformsScalar(viewProjection, records, stride, count);
+#endif
+}
+#endif
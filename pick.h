@@ -0,0 +1,409 @@
+#ifndef PICK_H
+#define PICK_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Same instruction set detection as the culling kernels
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PICK_SIMD_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PICK_SIMD_SSE
+#endif
+
+#include "mesh.h"
+#include "bvh.h"
+#include "frustum.h"
+
+// Nearest intersection of a pick ray
+struct PickHit
+{
+    uint32_t object = UINT32_MAX;   // Scene object id, UINT32_MAX when nothing was hit
+    uint32_t triangle = 0;          // Triangle index in the object's mesh
+    float distance = 0.0f;          // Ray parameter of the hit: point = origin + distance * direction
+    glm::vec3 point = glm::vec3(0.0f);  // World space
+    glm::vec3 normal = glm::vec3(0.0f); // World space unit geometric normal, facing the ray origin
+};
+
+namespace pick
+{
+    // Lanes the leaf kernel tests at once; triangle arrays are padded by this much so loads never run past the end
+#if defined(PICK_SIMD_AVX2)
+    const size_t LANES = 8;
+#elif defined(PICK_SIMD_SSE)
+    const size_t LANES = 4;
+#else
+    const size_t LANES = 1;
+#endif
+
+    // Triangles as base vertex and two edges, one array per component
+    struct TriangleSoA
+    {
+        std::vector<float> v0[3];
+        std::vector<float> e1[3];
+        std::vector<float> e2[3];
+    };
+
+    inline int lowestLane(int mask)
+    {
+        int lane = 0;
+        for (; !(mask & 1); mask >>= 1)
+            ++lane;
+        return lane;
+    }
+
+    // Moller-Trumbore against both faces; returns the hit distance or FLT_MAX.
+    // Degenerate triangles give a zero determinant, and the NaN / infinite barycentrics fail every comparison.
+    inline float rayTriangle(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& v0, const glm::vec3& e1, const glm::vec3& e2, float tMax)
+    {
+        glm::vec3 p = glm::cross(direction, e2);
+        float inverseDet = 1.0f / glm::dot(e1, p);
+        glm::vec3 s = origin - v0;
+        float u = glm::dot(s, p) * inverseDet;
+        glm::vec3 q = glm::cross(s, e1);
+        float v = glm::dot(direction, q) * inverseDet;
+        float t = glm::dot(e2, q) * inverseDet;
+        return (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t < tMax) ? t : FLT_MAX;
+    }
+
+#ifdef PICK_SIMD_SSE
+    // Slab test of one BVH node with its xyz in the lanes. Lane 3 holds the node's first / count field;
+    // the zeroed inverse direction lane turns it into 0 for the entry test and the exit gets tMax there.
+    inline float rayBoxSse(__m128 origin, __m128 inverseDirection, const BvhNode& node, float tMax)
+    {
+        const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+        __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.min.x), origin), inverseDirection);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.max.x), origin), inverseDirection);
+        __m128 tNear = _mm_and_ps(_mm_min_ps(t0, t1), xyzMask);
+        __m128 tFar = _mm_or_ps(_mm_and_ps(_mm_max_ps(t0, t1), xyzMask), _mm_andnot_ps(xyzMask, _mm_set1_ps(tMax)));
+
+        tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(1, 0, 3, 2)));
+        tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(2, 3, 0, 1)));
+        tFar = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(1, 0, 3, 2)));
+        tFar = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(2, 3, 0, 1)));
+        float enter = _mm_cvtss_f32(tNear);
+        return enter <= _mm_cvtss_f32(tFar) ? enter : FLT_MAX;
+    }
+
+    // 4 triangles starting at slot; on a closer hit updates tMax and hitSlot
+    inline void rayTriangles4(const glm::vec3& origin, const glm::vec3& direction, const TriangleSoA& tris, size_t slot, float& tMax, size_t& hitSlot)
+    {
+        __m128 dx = _mm_set1_ps(direction.x), dy = _mm_set1_ps(direction.y), dz = _mm_set1_ps(direction.z);
+        __m128 e1x = _mm_loadu_ps(&tris.e1[0][slot]), e1y = _mm_loadu_ps(&tris.e1[1][slot]), e1z = _mm_loadu_ps(&tris.e1[2][slot]);
+        __m128 e2x = _mm_loadu_ps(&tris.e2[0][slot]), e2y = _mm_loadu_ps(&tris.e2[1][slot]), e2z = _mm_loadu_ps(&tris.e2[2][slot]);
+
+        __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        __m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz)));
+
+        __m128 sx = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_loadu_ps(&tris.v0[0][slot]));
+        __m128 sy = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_loadu_ps(&tris.v0[1][slot]));
+        __m128 sz = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_loadu_ps(&tris.v0[2][slot]));
+        __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDet);
+
+        __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+        __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+        __m128 zero = _mm_setzero_ps();
+        __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero)), _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmplt_ps(t, _mm_set1_ps(tMax))));
+        int mask = _mm_movemask_ps(hit);
+        if (mask == 0)
+            return;
+
+        t = _mm_or_ps(_mm_and_ps(hit, t), _mm_andnot_ps(hit, _mm_set1_ps(FLT_MAX)));
+        __m128 nearest = _mm_min_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 0, 3, 2)));
+        nearest = _mm_min_ps(nearest, _mm_shuffle_ps(nearest, nearest, _MM_SHUFFLE(2, 3, 0, 1)));
+        tMax = _mm_cvtss_f32(nearest);
+        hitSlot = slot + lowestLane(_mm_movemask_ps(_mm_cmpeq_ps(t, nearest)) & mask);
+    }
+#endif
+
+#ifdef PICK_SIMD_AVX2
+    // 8 triangles starting at slot; on a closer hit updates tMax and hitSlot
+    inline void rayTriangles8(const glm::vec3& origin, const glm::vec3& direction, const TriangleSoA& tris, size_t slot, float& tMax, size_t& hitSlot)
+    {
+        __m256 dx = _mm256_set1_ps(direction.x), dy = _mm256_set1_ps(direction.y), dz = _mm256_set1_ps(direction.z);
+        __m256 e1x = _mm256_loadu_ps(&tris.e1[0][slot]), e1y = _mm256_loadu_ps(&tris.e1[1][slot]), e1z = _mm256_loadu_ps(&tris.e1[2][slot]);
+        __m256 e2x = _mm256_loadu_ps(&tris.e2[0][slot]), e2y = _mm256_loadu_ps(&tris.e2[1][slot]), e2z = _mm256_loadu_ps(&tris.e2[2][slot]);
+
+        __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+        __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+        __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+        __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+        __m256 inverseDet = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+
+        __m256 sx = _mm256_sub_ps(_mm256_set1_ps(origin.x), _mm256_loadu_ps(&tris.v0[0][slot]));
+        __m256 sy = _mm256_sub_ps(_mm256_set1_ps(origin.y), _mm256_loadu_ps(&tris.v0[1][slot]));
+        __m256 sz = _mm256_sub_ps(_mm256_set1_ps(origin.z), _mm256_loadu_ps(&tris.v0[2][slot]));
+        __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)), inverseDet);
+
+        __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+        __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+        __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+        __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)), inverseDet);
+        __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), inverseDet);
+
+        __m256 zero = _mm256_setzero_ps();
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), _mm256_set1_ps(1.0f), _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GE_OQ), _mm256_cmp_ps(t, _mm256_set1_ps(tMax), _CMP_LT_OQ)));
+        int mask = _mm256_movemask_ps(hit);
+        if (mask == 0)
+            return;
+
+        t = _mm256_blendv_ps(_mm256_set1_ps(FLT_MAX), t, hit);
+        __m256 nearest = _mm256_min_ps(t, _mm256_permute2f128_ps(t, t, 1));
+        nearest = _mm256_min_ps(nearest, _mm256_shuffle_ps(nearest, nearest, _MM_SHUFFLE(1, 0, 3, 2)));
+        nearest = _mm256_min_ps(nearest, _mm256_shuffle_ps(nearest, nearest, _MM_SHUFFLE(2, 3, 0, 1)));
+        tMax = _mm256_cvtss_f32(nearest);
+        hitSlot = slot + lowestLane(_mm256_movemask_ps(_mm256_cmp_ps(t, nearest, _CMP_EQ_OQ)) & mask);
+    }
+#endif
+
+    // Tests triangles [first, first + count) with the widest kernel. Lanes past count test the
+    // neighbouring triangles (or zero padding), which can only report real hits, so no masking is needed.
+    inline void rayTriangles(const glm::vec3& origin, const glm::vec3& direction, const TriangleSoA& tris, size_t first, size_t count,
+        float& tMax, size_t& hitSlot)
+    {
+        for (size_t slot = first; slot < first + count; slot += LANES)
+        {
+#if defined(PICK_SIMD_AVX2)
+            rayTriangles8(origin, direction, tris, slot, tMax, hitSlot);
+#elif defined(PICK_SIMD_SSE)
+            rayTriangles4(origin, direction, tris, slot, tMax, hitSlot);
+#else
+            glm::vec3 v0(tris.v0[0][slot], tris.v0[1][slot], tris.v0[2][slot]);
+            glm::vec3 e1(tris.e1[0][slot], tris.e1[1][slot], tris.e1[2][slot]);
+            glm::vec3 e2(tris.e2[0][slot], tris.e2[1][slot], tris.e2[2][slot]);
+            float t = rayTriangle(origin, direction, v0, e1, e2, tMax);
+            if (t < tMax)
+            {
+                tMax = t;
+                hitSlot = slot;
+            }
+#endif
+        }
+    }
+}
+
+
+// Triangles of one mesh in a static BVH for exact ray queries, in mesh space
+class PickMesh
+{
+public:
+    void build(const MeshData& mesh)
+    {
+        std::vector<glm::vec3> positions(mesh.vertices.size());
+        for (size_t i = 0; i < mesh.vertices.size(); ++i)
+            positions[i] = mesh.vertices[i].position;
+        build(positions, mesh.indices);
+    }
+
+    void build(const std::vector<glm::vec3>& positions, const std::vector<GLuint>& indices)
+    {
+        size_t triangles = indices.size() / 3;
+        tree = SceneBvh();
+        for (size_t i = 0; i < triangles; ++i)
+        {
+            const glm::vec3& a = positions[indices[i * 3 + 0]];
+            const glm::vec3& b = positions[indices[i * 3 + 1]];
+            const glm::vec3& c = positions[indices[i * 3 + 2]];
+            tree.add(glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)));
+        }
+        tree.rebuild();
+
+        // Triangles in leaf order, so a leaf's triangles are contiguous for the SIMD kernel
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            tris.v0[axis].assign(triangles + pick::LANES, 0.0f);
+            tris.e1[axis].assign(triangles + pick::LANES, 0.0f);
+            tris.e2[axis].assign(triangles + pick::LANES, 0.0f);
+        }
+        for (size_t slot = 0; slot < triangles; ++slot)
+        {
+            uint32_t triangle = tree.objectAt(static_cast<uint32_t>(slot));
+            const glm::vec3& a = positions[indices[triangle * 3 + 0]];
+            glm::vec3 e1 = positions[indices[triangle * 3 + 1]] - a;
+            glm::vec3 e2 = positions[indices[triangle * 3 + 2]] - a;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                tris.v0[axis][slot] = a[axis];
+                tris.e1[axis][slot] = e1[axis];
+                tris.e2[axis][slot] = e2[axis];
+            }
+        }
+    }
+
+    bool empty() const { return tree.nodes().empty(); }
+    size_t triangleCount() const { return tree.size(); }
+    size_t nodeCount() const { return tree.nodes().size(); }
+    const BvhNode& root() const { return tree.nodes()[0]; }
+
+    // Nearest triangle within [0, tMax] along a mesh-space ray. On a hit tMax becomes its distance
+    // and the triangle index and its unit normal (facing the ray origin) are returned.
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float& tMax, uint32_t& triangle, glm::vec3& normal) const
+    {
+        if (empty())
+            return false;
+
+        const std::vector<BvhNode>& nodes = tree.nodes();
+        size_t hitSlot = SIZE_MAX;
+        glm::vec3 inverseDirection = 1.0f / direction;
+#ifdef PICK_SIMD_SSE
+        __m128 origin4 = _mm_setr_ps(origin.x, origin.y, origin.z, 0.0f);
+        __m128 inverseDirection4 = _mm_setr_ps(inverseDirection.x, inverseDirection.y, inverseDirection.z, 0.0f);
+        auto enterBox = [&](const BvhNode& node) { return pick::rayBoxSse(origin4, inverseDirection4, node, tMax); };
+#else
+        auto enterBox = [&](const BvhNode& node) { return bvh::rayBox(origin, inverseDirection, node.min, node.max, tMax); };
+#endif
+
+        struct Entry { uint32_t node; float enter; };
+        Entry stack[bvh::MAX_STACK_DEPTH];
+        int top = 0;
+        float rootEnter = enterBox(nodes[0]);
+        if (rootEnter != FLT_MAX)
+            stack[top++] = Entry{ 0, rootEnter };
+
+        while (top > 0)
+        {
+            Entry entry = stack[--top];
+            if (entry.enter > tMax)
+                continue;
+            const BvhNode& node = nodes[entry.node];
+            if (node.count > 0)
+            {
+                pick::rayTriangles(origin, direction, tris, node.first, node.count, tMax, hitSlot);
+                continue;
+            }
+
+            // Nearer child on top of the stack so its hits prune the farther one
+            Entry left = { node.first, enterBox(nodes[node.first]) };
+            Entry right = { node.first + 1, enterBox(nodes[node.first + 1]) };
+            if (left.enter < right.enter)
+                std::swap(left, right);
+            if (left.enter != FLT_MAX)
+                stack[top++] = left;
+            if (right.enter != FLT_MAX)
+                stack[top++] = right;
+        }
+
+        if (hitSlot == SIZE_MAX)
+            return false;
+        finishHit(hitSlot, direction, triangle, normal);
+        return true;
+    }
+
+    // Same query against every triangle, for validating and timing the BVH path
+    bool raycastBruteForce(const glm::vec3& origin, const glm::vec3& direction, float& tMax, uint32_t& triangle, glm::vec3& normal) const
+    {
+        size_t hitSlot = SIZE_MAX;
+        pick::rayTriangles(origin, direction, tris, 0, tree.size(), tMax, hitSlot);
+        if (hitSlot == SIZE_MAX)
+            return false;
+        finishHit(hitSlot, direction, triangle, normal);
+        return true;
+    }
+
+private:
+    SceneBvh tree;              // One object per triangle
+    pick::TriangleSoA tris;     // Indexed by the tree's leaf slots
+
+    void finishHit(size_t slot, const glm::vec3& direction, uint32_t& triangle, glm::vec3& normal) const
+    {
+        glm::vec3 e1(tris.e1[0][slot], tris.e1[1][slot], tris.e1[2][slot]);
+        glm::vec3 e2(tris.e2[0][slot], tris.e2[1][slot], tris.e2[2][slot]);
+        normal = glm::normalize(glm::cross(e1, e2));
+        if (glm::dot(normal, direction) > 0.0f)
+            normal = -normal;
+        triangle = tree.objectAt(static_cast<uint32_t>(slot));
+    }
+};
+
+
+// A mesh placed in the world
+struct PickObject
+{
+    const PickMesh* mesh;
+    glm::mat4 model;
+    glm::mat4 inverseModel;
+};
+
+// Registers a mesh instance in the scene BVH and returns its object id (its index in objects)
+inline uint32_t UAddPickObject(SceneBvh& scene, std::vector<PickObject>& objects, const PickMesh* mesh, const glm::mat4& model)
+{
+    glm::vec3 worldMin(0.0f), worldMax(0.0f);
+    if (!mesh->empty())
+        UTransformAabb(model, mesh->root().min, mesh->root().max, worldMin, worldMax);
+    PickObject object = { mesh, model, glm::inverse(model) };
+    objects.push_back(object);
+    uint32_t id = scene.add(worldMin, worldMax);
+    if (mesh->empty())
+        scene.remove(id);
+    return id;
+}
+
+// World-space ray through a window position (pixels, origin top left) for the given camera
+inline void UCursorRay(double x, double y, int width, int height, const glm::mat4& view, const glm::mat4& projection,
+    glm::vec3& origin, glm::vec3& direction)
+{
+    glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+    float ndcX = static_cast<float>(2.0 * x / width - 1.0);
+    float ndcY = static_cast<float>(1.0 - 2.0 * y / height);
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    origin = glm::vec3(nearPoint) / nearPoint.w;
+    direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+}
+
+// Nearest object hit by a world-space ray: object boxes through the scene BVH, then exact triangles
+// in each candidate's mesh space. Distances are comparable across objects because the mesh-space
+// ray keeps the world ray's parameterization.
+inline bool UPickRay(const SceneBvh& scene, const std::vector<PickObject>& objects, const glm::vec3& origin, const glm::vec3& direction,
+    PickHit& hit, float maxDistance = FLT_MAX)
+{
+    uint32_t triangle = 0;
+    glm::vec3 meshNormal(0.0f);
+    uint32_t object = UINT32_MAX;
+    float distance = maxDistance;
+
+    bool found = scene.raycast(origin, direction, distance, object,
+        [&](uint32_t id, const glm::vec3& o, const glm::vec3& d, float tMax)
+        {
+            const PickObject& candidate = objects[id];
+            glm::vec3 meshOrigin(candidate.inverseModel * glm::vec4(o, 1.0f));
+            glm::vec3 meshDirection(candidate.inverseModel * glm::vec4(d, 0.0f));
+            uint32_t candidateTriangle;
+            glm::vec3 candidateNormal;
+            if (!candidate.mesh->raycast(meshOrigin, meshDirection, tMax, candidateTriangle, candidateNormal))
+                return FLT_MAX;
+            triangle = candidateTriangle;
+            meshNormal = candidateNormal;
+            return tMax;
+        });
+    if (!found)
+        return false;
+
+    // Normals go to world space with the inverse transpose
+    const PickObject& picked = objects[object];
+    glm::vec3 normal = glm::normalize(glm::vec3(glm::transpose(picked.inverseModel) * glm::vec4(meshNormal, 0.0f)));
+    hit.object = object;
+    hit.triangle = triangle;
+    hit.distance = distance;
+    hit.point = origin + direction * distance;
+    hit.normal = glm::dot(normal, direction) > 0.0f ? -normal : normal;
+    return true;
+}
+#endif
@@ -0,0 +1,215 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/* Render queue: every draw of a frame is submitted as a packet whose 64-bit sort key packs, from
+ * the most significant bits down, the pass, program, texture, VAO and quantized depth:
+ *
+ *   | pass 4 | program 10 | texture 16 | VAO 10 | depth 24 |
+ *
+ * Sorting the keys groups draws by the most expensive state first, and within a state group
+ * orders them front to back. Passes are submitted one at a time; the depth pre-pass pushes its
+ * packets with one program and no texture, so they sort by VAO and then strictly front to back.
+ * Names wider than their field only cost sorting quality, since the packet also carries the full
+ * state that is compared when the draws are emitted.
+ */
+
+enum RenderPass
+{
+    RENDER_PASS_DEPTH = 0,
+    RENDER_PASS_OPAQUE,
+    RENDER_PASS_COUNT
+};
+
+namespace renderqueue
+{
+    const unsigned PASS_BITS = 4;
+    const unsigned PROGRAM_BITS = 10;
+    const unsigned TEXTURE_BITS = 16;
+    const unsigned VAO_BITS = 10;
+    const unsigned DEPTH_BITS = 24;
+    static_assert(PASS_BITS + PROGRAM_BITS + TEXTURE_BITS + VAO_BITS + DEPTH_BITS == 64, "Sort key fields must fill 64 bits");
+
+    inline uint64_t field(uint32_t value, unsigned bits)
+    {
+        return value & ((uint64_t(1) << bits) - 1);
+    }
+
+    // Bits telling which state a packet changes relative to the one before it
+    const unsigned CHANGED_PROGRAM = 1;
+    const unsigned CHANGED_TEXTURE = 2;
+    const unsigned CHANGED_VAO = 4;
+}
+
+// Depth in [0, 1] as a key field; larger values sort later
+inline uint32_t URenderDepth(float depth)
+{
+    const float scale = static_cast<float>((1u << renderqueue::DEPTH_BITS) - 1);
+    depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+    return static_cast<uint32_t>(depth * scale);
+}
+
+inline RenderPass URenderPassOf(uint64_t key)
+{
+    return static_cast<RenderPass>(key >> (64 - renderqueue::PASS_BITS));
+}
+
+inline uint64_t URenderKey(RenderPass pass, uint32_t program, uint32_t texture, uint32_t vao, uint32_t depth)
+{
+    using namespace renderqueue;
+    return field(pass, PASS_BITS) << (PROGRAM_BITS + TEXTURE_BITS + VAO_BITS + DEPTH_BITS)
+        | field(program, PROGRAM_BITS) << (TEXTURE_BITS + VAO_BITS + DEPTH_BITS)
+        | field(texture, TEXTURE_BITS) << (VAO_BITS + DEPTH_BITS)
+        | field(vao, VAO_BITS) << DEPTH_BITS
+        | field(depth, DEPTH_BITS);
+}
+
+// GL state a draw needs. Texture 0 marks an untextured draw, which keeps whatever texture is bound.
+struct RenderState
+{
+    uint32_t program;
+    uint32_t texture;
+    uint32_t vao;
+};
+
+struct RenderPacket
+{
+    uint64_t key;
+    RenderState state;
+    uint32_t item;      // Caller's index of the draw
+};
+
+// State binds a sequence of packets needs, accumulated over frames
+struct RenderBindStats
+{
+    size_t packets = 0;
+    size_t programBinds = 0;
+    size_t textureBinds = 0;
+    size_t vaoBinds = 0;
+};
+
+class RenderQueue
+{
+public:
+    void clear() { packets.clear(); }
+
+    void push(uint64_t key, const RenderState& state, uint32_t item)
+    {
+        RenderPacket packet = { key, state, item };
+        packets.push_back(packet);
+    }
+
+    // Stable LSD radix sort on the keys, one byte per pass. All byte histograms come from one read
+    // of the keys; bytes that are equal in every key (unused passes, few programs) are skipped.
+    void sort()
+    {
+        size_t count = packets.size();
+        if (count < 2)
+            return;
+        scratch.resize(count);
+        std::vector<size_t>& offsets = histograms;
+        offsets.assign(8 * 256, 0);
+        for (const RenderPacket& packet : packets)
+            for (unsigned byte = 0; byte < 8; ++byte)
+                ++offsets[byte * 256 + ((packet.key >> (byte * 8)) & 0xff)];
+
+        RenderPacket* from = packets.data();
+        RenderPacket* to = scratch.data();
+        for (unsigned byte = 0; byte < 8; ++byte)
+        {
+            size_t* offset = &offsets[byte * 256];
+            if (offset[(from[0].key >> (byte * 8)) & 0xff] == count)
+                continue;
+            size_t sum = 0;
+            for (size_t digit = 0; digit < 256; ++digit)
+            {
+                size_t n = offset[digit];
+                offset[digit] = sum;
+                sum += n;
+            }
+            for (size_t i = 0; i < count; ++i)
+                to[offset[(from[i].key >> (byte * 8)) & 0xff]++] = from[i];
+            std::swap(from, to);
+        }
+        if (from != packets.data())
+            packets.swap(scratch);
+    }
+
+    // Calls emit(packet, changes) for each packet in order, where changes holds the CHANGED_* bits
+    // of the state that differs from what the previous packets left bound; the first packet
+    // changes everything it uses. Returns the binds this takes.
+    template <typename Emit>
+    RenderBindStats submit(const Emit& emit) const
+    {
+        return submit(packets.data(), packets.data() + packets.size(), emit);
+    }
+
+    // The same for the packets of one pass, after sort()
+    template <typename Emit>
+    RenderBindStats submit(RenderPass pass, const Emit& emit) const
+    {
+        const RenderPacket* begin = packets.data();
+        const RenderPacket* end = begin + packets.size();
+        while (begin != end && URenderPassOf(begin->key) < pass)
+            ++begin;
+        const RenderPacket* last = begin;
+        while (last != end && URenderPassOf(last->key) == pass)
+            ++last;
+        return submit(begin, last, emit);
+    }
+
+    size_t size() const { return packets.size(); }
+    const std::vector<RenderPacket>& all() const { return packets; }
+
+private:
+    std::vector<RenderPacket> packets;
+    std::vector<RenderPacket> scratch;
+    std::vector<size_t> histograms;
+
+    template <typename Emit>
+    static RenderBindStats submit(const RenderPacket* begin, const RenderPacket* end, const Emit& emit)
+    {
+        using namespace renderqueue;
+        RenderBindStats stats;
+        RenderState bound = { 0, 0, 0 };
+        bool first = true;
+        for (const RenderPacket* it = begin; it != end; ++it)
+        {
+            const RenderPacket& packet = *it;
+            const RenderState& state = packet.state;
+            unsigned changes = 0;
+            if (first || state.program != bound.program)
+                changes |= CHANGED_PROGRAM;
+            if (state.texture != 0 && (first || state.texture != bound.texture))
+                changes |= CHANGED_TEXTURE;
+            if (first || state.vao != bound.vao)
+                changes |= CHANGED_VAO;
+            first = false;
+
+            bound.program = state.program;
+            bound.vao = state.vao;
+            if (state.texture != 0)
+                bound.texture = state.texture;
+            ++stats.packets;
+            stats.programBinds += (changes & CHANGED_PROGRAM) != 0;
+            stats.textureBinds += (changes & CHANGED_TEXTURE) != 0;
+            stats.vaoBinds += (changes & CHANGED_VAO) != 0;
+            emit(packet, changes);
+        }
+        return stats;
+    }
+};
+
+inline RenderBindStats& operator+=(RenderBindStats& a, const RenderBindStats& b)
+{
+    a.packets += b.packets;
+    a.programBinds += b.programBinds;
+    a.textureBinds += b.textureBinds;
+    a.vaoBinds += b.vaoBinds;
+    return a;
+}
+#endif
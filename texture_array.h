@@ -0,0 +1,243 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include <include/GL/glew.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "stb_image.h"
+#include "gl_state.h"
+
+/* Loads material textures into a few GL_TEXTURE_2D_ARRAY objects instead of one 2D texture each.
+ * Every image is assigned a size class, its dimensions rounded to the nearest power of two, and
+ * resampled to it; each class becomes one RGBA8 array with a full mip chain. A texture is then
+ * addressed by (array, layer), which shaders read per draw, and all arrays stay bound to fixed
+ * units, so drawing needs no texture binds at all.
+ */
+
+const GLuint MAX_TEXTURE_ARRAYS = 4;        // Size of the shaders' sampler2DArray array
+const int MAX_TEXTURE_ARRAY_SIZE = 2048;    // Largest layer dimension of a size class
+
+// Where a packed texture lives
+struct TextureSlot
+{
+    GLuint array;   // Index into the arrays, which are bound to consecutive units
+    GLuint layer;
+};
+
+namespace texturearrays
+{
+    inline int sizeClass(int size)
+    {
+        int rounded = 1;
+        while (rounded < size && rounded < MAX_TEXTURE_ARRAY_SIZE)
+            rounded *= 2;
+        // Nearest, not next, power of two: 612 packs as 512, 800 as 1024
+        if (rounded > 1 && rounded - size > size - rounded / 2)
+            rounded /= 2;
+        return rounded;
+    }
+
+    // Bytes of an RGBA8 texture with a full mip chain
+    inline size_t mipChainBytes(int width, int height, int layers)
+    {
+        size_t bytes = 0;
+        while (true)
+        {
+            bytes += static_cast<size_t>(width) * height * layers * 4;
+            if (width == 1 && height == 1)
+                return bytes;
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+    }
+
+    // Resamples an RGBA8 image: bilinear when enlarging, averaging the covered source texels
+    // when shrinking
+    inline void resample(const unsigned char* source, int sourceWidth, int sourceHeight, unsigned char* target, int width, int height)
+    {
+        float scaleX = static_cast<float>(sourceWidth) / width;
+        float scaleY = static_cast<float>(sourceHeight) / height;
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+            {
+                float sum[4] = {};
+                float weight = 0.0f;
+                if (scaleX > 1.0f || scaleY > 1.0f)
+                {
+                    int x0 = static_cast<int>(x * scaleX), x1 = std::max(x0 + 1, static_cast<int>((x + 1) * scaleX));
+                    int y0 = static_cast<int>(y * scaleY), y1 = std::max(y0 + 1, static_cast<int>((y + 1) * scaleY));
+                    for (int sy = y0; sy < std::min(y1, sourceHeight); ++sy)
+                        for (int sx = x0; sx < std::min(x1, sourceWidth); ++sx)
+                        {
+                            const unsigned char* texel = source + (static_cast<size_t>(sy) * sourceWidth + sx) * 4;
+                            for (int c = 0; c < 4; ++c)
+                                sum[c] += texel[c];
+                            weight += 1.0f;
+                        }
+                }
+                else
+                {
+                    float fx = std::max((x + 0.5f) * scaleX - 0.5f, 0.0f), fy = std::max((y + 0.5f) * scaleY - 0.5f, 0.0f);
+                    int x0 = std::min(static_cast<int>(fx), sourceWidth - 1), y0 = std::min(static_cast<int>(fy), sourceHeight - 1);
+                    int x1 = std::min(x0 + 1, sourceWidth - 1), y1 = std::min(y0 + 1, sourceHeight - 1);
+                    float tx = fx - x0, ty = fy - y0;
+                    const int xs[2] = { x0, x1 }, ys[2] = { y0, y1 };
+                    const float wx[2] = { 1.0f - tx, tx }, wy[2] = { 1.0f - ty, ty };
+                    for (int j = 0; j < 2; ++j)
+                        for (int i = 0; i < 2; ++i)
+                        {
+                            const unsigned char* texel = source + (static_cast<size_t>(ys[j]) * sourceWidth + xs[i]) * 4;
+                            for (int c = 0; c < 4; ++c)
+                                sum[c] += texel[c] * wx[i] * wy[j];
+                        }
+                    weight = 1.0f;
+                }
+                unsigned char* out = target + (static_cast<size_t>(y) * width + x) * 4;
+                for (int c = 0; c < 4; ++c)
+                    out[c] = static_cast<unsigned char>(std::min(sum[c] / weight + 0.5f, 255.0f));
+            }
+    }
+}
+
+class TextureArrays
+{
+public:
+    // Loads and packs the images; false if one cannot be read or they need more than
+    // MAX_TEXTURE_ARRAYS size classes. Slots follow the order of files.
+    bool load(const std::vector<std::string>& files)
+    {
+        using namespace texturearrays;
+        struct Image
+        {
+            int width, height;
+            unsigned char* pixels;
+        };
+        std::vector<Image> images;
+        bool loaded = true;
+        for (const std::string& file : files)
+        {
+            Image image = { 0, 0, nullptr };
+            int channels = 0;
+            image.pixels = stbi_load(file.c_str(), &image.width, &image.height, &channels, 4);
+            if (!image.pixels)
+            {
+                std::cout << "ERROR::TEXTURE_ARRAY::LOAD_FAILED " << file << std::endl;
+                loaded = false;
+                break;
+            }
+            images.push_back(image);
+        }
+
+        // Size classes in first-use order
+        slots.clear();
+        classes.clear();
+        separateBytes = 0;
+        for (size_t i = 0; loaded && i < images.size(); ++i)
+        {
+            int width = sizeClass(images[i].width), height = sizeClass(images[i].height);
+            separateBytes += mipChainBytes(images[i].width, images[i].height, 1);
+            size_t array = 0;
+            while (array < classes.size() && (classes[array].width != width || classes[array].height != height))
+                ++array;
+            if (array == classes.size())
+                classes.push_back({ width, height, 0, 0 });
+            TextureSlot slot = { static_cast<GLuint>(array), classes[array].layers++ };
+            slots.push_back(slot);
+        }
+        if (loaded && classes.size() > MAX_TEXTURE_ARRAYS)
+        {
+            std::cout << "ERROR::TEXTURE_ARRAY::TOO_MANY_SIZE_CLASSES " << classes.size() << std::endl;
+            loaded = false;
+        }
+
+        std::vector<unsigned char> layer;
+        for (size_t array = 0; loaded && array < classes.size(); ++array)
+        {
+            Class& size = classes[array];
+            GLsizei levels = 1;
+            while ((std::max(size.width, size.height) >> levels) > 0)
+                ++levels;
+            glGenTextures(1, &size.texture);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, size.texture);
+            glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, size.width, size.height, static_cast<GLsizei>(size.layers));
+            layer.resize(static_cast<size_t>(size.width) * size.height * 4);
+            for (size_t i = 0; i < images.size(); ++i)
+            {
+                if (slots[i].array != array)
+                    continue;
+                const Image& image = images[i];
+                const unsigned char* pixels = image.pixels;
+                if (image.width != size.width || image.height != size.height)
+                {
+                    resample(image.pixels, image.width, image.height, layer.data(), size.width, size.height);
+                    pixels = layer.data();
+                }
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(slots[i].layer), size.width, size.height, 1,
+                    GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            }
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        for (const Image& image : images)
+            stbi_image_free(image.pixels);
+        if (!loaded)
+            destroy();
+        return loaded;
+    }
+
+    void destroy()
+    {
+        for (Class& size : classes)
+            glDeleteTextures(1, &size.texture);
+        classes.clear();
+        slots.clear();
+    }
+
+    // Binds array i to unit firstUnit + i; redundant after the first frame, so the cache drops it
+    void bind(GLStateCache& state, GLuint firstUnit = 0) const
+    {
+        for (size_t array = 0; array < classes.size(); ++array)
+            state.bindTexture(firstUnit + static_cast<GLuint>(array), GL_TEXTURE_2D_ARRAY, classes[array].texture);
+    }
+
+    const TextureSlot& slot(size_t texture) const { return slots[texture]; }
+    size_t size() const { return slots.size(); }
+
+    // Memory of the images as separate RGBA8 textures against the packed arrays, both with mips
+    void printReport() const
+    {
+        size_t packedBytes = 0;
+        std::cout << "INFO: Packed " << slots.size() << " textures into " << classes.size() << " array texture(s):";
+        for (const Class& size : classes)
+        {
+            packedBytes += texturearrays::mipChainBytes(size.width, size.height, static_cast<int>(size.layers));
+            std::cout << " " << size.width << "x" << size.height << " x" << size.layers;
+        }
+        std::cout << std::endl;
+        std::cout << "INFO:   memory: " << separateBytes / 1024 << " KB as separate textures, " << packedBytes / 1024
+            << " KB packed" << std::endl;
+    }
+
+private:
+    // One size class and its array
+    struct Class
+    {
+        int width, height;
+        GLuint layers;
+        GLuint texture;
+    };
+    std::vector<Class> classes;
+    std::vector<TextureSlot> slots;
+    size_t separateBytes = 0;
+};
+#endif
@@ -0,0 +1,218 @@
+#ifndef UNIFORM_BLOCKS_H
+#define UNIFORM_BLOCKS_H
+
+#include <include/GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "dynamic_ring.h"
+#include "object_transforms.h"
+
+/* std140 uniform blocks shared by every program, with C++ mirrors whose layout is checked at
+ * compile time. The GLSL side declares them with explicit bindings:
+ *
+ *   layout(std140, binding = 0) uniform FrameData { mat4 view; mat4 projection; mat4 viewProjection;
+ *                                                   vec4 viewPosition; vec4 lightPosition; vec4 lightColor; };
+ *   layout(std140, binding = 1) uniform ObjectData { mat4 model; mat4 modelViewProjection; mat3 normalMatrix;
+ *                                                    vec4 highlightColor; vec4 uvScale; };
+ *
+ * std140 rounds vec3 up to 16 bytes, so only vec4, mat3 (three vec4 columns) and mat4 members are
+ * used and every member offset is a multiple of 16.
+ *
+ * With a DynamicRing set, both classes write their data into the ring's current frame region and
+ * bind that range instead of updating their own buffer, which the GPU may still be reading.
+ */
+
+const GLuint FRAME_DATA_BINDING = 0;
+const GLuint OBJECT_DATA_BINDING = 1;
+
+// Camera and light data, written once per frame
+struct FrameData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 viewPosition;     // w unused
+    glm::vec4 lightPosition;    // w unused
+    glm::vec4 lightColor;       // w unused
+};
+static_assert(offsetof(FrameData, view) == 0, "FrameData layout must match std140");
+static_assert(offsetof(FrameData, projection) == 64, "FrameData layout must match std140");
+static_assert(offsetof(FrameData, viewProjection) == 128, "FrameData layout must match std140");
+static_assert(offsetof(FrameData, viewPosition) == 192, "FrameData layout must match std140");
+static_assert(offsetof(FrameData, lightPosition) == 208, "FrameData layout must match std140");
+static_assert(offsetof(FrameData, lightColor) == 224, "FrameData layout must match std140");
+static_assert(sizeof(FrameData) == 240, "FrameData layout must match std140");
+
+// Transform and material of one draw
+struct ObjectData
+{
+    glm::mat4 model;            // Includes the mesh's position dequantization
+    ObjectTransform transform;  // Filled from model by computeTransforms()
+    glm::vec4 highlightColor;   // w unused
+    glm::vec4 uvScale;          // zw unused
+};
+static_assert(offsetof(ObjectData, model) == 0, "ObjectData layout must match std140");
+static_assert(offsetof(ObjectData, transform) == 64, "ObjectData layout must match std140");
+static_assert(offsetof(ObjectData, highlightColor) == 176, "ObjectData layout must match std140");
+static_assert(offsetof(ObjectData, uvScale) == 192, "ObjectData layout must match std140");
+static_assert(sizeof(ObjectData) == 208, "ObjectData layout must match std140");
+
+
+// One FrameData in a uniform buffer that stays bound at FRAME_DATA_BINDING
+class FrameUniforms
+{
+public:
+    FrameUniforms() : ubo(0), ring(nullptr), alignment(256) {}
+
+    void create()
+    {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, ubo);
+        GLint offsetAlignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+        alignment = static_cast<size_t>(offsetAlignment);
+    }
+
+    // Uploads through the ring from now on; nullptr goes back to the uniform buffer
+    void setRing(DynamicRing* dynamicRing)
+    {
+        ring = dynamicRing;
+        if (!ring)
+            glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, ubo);
+    }
+
+    void destroy()
+    {
+        glDeleteBuffers(1, &ubo);
+        ubo = 0;
+    }
+
+    // A single upload per frame serves every program
+    void update(const FrameData& frame)
+    {
+        if (ring)
+        {
+            RingAllocation allocation = ring->allocate(sizeof(FrameData), alignment);
+            if (allocation.data)
+            {
+                std::memcpy(allocation.data, &frame, sizeof(FrameData));
+                glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, allocation.buffer, allocation.offset, sizeof(FrameData));
+                return;
+            }
+            // The ring could not grow: this frame goes through the uniform buffer
+            glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, ubo);
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &frame);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+private:
+    GLuint ubo;
+    DynamicRing* ring;
+    size_t alignment;
+};
+
+
+// Per-draw ObjectData records: staged on the CPU while the frame's draws are collected, uploaded
+// with one glBufferSubData, or one copy into the ring, then selected per draw with
+// glBindBufferRange. Records are padded to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT; the buffer grows
+// when a frame needs more of them.
+class ObjectUniforms
+{
+public:
+    ObjectUniforms() : ubo(0), stride(sizeof(ObjectData)), capacity(0), count(0), ring(nullptr), source(0), base(0) {}
+
+    void create(GLuint initialCapacity = 64)
+    {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        stride = (sizeof(ObjectData) + alignment - 1) / alignment * alignment;
+        glGenBuffers(1, &ubo);
+        source = ubo;
+        reserve(initialCapacity);
+    }
+
+    void destroy()
+    {
+        glDeleteBuffers(1, &ubo);
+        ubo = 0;
+        capacity = 0;
+    }
+
+    void setRing(DynamicRing* dynamicRing) { ring = dynamicRing; }
+
+    void clear() { count = 0; }
+
+    // Stages one record and returns its slot for bind()
+    GLuint push(const ObjectData& object)
+    {
+        if ((count + 1) * stride > staging.size())
+            staging.resize((count + 1) * stride * 2);
+        std::memcpy(staging.data() + count * stride, &object, sizeof(ObjectData));
+        return count++;
+    }
+
+    // Derives every staged record's MVP and normal matrix from its model in one batch
+    ObjectTransformStats computeTransforms(const glm::mat4& viewProjection)
+    {
+        return UComputeObjectTransforms(viewProjection, staging.data(), stride, count);
+    }
+
+    void upload()
+    {
+        if (count == 0)
+            return;
+        if (ring)
+        {
+            RingAllocation allocation = ring->allocate(count * stride, stride);
+            if (allocation.data)
+            {
+                std::memcpy(allocation.data, staging.data(), count * stride);
+                source = allocation.buffer;
+                base = allocation.offset;
+                return;
+            }
+        }
+        source = ubo;
+        base = 0;
+        if (count > capacity)
+            reserve(count * 2);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(count * stride), staging.data());
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void bind(GLuint slot) const
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, OBJECT_DATA_BINDING, source, base + static_cast<GLintptr>(slot * stride), sizeof(ObjectData));
+    }
+
+    GLuint size() const { return count; }
+
+private:
+    GLuint ubo;
+    size_t stride;
+    GLuint capacity;
+    GLuint count;
+    std::vector<unsigned char> staging;
+    DynamicRing* ring;
+    GLuint source;      // Buffer and offset of the last upload
+    GLintptr base;
+
+    void reserve(GLuint objects)
+    {
+        capacity = objects;
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(capacity * stride), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+};
+#endif
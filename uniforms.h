@@ -0,0 +1,142 @@
+#ifndef UNIFORMS_H
+#define UNIFORMS_H
+
+#include <include/GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+/* Uniform locations read once per program after linking.
+ * A UniformTable lists every active uniform by the FNV-1a hash of its name, so lookups need neither
+ * a string nor a driver call; Uniform<T> handles carry the location and the value type, and the
+ * USetUniform overloads only accept the matching value.
+ *
+ *   UniformTable table;
+ *   table.build(program);
+ *   Uniform<glm::mat4> model = table.get<glm::mat4>(UUniformName("model"));
+ *   USetUniform(model, matrix);
+ */
+
+// FNV-1a hash of a uniform name; a constant expression for literal names
+constexpr uint32_t UUniformName(const char* name, uint32_t hash = 2166136261u)
+{
+    return *name ? UUniformName(name + 1, (hash ^ static_cast<uint8_t>(*name)) * 16777619u) : hash;
+}
+
+// Location of a uniform of value type T; -1 (ignored by glUniform*) when the program does not use it
+template <typename T>
+struct Uniform
+{
+    GLint location = -1;
+};
+
+namespace uniforms
+{
+    // Whether an active uniform of GL type type can be set from a T
+    template <typename T> bool accepts(GLenum type);
+    template <> inline bool accepts<GLfloat>(GLenum type) { return type == GL_FLOAT; }
+    template <> inline bool accepts<GLuint>(GLenum type) { return type == GL_UNSIGNED_INT; }
+    template <> inline bool accepts<glm::vec2>(GLenum type) { return type == GL_FLOAT_VEC2; }
+    template <> inline bool accepts<glm::vec3>(GLenum type) { return type == GL_FLOAT_VEC3; }
+    template <> inline bool accepts<glm::vec4>(GLenum type) { return type == GL_FLOAT_VEC4; }
+    template <> inline bool accepts<glm::mat3>(GLenum type) { return type == GL_FLOAT_MAT3; }
+    template <> inline bool accepts<glm::mat4>(GLenum type) { return type == GL_FLOAT_MAT4; }
+    template <> inline bool accepts<GLint>(GLenum type)
+    {
+        // Samplers and images are set through their texture unit
+        return type == GL_INT || type == GL_BOOL || type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_ARRAY
+            || type == GL_SAMPLER_CUBE || type == GL_SAMPLER_2D_SHADOW;
+    }
+}
+
+class UniformTable
+{
+public:
+    // Reads the active uniforms of a linked program. Array uniforms are listed by their base name
+    // ("lights" as well as "lights[0]"); uniforms inside blocks have no location and are skipped.
+    void build(GLuint program)
+    {
+        entries.clear();
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<GLchar> name(std::max(maxLength, 1));
+        for (GLint i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+            GLint location = glGetUniformLocation(program, name.data());
+            if (location < 0)
+                continue;
+            entries.push_back({ UUniformName(name.data()), location, type });
+            if (length > 3 && name[length - 3] == '[' && name[length - 2] == '0' && name[length - 1] == ']')
+            {
+                name[length - 3] = '\0';
+                entries.push_back({ UUniformName(name.data()), location, type });
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+        for (size_t i = 1; i < entries.size(); ++i)
+            if (entries[i].hash == entries[i - 1].hash)
+                std::cout << "ERROR::UNIFORMS::NAME_HASH_COLLISION in program " << program << std::endl;
+    }
+
+    // Handle of the uniform whose name hashes to nameHash; an unused location if the program has
+    // no such uniform, a warning if it has one of another type
+    template <typename T>
+    Uniform<T> get(uint32_t nameHash) const
+    {
+        Uniform<T> uniform;
+        const Entry* entry = find(nameHash);
+        if (!entry)
+            return uniform;
+        if (!uniforms::accepts<T>(entry->type))
+            std::cout << "WARNING: Uniform at location " << entry->location << " has GL type 0x" << std::hex << entry->type
+                << std::dec << ", which its handle cannot set" << std::endl;
+        uniform.location = entry->location;
+        return uniform;
+    }
+
+    // Location by hash, -1 if the program has no such active uniform
+    GLint location(uint32_t nameHash) const
+    {
+        const Entry* entry = find(nameHash);
+        return entry ? entry->location : -1;
+    }
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Entry
+    {
+        uint32_t hash;
+        GLint location;
+        GLenum type;
+    };
+    std::vector<Entry> entries;     // Sorted by hash
+
+    const Entry* find(uint32_t nameHash) const
+    {
+        auto found = std::lower_bound(entries.begin(), entries.end(), nameHash, [](const Entry& e, uint32_t h) { return e.hash < h; });
+        return found != entries.end() && found->hash == nameHash ? &*found : nullptr;
+    }
+};
+
+
+// Typed uniform setters for the program currently in use
+inline void USetUniform(Uniform<GLint> uniform, GLint value) { glUniform1i(uniform.location, value); }
+inline void USetUniform(Uniform<GLint> uniform, const GLint* values, GLsizei count) { glUniform1iv(uniform.location, count, values); }
+inline void USetUniform(Uniform<GLuint> uniform, GLuint value) { glUniform1ui(uniform.location, value); }
+inline void USetUniform(Uniform<GLfloat> uniform, GLfloat value) { glUniform1f(uniform.location, value); }
+inline void USetUniform(Uniform<glm::vec2> uniform, const glm::vec2& value) { glUniform2fv(uniform.location, 1, glm::value_ptr(value)); }
+inline void USetUniform(Uniform<glm::vec3> uniform, const glm::vec3& value) { glUniform3fv(uniform.location, 1, glm::value_ptr(value)); }
+inline void USetUniform(Uniform<glm::vec4> uniform, const glm::vec4& value) { glUniform4fv(uniform.location, 1, glm::value_ptr(value)); }
+inline void USetUniform(Uniform<glm::mat3> uniform, const glm::mat3& value) { glUniformMatrix3fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value)); }
+inline void USetUniform(Uniform<glm::mat4> uniform, const glm::mat4& value) { glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value)); }
+#endif
@@ -0,0 +1,306 @@
+#ifndef VERTEX_PACK_H
+#define VERTEX_PACK_H
+
+#include <include/GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "mesh.h"
+
+// Vertex layouts a mesh can be stored in
+enum VertexLayout
+{
+    VERTEX_LAYOUT_FLOAT,    // 32 bytes: float position, normal and uv
+    VERTEX_LAYOUT_PACKED,   // 16 bytes: 16-bit position, 10:10:10:2 normal, half float uv
+    VERTEX_LAYOUT_COUNT
+};
+
+// Streams a mesh can be drawn from: the interleaved vertices, or its optional position-only copy
+// for passes that write depth alone
+enum VertexStream
+{
+    VERTEX_STREAM_FULL,
+    VERTEX_STREAM_POSITION
+};
+
+// Quantized vertex. Positions are unsigned normalized to the mesh bounds, so the shader
+// sees them in [0, 1] and the dequantization is folded into the model matrix.
+struct PackedVertex
+{
+    GLushort position[4];   // xyz quantized to the mesh bounds, w is padding
+    GLuint normal;          // GL_INT_2_10_10_10_REV
+    GLushort texCoord[2];   // Half floats
+};
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay 16 bytes");
+
+// Maps quantized positions back to mesh space: position = offset + q * scale
+struct Quantization
+{
+    glm::vec3 offset;
+    glm::vec3 scale;
+};
+
+inline size_t UVertexStride(VertexLayout layout)
+{
+    return layout == VERTEX_LAYOUT_PACKED ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+// Sets the attribute formats of the bound VAO for the given layout (binding index 0)
+inline void USetVertexFormat(VertexLayout layout)
+{
+    if (layout == VERTEX_LAYOUT_PACKED)
+    {
+        glVertexAttribFormat(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(PackedVertex, position));
+        glVertexAttribFormat(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedVertex, normal));
+        glVertexAttribFormat(2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, texCoord));
+    }
+    else
+    {
+        glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, position));
+        glVertexAttribFormat(1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal));
+        glVertexAttribFormat(2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, texCoord));
+    }
+
+    for (GLuint attribute = 0; attribute < 3; ++attribute)
+    {
+        glVertexAttribBinding(attribute, 0);
+        glEnableVertexAttribArray(attribute);
+    }
+}
+
+// Position-only stream: the layout's position in its own format, tightly packed. Packed positions
+// keep their padding so every element stays 4-byte aligned.
+inline size_t UPositionStride(VertexLayout layout)
+{
+    return layout == VERTEX_LAYOUT_PACKED ? sizeof(PackedVertex::position) : sizeof(glm::vec3);
+}
+
+// Sets attribute 0 of the bound VAO to the position stream of the given layout (binding index 0)
+inline void USetPositionFormat(VertexLayout layout)
+{
+    if (layout == VERTEX_LAYOUT_PACKED)
+        glVertexAttribFormat(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, 0);
+    else
+        glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, 0);
+    glVertexAttribBinding(0, 0);
+    glEnableVertexAttribArray(0);
+}
+
+namespace vertexpack
+{
+    // Bits of one stored position, compared exactly
+    struct PositionKey
+    {
+        uint32_t bits[3];
+
+        bool operator==(const PositionKey& other) const
+        {
+            return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+        }
+    };
+
+    struct PositionKeyHash
+    {
+        size_t operator()(const PositionKey& key) const
+        {
+            size_t hash = 2166136261u;
+            for (uint32_t bits : key.bits)
+                hash = (hash ^ bits) * 16777619u;
+            return hash;
+        }
+    };
+}
+
+// Builds the position-only stream of vertexCount vertices stored in layout and welds it by position
+// alone, so vertices split only for their normal or uv share one entry. indices are remapped to it in
+// the same order and index type, which keeps every triangle and meshlet range where it was. Positions
+// are copied bit for bit: a pass drawing from the stream computes exactly the clip positions of the
+// full one. Returns the number of position vertices.
+inline GLuint UBuildPositionStream(VertexLayout layout, const void* vertexData, GLuint vertexCount, const void* indexData,
+    GLsizei indexCount, GLenum indexType, std::vector<unsigned char>& positions, std::vector<unsigned char>& indices)
+{
+    using namespace vertexpack;
+    size_t stride = UVertexStride(layout);
+    size_t positionStride = UPositionStride(layout);
+    const unsigned char* source = static_cast<const unsigned char*>(vertexData);
+
+    std::vector<GLuint> remap(vertexCount);
+    std::unordered_map<PositionKey, GLuint, PositionKeyHash> lookup;
+    lookup.reserve(vertexCount);
+    positions.clear();
+    positions.reserve(vertexCount * positionStride);
+    for (GLuint i = 0; i < vertexCount; ++i)
+    {
+        PositionKey key;
+        if (layout == VERTEX_LAYOUT_PACKED)
+        {
+            const PackedVertex* vertex = reinterpret_cast<const PackedVertex*>(source + i * stride);
+            for (int axis = 0; axis < 3; ++axis)
+                key.bits[axis] = vertex->position[axis];
+        }
+        else
+            std::memcpy(key.bits, source + i * stride + offsetof(Vertex, position), sizeof(key.bits));
+
+        auto found = lookup.emplace(key, static_cast<GLuint>(lookup.size()));
+        remap[i] = found.first->second;
+        if (!found.second)
+            continue;
+        if (layout == VERTEX_LAYOUT_PACKED)
+        {
+            GLushort position[4] = { static_cast<GLushort>(key.bits[0]), static_cast<GLushort>(key.bits[1]),
+                static_cast<GLushort>(key.bits[2]), 0 };
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(position);
+            positions.insert(positions.end(), bytes, bytes + sizeof(position));
+        }
+        else
+        {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.bits);
+            positions.insert(positions.end(), bytes, bytes + sizeof(key.bits));
+        }
+    }
+
+    indices.resize(indexCount * UIndexSize(indexType));
+    if (indexType == GL_UNSIGNED_SHORT)
+    {
+        const GLushort* in = static_cast<const GLushort*>(indexData);
+        GLushort* out = reinterpret_cast<GLushort*>(indices.data());
+        for (GLsizei i = 0; i < indexCount; ++i)
+            out[i] = static_cast<GLushort>(remap[in[i]]);
+    }
+    else
+    {
+        const GLuint* in = static_cast<const GLuint*>(indexData);
+        GLuint* out = reinterpret_cast<GLuint*>(indices.data());
+        for (GLsizei i = 0; i < indexCount; ++i)
+            out[i] = remap[in[i]];
+    }
+    return static_cast<GLuint>(lookup.size());
+}
+
+
+// Bounds of the mesh used as the quantization grid. Flat axes get a unit scale so the
+// folded model matrix stays invertible.
+inline Quantization UComputeQuantization(const MeshData& mesh)
+{
+    Quantization q;
+    q.offset = glm::vec3(0.0f);
+    q.scale = glm::vec3(1.0f);
+    if (mesh.vertices.empty())
+        return q;
+
+    glm::vec3 lo = mesh.vertices[0].position;
+    glm::vec3 hi = lo;
+    for (const Vertex& v : mesh.vertices)
+    {
+        lo = glm::min(lo, v.position);
+        hi = glm::max(hi, v.position);
+    }
+
+    q.offset = lo;
+    for (int axis = 0; axis < 3; ++axis)
+        q.scale[axis] = hi[axis] - lo[axis] > 1e-6f ? hi[axis] - lo[axis] : 1.0f;
+    return q;
+}
+
+inline GLuint UPackNormal(const glm::vec3& n)
+{
+    GLuint packed = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        int value = static_cast<int>(std::round(std::max(-1.0f, std::min(1.0f, n[axis])) * 511.0f));
+        packed |= (static_cast<GLuint>(value) & 0x3FFu) << (axis * 10);
+    }
+    return packed;
+}
+
+inline glm::vec3 UUnpackNormal(GLuint packed)
+{
+    glm::vec3 n;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        int value = static_cast<int>((packed >> (axis * 10)) & 0x3FFu);
+        if (value & 0x200)
+            value -= 0x400;
+        n[axis] = std::max(-1.0f, value / 511.0f);
+    }
+    return n;
+}
+
+// Encodes one vertex. The normal is pre-multiplied by the quantization scale: the draw's model
+// matrix has the dequantization scale folded in, so the normal matrix UNormalMatrix derives from
+// it on the CPU divides that scale back out and restores the normal's direction.
+inline PackedVertex UPackVertex(const Vertex& v, const Quantization& q)
+{
+    PackedVertex p;
+    glm::vec3 unit = (v.position - q.offset) / q.scale;
+    for (int axis = 0; axis < 3; ++axis)
+        p.position[axis] = static_cast<GLushort>(std::round(std::max(0.0f, std::min(1.0f, unit[axis])) * 65535.0f));
+    p.position[3] = 0;
+    p.normal = UPackNormal(glm::normalize(v.normal * q.scale));
+    p.texCoord[0] = glm::packHalf1x16(v.texCoord.x);
+    p.texCoord[1] = glm::packHalf1x16(v.texCoord.y);
+    return p;
+}
+
+inline Vertex UUnpackVertex(const PackedVertex& p, const Quantization& q)
+{
+    Vertex v;
+    glm::vec3 unit(p.position[0] / 65535.0f, p.position[1] / 65535.0f, p.position[2] / 65535.0f);
+    v.position = q.offset + unit * q.scale;
+    v.normal = glm::normalize(UUnpackNormal(p.normal) / q.scale);
+    v.texCoord = glm::vec2(glm::unpackHalf1x16(p.texCoord[0]), glm::unpackHalf1x16(p.texCoord[1]));
+    return v;
+}
+
+// Converts the mesh's vertices to the byte layout of the given vertex format
+inline std::vector<unsigned char> UPackVertices(const MeshData& mesh, VertexLayout layout, const Quantization& q)
+{
+    std::vector<unsigned char> bytes(mesh.vertices.size() * UVertexStride(layout));
+    if (layout == VERTEX_LAYOUT_PACKED)
+    {
+        PackedVertex* dst = reinterpret_cast<PackedVertex*>(bytes.data());
+        for (size_t i = 0; i < mesh.vertices.size(); ++i)
+            dst[i] = UPackVertex(mesh.vertices[i], q);
+    }
+    else if (!bytes.empty())
+    {
+        std::memcpy(bytes.data(), mesh.vertices.data(), bytes.size());
+    }
+    return bytes;
+}
+
+
+// Largest errors of the packed layout against the float path
+struct PackingError
+{
+    float position;     // Max distance in mesh units
+    float normal;       // Max angle in degrees
+    float texCoord;     // Max absolute uv difference
+};
+
+inline PackingError UMeasurePackingError(const MeshData& mesh)
+{
+    PackingError error = { 0.0f, 0.0f, 0.0f };
+    Quantization q = UComputeQuantization(mesh);
+    for (const Vertex& v : mesh.vertices)
+    {
+        Vertex decoded = UUnpackVertex(UPackVertex(v, q), q);
+        error.position = std::max(error.position, glm::length(decoded.position - v.position));
+
+        float cosine = std::max(-1.0f, std::min(1.0f, glm::dot(decoded.normal, glm::normalize(v.normal))));
+        error.normal = std::max(error.normal, std::acos(cosine) * 57.2957795f);
+
+        glm::vec2 uvDelta = glm::abs(decoded.texCoord - v.texCoord);
+        error.texCoord = std::max(error.texCoord, std::max(uvDelta.x, uvDelta.y));
+    }
+    return error;
+}
+#endif